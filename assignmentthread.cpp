@@ -19,20 +19,31 @@
 #include "assignmentthread.h"
 #include "judgingthread.h"
 #include "settings.h"
-#include "compiler.h"
+#include "compilethread.h"
 #include "task.h"
 #include "testcase.h"
+#include "processorpool.h"
+#include "concurrencycontroller.h"
+#include "cancellationtoken.h"
+#include "completionring.h"
 
 AssignmentThread::AssignmentThread(QObject *parent) :
     QThread(parent)
 {
     moveToThread(this);
     checkRejudgeMode = false;
+    recheckMode = false;
     curTestCaseIndex = 0;
     curSingleCaseIndex = 0;
-    countFinished = 0;
-    totalSingleCase = 0;
-    stopJudging = false;
+    numberOfWorkers = 1;
+    memoryBudget = 0;
+    memoryInUse = 0;
+    processorPool = 0;
+    compileThread = 0;
+    concurrencyController = 0;
+    cancellationToken = 0;
+    completionRing = 0;
+    runningCount = 0;
 }
 
 void AssignmentThread::setCheckRejudgeMode(bool check)
@@ -60,6 +71,37 @@ void AssignmentThread::setContestantName(const QString &name)
     contestantName = name;
 }
 
+void AssignmentThread::setCompileThread(CompileThread *thread)
+{
+    compileThread = thread;
+}
+
+void AssignmentThread::setConcurrencyController(ConcurrencyController *controller)
+{
+    concurrencyController = controller;
+}
+
+void AssignmentThread::setCancellationToken(CancellationToken *token)
+{
+    cancellationToken = token;
+}
+
+void AssignmentThread::setOutputArchivePath(const QString &path)
+{
+    outputArchivePath = path;
+}
+
+void AssignmentThread::setRecheckOutputs(const QList<QStringList> &list)
+{
+    recheckMode = true;
+    recheckOutputs = list;
+}
+
+bool AssignmentThread::getRecheckMode() const
+{
+    return recheckMode;
+}
+
 CompileState AssignmentThread::getCompileState() const
 {
     return compileState;
@@ -105,135 +147,86 @@ const QList<QStringList>& AssignmentThread::getInputFiles() const
     return inputFiles;
 }
 
+const QList< QList<int> >& AssignmentThread::getProcessorUsed() const
+{
+    return processorUsed;
+}
+
 const QList< QPair<int, int> >& AssignmentThread::getNeedRejudge() const
 {
     return needRejudge;
 }
 
+const QList<QStringList>& AssignmentThread::getOutputHash() const
+{
+    return outputHash;
+}
+
+const QList< QPair<int, int> >& AssignmentThread::getRecheckList() const
+{
+    return recheckList;
+}
+
+void AssignmentThread::writeResultToStream(QDataStream &out)
+{
+    out << int(compileState);
+    out << compileMessage;
+    out << sourceFile;
+    out << score;
+    out << timeUsed;
+    out << memoryUsed;
+    out << result.size();
+    for (int i = 0; i < result.size(); i ++) {
+        QList<int> _result;
+        for (int j = 0; j < result[i].size(); j ++)
+            _result.append(int(result[i][j]));
+        out << _result;
+    }
+    out << message;
+    out << inputFiles;
+    out << processorUsed;
+    out << needRejudge;
+}
+
+void AssignmentThread::readResultFromStream(QDataStream &in)
+{
+    int tmp, count;
+    in >> tmp;
+    compileState = CompileState(tmp);
+    in >> compileMessage;
+    in >> sourceFile;
+    in >> score;
+    in >> timeUsed;
+    in >> memoryUsed;
+    in >> count;
+    result.clear();
+    for (int i = 0; i < count; i ++) {
+        QList<int> _result;
+        in >> _result;
+        result.append(QList<ResultState>());
+        for (int j = 0; j < _result.size(); j ++)
+            result[i].append(ResultState(_result[j]));
+    }
+    in >> message;
+    in >> inputFiles;
+    in >> processorUsed;
+    in >> needRejudge;
+}
+
 bool AssignmentThread::traditionalTaskPrepare()
 {
     compileState = NoValidSourceFile;
-    QDir contestantDir = QDir(Settings::sourcePath() + contestantName);
-    QList<Compiler*> compilerList = settings->getCompilerList();
-    
-    for (int i = 0; i < compilerList.size(); i ++) {
-        if (task->getCompilerConfiguration(compilerList[i]->getCompilerName()) == "disable") continue;
-        QStringList filters = compilerList[i]->getSourceExtensions();
-        for (int j = 0; j < filters.size(); j ++)
-            filters[j] = task->getSourceFileName() + "." + filters[j];
-        QStringList files = contestantDir.entryList(filters, QDir::Files);
-        sourceFile = "";
-        for (int j = 0; j < files.size(); j ++) {
-            qint64 fileSize = QFileInfo(Settings::sourcePath() + contestantName + QDir::separator() + files[j]).size();
-            if (fileSize <= settings->getFileSizeLimit() * 1024) {
-                sourceFile = files[j];
-                break;
-            }
-        }
-        
-        if (! sourceFile.isEmpty()) {
-            QDir(Settings::temporaryPath()).mkdir(contestantName);
-            QFile::copy(Settings::sourcePath() + contestantName + QDir::separator() + sourceFile,
-                        Settings::temporaryPath() + contestantName + QDir::separator() + sourceFile);
-            QStringList configurationNames = compilerList[i]->getConfigurationNames();
-            QStringList compilerArguments = compilerList[i]->getCompilerArguments();
-            QStringList interpreterArguments = compilerList[i]->getInterpreterArguments();
-            QString currentConfiguration = task->getCompilerConfiguration(compilerList[i]->getCompilerName());
-            for (int j = 0; j < configurationNames.size(); j ++)
-                if (configurationNames[j] == currentConfiguration) {
-                    timeLimitRatio = compilerList[i]->getTimeLimitRatio();
-                    memoryLimitRatio = compilerList[i]->getMemoryLimitRatio();
-                    disableMemoryLimitCheck = compilerList[i]->getDisableMemoryLimitCheck();
-                    environment = compilerList[i]->getEnvironment();
-                    QStringList values = environment.toStringList();
-                    for (int k = 0; k < values.size(); k ++) {
-                        int tmp = values[k].indexOf("=");
-                        QString variable = values[k].mid(0, tmp);
-                        environment.insert(variable, 
-                                           environment.value(variable) + ";"
-                                           + QProcessEnvironment::systemEnvironment().value(variable));
-                    }
-                    
-                    if (compilerList[i]->getCompilerType() == Compiler::Typical) {
-#ifdef Q_OS_WIN32
-                                executableFile = task->getSourceFileName() + ".exe";
-#endif
-#ifdef Q_OS_LINUX
-                                executableFile = task->getSourceFileName();
-#endif
-                                interpreterFlag = false;
-                    } else {
-                        executableFile = compilerList[i]->getInterpreterLocation();
-                        arguments = interpreterArguments[j];
-                        arguments.replace("%s.*", sourceFile);
-                        arguments.replace("%s", task->getSourceFileName());
-                        interpreterFlag = true;
-                    }
-                    
-                    if (compilerList[i]->getCompilerType() != Compiler::InterpretiveWithoutByteCode) {
-                        QString arguments = compilerArguments[j];
-                        arguments.replace("%s.*", sourceFile);
-                        arguments.replace("%s", task->getSourceFileName());
-                        QProcess *compiler = new QProcess(this);
-                        compiler->setProcessChannelMode(QProcess::MergedChannels);
-                        compiler->setProcessEnvironment(environment);
-                        compiler->setWorkingDirectory(Settings::temporaryPath() + contestantName);
-                        compiler->start(QString("\"") + compilerList[i]->getCompilerLocation() + "\" " + arguments);
-                        if (! compiler->waitForStarted(-1)) {
-                            compileState = InvalidCompiler;
-                            delete compiler;
-                            break;
-                        }
-                        QElapsedTimer timer;
-                        timer.start();
-                        bool flag = false;
-                        while (timer.elapsed() < settings->getCompileTimeLimit()) {
-                            if (compiler->state() != QProcess::Running) {
-                                flag = true;
-                                break;
-                            }
-                            QCoreApplication::processEvents();
-                            if (stopJudging) {
-                                compiler->kill();
-                                delete compiler;
-                                return false;
-                            }
-                            msleep(10);
-                        }
-                        if (! flag) {
-                            compiler->kill();
-                            compileState = CompileTimeLimitExceeded;
-                        } else
-                            if (compiler->exitCode() != 0) {
-                                compileState = CompileError;
-                                compileMessage = QString::fromLocal8Bit(compiler->readAllStandardOutput().data());
-                            } else {
-                                if (compilerList[i]->getCompilerType() == Compiler::Typical) {
-                                    if (! QDir(Settings::temporaryPath() + contestantName).exists(executableFile))
-                                        compileState = InvalidCompiler;
-                                    else
-                                        compileState = CompileSuccessfully;
-                                } else {
-                                    QStringList filters = compilerList[i]->getBytecodeExtensions();
-                                    for (int k = 0; k < filters.size(); k ++)
-                                        filters[k] = QString("*.") + filters[k];
-                                    if (QDir(Settings::temporaryPath() + contestantName)
-                                            .entryList(filters, QDir::Files).size() == 0)
-                                        compileState = InvalidCompiler;
-                                    else
-                                        compileState = CompileSuccessfully;
-                                }
-                            }
-                        delete compiler;
-                    }
-                    
-                    if (compilerList[i]->getCompilerType() == Compiler::InterpretiveWithoutByteCode)
-                        compileState = CompileSuccessfully;
-                    
-                    break;
-                }
-            break;
-        }
+    if (compileThread) {
+        compileState = compileThread->getCompileState();
+        compileMessage = compileThread->getCompileMessage();
+        sourceFile = compileThread->getSourceFile();
+        executableFile = compileThread->getExecutableFile();
+        arguments = compileThread->getArguments();
+        interpreterFlag = compileThread->getInterpreterFlag();
+        timeLimitRatio = compileThread->getTimeLimitRatio();
+        memoryLimitRatio = compileThread->getMemoryLimitRatio();
+        disableMemoryLimitCheck = compileThread->getDisableMemoryLimitCheck();
+        environment = compileThread->getEnvironment();
     }
     
     if (compileState != CompileSuccessfully) {
@@ -246,10 +239,10 @@ bool AssignmentThread::traditionalTaskPrepare()
 
 void AssignmentThread::run()
 {
-    if (task->getTaskType() == Task::Traditional)
+    if (task->getTaskType() == Task::Traditional && ! recheckMode)
         if (! traditionalTaskPrepare()) return;
     
-    if (stopJudging) return;
+    if (isCancelled()) return;
     
     for (int i = 0; i < task->getTestCaseList().size(); i ++) {
         timeUsed.append(QList<int>());
@@ -258,6 +251,8 @@ void AssignmentThread::run()
         result.append(QList<ResultState>());
         message.append(QStringList());
         inputFiles.append(QStringList());
+        processorUsed.append(QList<int>());
+        outputHash.append(QStringList());
         for (int j = 0; j < task->getTestCase(i)->getInputFiles().size(); j ++) {
             timeUsed[i].append(-1);
             memoryUsed[i].append(-1);
@@ -265,67 +260,104 @@ void AssignmentThread::run()
             result[i].append(WrongAnswer);
             message[i].append("");
             inputFiles[i].append("");
+            processorUsed[i].append(-1);
+            outputHash[i].append("");
         }
     }
     
-    if (checkRejudgeMode)
-        assign();
-    else
-        for (int i = 0; i < settings->getNumberOfThreads(); i ++) assign();
+    numberOfWorkers = settings->getNumberOfThreads();
+    if (concurrencyController)
+        numberOfWorkers = concurrencyController->getNumberOfWorkers();
+    if (settings->getPinJudgingThreads()) {
+        processorPool = new ProcessorPool(this);
+        processorPool->setHousekeepingProcessor(settings->getHousekeepingProcessor());
+        processorPool->detectTopology();
+        if (processorPool->getProcessorCount() > 0)
+            numberOfWorkers = qMin(numberOfWorkers, processorPool->getProcessorCount());
+        else {
+            delete processorPool;
+            processorPool = 0;
+        }
+    }
+    memoryBudget = settings->getMemoryBudget();
     
-    exec();
+    if (checkRejudgeMode) {
+        pendingList = needRejudge;
+        numberOfWorkers = 1;
+    } else if (recheckMode) {
+        for (int i = 0; i < recheckOutputs.size() && i < task->getTestCaseList().size(); i ++)
+            for (int j = 0; j < recheckOutputs[i].size() && j < outputHash[i].size(); j ++)
+                if (! recheckOutputs[i][j].isEmpty()) recheckList.append(qMakePair(i, j));
+        pendingList = recheckList;
+    } else
+        for (int i = 0; i < task->getTestCaseList().size(); i ++)
+            for (int j = 0; j < task->getTestCase(i)->getInputFiles().size(); j ++)
+                pendingList.append(qMakePair(i, j));
+    
+    completionRing = new CompletionRing(Settings::upperBoundForNumberOfThreads());
+    while (runningCount < numberOfWorkers && assign()) ;
+    while (runningCount > 0) {
+        completionRing->waitForRecords();
+        CompletionRecord record;
+        while (completionRing->pop(record))
+            threadFinished(record);
+        if (! isCancelled())
+            while (runningCount < numberOfWorkers && assign()) ;
+    }
+    
+    delete completionRing;
+    completionRing = 0;
+    delete processorPool;
+    processorPool = 0;
 }
 
-void AssignmentThread::assign()
+int AssignmentThread::getMemoryRequirement(int index) const
 {
-    if (! checkRejudgeMode) {
-        if (curTestCaseIndex == task->getTestCaseList().size()) {
-            if (countFinished == totalSingleCase) quit();
-            return;
-        }
-        
-        TestCase *curTestCase = task->getTestCase(curTestCaseIndex);
-        if (curSingleCaseIndex == curTestCase->getInputFiles().size()) {
-            curTestCaseIndex ++;
-            for ( ; curTestCaseIndex < task->getTestCaseList().size(); curTestCaseIndex ++)
-                if (task->getTestCase(curTestCaseIndex)->getInputFiles().size() > 0) break;
-            curSingleCaseIndex = 0;
-            if (curTestCaseIndex == task->getTestCaseList().size()) {
-                if (countFinished == totalSingleCase) quit();
-                return;
-            }
-            curTestCase = task->getTestCase(curTestCaseIndex);
-        }
-    } else {
-        if (needRejudge.size() == 0) {
-            if (countFinished == totalSingleCase) quit();
-            return;
+    if (task->getTaskType() != Task::Traditional || recheckMode) return 0;
+    return qCeil(task->getTestCase(index)->getMemoryLimit() * memoryLimitRatio);
+}
+
+bool AssignmentThread::assign()
+{
+    int index = -1;
+    for (int i = 0; i < pendingList.size(); i ++)
+        if (runningCount == 0 || memoryBudget <= 0
+                || memoryInUse + getMemoryRequirement(pendingList[i].first) <= memoryBudget) {
+            index = i;
+            break;
         }
-        curTestCaseIndex = needRejudge[0].first;
-        curSingleCaseIndex = needRejudge[0].second;
-        needRejudge.removeFirst();
-    }
+    if (index == -1) return false;
+    
+    curTestCaseIndex = pendingList[index].first;
+    curSingleCaseIndex = pendingList[index].second;
+    pendingList.removeAt(index);
+    memoryInUse += getMemoryRequirement(curTestCaseIndex);
     
-    totalSingleCase ++;
     TestCase *curTestCase = task->getTestCase(curTestCaseIndex);
     JudgingThread *thread = new JudgingThread();
     thread->setCheckRejudgeMode(checkRejudgeMode);
-    if (checkRejudgeMode)
+    if (processorPool)
+        thread->setProcessor(processorPool->acquireProcessor());
+    if (checkRejudgeMode || processorPool)
         thread->setExtraTimeRatio(0.1);
     else
-        thread->setExtraTimeRatio(0.1 * settings->getNumberOfThreads());
+        thread->setExtraTimeRatio(0.1 * numberOfWorkers);
     QString workingDirectory = QDir::toNativeSeparators(QDir(Settings::temporaryPath()
                                + QString("_%1.%2").arg(curTestCaseIndex).arg(curSingleCaseIndex))
                                .absolutePath()) + QDir::separator();
     thread->setWorkingDirectory(workingDirectory);
     QDir(Settings::temporaryPath()).mkdir(QString("_%1.%2").arg(curTestCaseIndex).arg(curSingleCaseIndex));
-    QStringList entryList = QDir(Settings::temporaryPath() + contestantName).entryList(QDir::Files);
-    for (int i = 0; i < entryList.size(); i ++)
-        QFile::copy(Settings::temporaryPath() + contestantName + QDir::separator() + entryList[i],
-                    workingDirectory + entryList[i]);
+    if (compileThread) {
+        QStringList entryList = QDir(compileThread->getWorkingDirectory()).entryList(QDir::Files);
+        for (int i = 0; i < entryList.size(); i ++)
+            QFile::copy(compileThread->getWorkingDirectory() + entryList[i], workingDirectory + entryList[i]);
+    }
     thread->setSpecialJudgeTimeLimit(settings->getSpecialJudgeTimeLimit());
     thread->setDiffPath(settings->getDiffPath());
-    if (task->getTaskType() == Task::Traditional) {
+    thread->setArchivePath(outputArchivePath);
+    if (recheckMode)
+        thread->setArchivedOutput(recheckOutputs[curTestCaseIndex][curSingleCaseIndex]);
+    else if (task->getTaskType() == Task::Traditional) {
         if (interpreterFlag)
             thread->setExecutableFile(executableFile);
         else
@@ -340,15 +372,22 @@ void AssignmentThread::assign()
     }
     thread->setTask(task);
     
-    connect(thread, SIGNAL(finished()), this, SLOT(threadFinished()));
-    connect(this, SIGNAL(stopJudgingSignal()), thread, SLOT(stopJudgingSlot()));
+    int slot;
+    if (freeSlots.isEmpty()) {
+        slot = workerList.size();
+        workerList.append(0);
+        workerCase.append(qMakePair(-1, -1));
+    } else
+        slot = freeSlots.takeLast();
+    thread->setCompletionRing(completionRing, slot);
+    thread->setCancellationToken(cancellationToken);
     
     inputFiles[curTestCaseIndex][curSingleCaseIndex]
             = QFileInfo(curTestCase->getInputFiles().at(curSingleCaseIndex)).fileName();
     thread->setInputFile(Settings::dataPath() + curTestCase->getInputFiles().at(curSingleCaseIndex));
     thread->setOutputFile(Settings::dataPath() + curTestCase->getOutputFiles().at(curSingleCaseIndex));
     thread->setFullScore(curTestCase->getFullScore());
-    if (task->getTaskType() == Task::Traditional) {
+    if (task->getTaskType() == Task::Traditional && ! recheckMode) {
         thread->setEnvironment(environment);
         thread->setTimeLimit(qCeil(curTestCase->getTimeLimit() * timeLimitRatio));
         if (disableMemoryLimitCheck)
@@ -356,37 +395,47 @@ void AssignmentThread::assign()
         else
             thread->setMemoryLimit(qCeil(curTestCase->getMemoryLimit() * memoryLimitRatio));
     }
-    running[thread] = qMakePair(curTestCaseIndex, curSingleCaseIndex ++);
+    workerList[slot] = thread;
+    workerCase[slot] = qMakePair(curTestCaseIndex, curSingleCaseIndex);
+    runningCount ++;
     thread->start();
+    return true;
 }
 
-void AssignmentThread::threadFinished()
+void AssignmentThread::threadFinished(const CompletionRecord &record)
 {
-    JudgingThread *thread = dynamic_cast<JudgingThread*>(sender());
-    if (stopJudging) {
-        running.remove(thread);
+    JudgingThread *thread = workerList[record.slot];
+    QPair<int, int> cur = workerCase[record.slot];
+    workerList[record.slot] = 0;
+    freeSlots.append(record.slot);
+    runningCount --;
+    thread->wait();
+    if (processorPool) processorPool->releaseProcessor(record.processor);
+    memoryInUse -= getMemoryRequirement(cur.first);
+    if (isCancelled()) {
         delete thread;
-        if (running.size() == 0) quit();
         return;
     }
-    QPair<int, int> cur = running[thread];
-    timeUsed[cur.first][cur.second] = thread->getTimeUsed();
-    memoryUsed[cur.first][cur.second] = thread->getMemoryUsed();
-    score[cur.first][cur.second] = thread->getScore();
-    result[cur.first][cur.second] = thread->getResult();
+    timeUsed[cur.first][cur.second] = record.timeUsed;
+    memoryUsed[cur.first][cur.second] = record.memoryUsed;
+    score[cur.first][cur.second] = record.score;
+    result[cur.first][cur.second] = ResultState(record.result);
     message[cur.first][cur.second] = thread->getMessage();
-    if (! checkRejudgeMode && thread->getNeedRejudge())
+    processorUsed[cur.first][cur.second] = record.processor;
+    outputHash[cur.first][cur.second] = thread->getOutputHash();
+    if (! checkRejudgeMode && record.needRejudge)
         needRejudge.append(cur);
-    running.remove(thread);
-    countFinished ++;
     delete thread;
     emit singleCaseFinished(task->getTestCase(cur.first)->getTimeLimit(),
-                            cur.first, cur.second, int(result[cur.first][cur.second]));
-    assign();
+                            cur.first, cur.second, record.result, record.processor);
+    if (concurrencyController && ! checkRejudgeMode && ! recheckMode) {
+        numberOfWorkers = concurrencyController->getNumberOfWorkers();
+        if (processorPool)
+            numberOfWorkers = qMin(numberOfWorkers, processorPool->getProcessorCount());
+    }
 }
 
-void AssignmentThread::stopJudgingSlot()
+bool AssignmentThread::isCancelled() const
 {
-    stopJudging = true;
-    emit stopJudgingSignal();
+    return cancellationToken && cancellationToken->isCancelled();
 }
@@ -26,6 +26,12 @@
 class Settings;
 class Task;
 class JudgingThread;
+class ProcessorPool;
+class CompileThread;
+class ConcurrencyController;
+class CancellationToken;
+class CompletionRing;
+struct CompletionRecord;
 
 class AssignmentThread : public QThread
 {
@@ -37,6 +43,12 @@ public:
     void setSettings(Settings*);
     void setTask(Task*);
     void setContestantName(const QString&);
+    void setCompileThread(CompileThread*);
+    void setConcurrencyController(ConcurrencyController*);
+    void setCancellationToken(CancellationToken*);
+    void setOutputArchivePath(const QString&);
+    void setRecheckOutputs(const QList<QStringList>&);
+    bool getRecheckMode() const;
     CompileState getCompileState() const;
     const QString& getCompileMessage() const;
     const QString& getSourceFile() const;
@@ -46,11 +58,17 @@ public:
     const QList< QList<ResultState> >& getResult() const;
     const QList<QStringList>& getMessage() const;
     const QList<QStringList>& getInputFiles() const;
+    const QList< QList<int> >& getProcessorUsed() const;
     const QList< QPair<int, int> >& getNeedRejudge() const;
+    const QList<QStringList>& getOutputHash() const;
+    const QList< QPair<int, int> >& getRecheckList() const;
+    void writeResultToStream(QDataStream&);
+    void readResultFromStream(QDataStream&);
     void run();
 
 private:
     bool checkRejudgeMode;
+    bool recheckMode;
     bool interpreterFlag;
     Settings *settings;
     Task* task;
@@ -71,26 +89,36 @@ private:
     QList< QList<ResultState> > result;
     QList<QStringList> message;
     QList<QStringList> inputFiles;
+    QList< QList<int> > processorUsed;
+    QList<QStringList> outputHash;
+    QList<QStringList> recheckOutputs;
+    QList< QPair<int, int> > recheckList;
+    QString outputArchivePath;
+    ProcessorPool *processorPool;
+    CompileThread *compileThread;
+    ConcurrencyController *concurrencyController;
     QList< QPair<int, int> > needRejudge;
+    QList< QPair<int, int> > pendingList;
     int curTestCaseIndex;
     int curSingleCaseIndex;
-    int countFinished;
-    int totalSingleCase;
-    QMap< JudgingThread*, QPair<int, int> > running;
-    bool stopJudging;
+    int numberOfWorkers;
+    int memoryBudget;
+    int memoryInUse;
+    CompletionRing *completionRing;
+    QList<JudgingThread*> workerList;
+    QList< QPair<int, int> > workerCase;
+    QList<int> freeSlots;
+    int runningCount;
+    CancellationToken *cancellationToken;
     bool traditionalTaskPrepare();
-    void assign();
-
-private slots:
-    void threadFinished();
-
-public slots:
-    void stopJudgingSlot();
+    int getMemoryRequirement(int) const;
+    bool assign();
+    void threadFinished(const CompletionRecord&);
+    bool isCancelled() const;
 
 signals:
-    void singleCaseFinished(int, int, int, int);
+    void singleCaseFinished(int, int, int, int, int);
     void compileError(int, int);
-    void stopJudgingSignal();
 };
 
 #endif // ASSIGNMENTTHREAD_H
@@ -0,0 +1,149 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include <QtCore>
+#include "judgingthread.h"
+#include "cancellationtoken.h"
+#include "globaltype.h"
+#include "task.h"
+
+static void printUsage(QTextStream &err)
+{
+    err << "Usage: lemon-benchmark [options]" << endl
+        << "  -n, --lines <count>      lines per generated output file (default 1000000)" << endl
+        << "  -r, --rounds <count>     timed rounds per comparator, the best is reported (default 5)" << endl
+        << "Columns: \"events\" dispatches events on every comparator step, as the comparators" << endl
+        << "used to; \"checks off\" runs without a token; \"checks on\" reads the token every 64 KB." << endl;
+}
+
+static bool writeOutput(const QString &fileName, bool realNumbers, int lines)
+{
+    QFile file(fileName);
+    if (! file.open(QFile::WriteOnly)) return false;
+    QTextStream out(&file);
+    qsrand(1);
+    for (int i = 0; i < lines; i ++) {
+        if (i % 16 == 15) {
+            out << "\n";
+            continue;
+        }
+        for (int j = 0; j < 4; j ++) {
+            if (j > 0) out << " ";
+            if (realNumbers)
+                out << QString::number(qrand() / 1000.0, 'f', 6);
+            else
+                out << qrand();
+        }
+        out << "\n";
+    }
+    return file.error() == QFile::NoError;
+}
+
+static double measure(Task *task, const QString &fileName, CancellationToken *token, int rounds, bool &ok)
+{
+    double best = -1;
+    ok = true;
+    for (int i = 0; i < rounds; i ++) {
+        JudgingThread thread;
+        thread.setTask(task);
+        thread.setFullScore(1);
+        thread.setOutputFile(fileName);
+        thread.setCancellationToken(token);
+        QElapsedTimer timer;
+        timer.start();
+        thread.compareOutput(fileName);
+        double elapsed = timer.nsecsElapsed() / 1e6;
+        if (thread.getResult() != CorrectAnswer) ok = false;
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    
+    QStringList arguments = a.arguments();
+    int lines = 1000000, rounds = 5;
+    for (int i = 1; i < arguments.size(); i ++) {
+        if ((arguments[i] == "-n" || arguments[i] == "--lines") && i + 1 < arguments.size())
+            lines = arguments[++ i].toInt();
+        else if ((arguments[i] == "-r" || arguments[i] == "--rounds") && i + 1 < arguments.size())
+            rounds = arguments[++ i].toInt();
+        else {
+            printUsage(err);
+            return 1;
+        }
+    }
+    if (lines <= 0 || rounds <= 0) {
+        printUsage(err);
+        return 1;
+    }
+    
+    QString directory = QDir::tempPath() + QDir::separator()
+                        + QString("lemon-benchmark-%1").arg(a.applicationPid()) + QDir::separator();
+    QDir().mkpath(directory);
+    QString integerFile = directory + "integers.out";
+    QString realFile = directory + "reals.out";
+    if (! writeOutput(integerFile, false, lines) || ! writeOutput(realFile, true, lines)) {
+        err << QString("Cannot write test data to %1").arg(directory) << endl;
+        return 1;
+    }
+    
+    QList< QPair<QString, Task::ComparisonMode> > modes;
+    modes.append(qMakePair(QString("compareLineByLine"), Task::LineByLineMode));
+    modes.append(qMakePair(QString("compareIgnoreSpaces"), Task::IgnoreSpacesMode));
+    modes.append(qMakePair(QString("compareRealNumbers"), Task::RealNumberMode));
+    
+    CancellationToken token, pollingToken;
+    pollingToken.setPollingEvents(true);
+    bool failed = false;
+    out << QString("%1 lines, best of %2 rounds").arg(lines).arg(rounds) << endl;
+    out << QString("%1 %2 %3 %4 %5 %6").arg("comparator", -20).arg("events", 14)
+           .arg("checks off", 14).arg("checks on", 14).arg("overhead", 10).arg("speedup", 10) << endl;
+    for (int i = 0; i < modes.size(); i ++) {
+        Task task;
+        task.setComparisonMode(modes[i].second);
+        task.setRealPrecision(3);
+        QString fileName = modes[i].second == Task::RealNumberMode ? realFile : integerFile;
+        double megabytes = QFileInfo(fileName).size() / 1048576.0;
+        bool ok1, ok2, ok3;
+        double polling = measure(&task, fileName, &pollingToken, rounds, ok1);
+        double off = measure(&task, fileName, 0, rounds, ok2);
+        double on = measure(&task, fileName, &token, rounds, ok3);
+        if (! ok1 || ! ok2 || ! ok3) failed = true;
+        out << QString("%1 %2 %3 %4 %5 %6")
+               .arg(modes[i].first, -20)
+               .arg(QString("%1 MB/s").arg(megabytes / polling * 1000, 0, 'f', 1), 14)
+               .arg(QString("%1 MB/s").arg(megabytes / off * 1000, 0, 'f', 1), 14)
+               .arg(QString("%1 MB/s").arg(megabytes / on * 1000, 0, 'f', 1), 14)
+               .arg(QString("%1%").arg((on - off) / off * 100, 0, 'f', 1), 10)
+               .arg(QString("%1x").arg(polling / on, 0, 'f', 1), 10) << endl;
+    }
+    
+    QFile::remove(integerFile);
+    QFile::remove(realFile);
+    QDir().rmdir(directory);
+    if (failed) {
+        err << "A comparator rejected identical output" << endl;
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "cancellationtoken.h"
+
+CancellationToken::CancellationToken() :
+    cancelled(0), pollingEvents(false)
+{
+}
+
+void CancellationToken::cancel()
+{
+    cancelled.fetchAndStoreOrdered(1);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return cancelled != 0;
+}
+
+void CancellationToken::setPollingEvents(bool polling)
+{
+    pollingEvents = polling;
+}
+
+bool CancellationToken::isPollingEvents() const
+{
+    return pollingEvents;
+}
+
+CancellationCheckpoint::CancellationCheckpoint(const CancellationToken *_token, int _interval) :
+    token(_token), interval(_interval), remaining(_interval)
+{
+    if (token && token->isPollingEvents()) interval = remaining = 1;
+}
@@ -0,0 +1,58 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QtCore>
+
+class CancellationToken
+{
+public:
+    CancellationToken();
+    void cancel();
+    bool isCancelled() const;
+    void setPollingEvents(bool);
+    bool isPollingEvents() const;
+
+private:
+    QAtomicInt cancelled;
+    bool pollingEvents;
+};
+
+class CancellationCheckpoint
+{
+public:
+    explicit CancellationCheckpoint(const CancellationToken*, int interval = 64 * 1024);
+    bool isCancelled(int consumed)
+    {
+        if (! token) return false;
+        remaining -= consumed;
+        if (remaining > 0) return false;
+        remaining = interval;
+        if (token->isPollingEvents()) QCoreApplication::processEvents();
+        return token->isCancelled();
+    }
+
+private:
+    const CancellationToken *token;
+    int interval;
+    int remaining;
+};
+
+#endif // CANCELLATIONTOKEN_H
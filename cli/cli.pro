@@ -0,0 +1,32 @@
+#
+#    Project Lemon - A tiny judging environment for OI contest
+#    Copyright (C) 2011 Zhipeng Jia
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+QT       += core
+QT       -= gui
+
+TARGET = lemon-cli
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../lemoncore.pri)
+
+SOURCES += ../climain.cpp \
+    ../clireporter.cpp
+
+HEADERS  += ../clireporter.h
@@ -0,0 +1,305 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include <QtCore>
+#include "contest.h"
+#include "contestant.h"
+#include "task.h"
+#include "settings.h"
+#include "clireporter.h"
+#include "resultdatabase.h"
+#include "resultexporter.h"
+
+static void printUsage(QTextStream &err)
+{
+    err << "Usage: lemon-cli [options] <contest file>" << endl
+        << "       lemon-cli -m <output file> <contest file>..." << endl
+        << "       lemon-cli -q <sql> <contest file>" << endl
+        << "       lemon-cli -e <output file> <contest file>" << endl
+        << "  -c, --contestant <name>  judge only this contestant (may be repeated)" << endl
+        << "  -t, --task <title>       judge only this task (may be repeated)" << endl
+        << "  -n, --no-save            do not write the results back to the contest file" << endl
+        << "      --stale              judge only results whose source, compiler or data changed" << endl
+        << "      --recheck            re-compare archived outputs whose answers or checker changed" << endl
+        << "      --resume             finish the judging run that was interrupted last time" << endl
+        << "  -w, --worker <host:port> judge on this lemon-worker (may be repeated)" << endl
+        << "  -s, --shard <i/n>        judge only the contestants of shard i (1..n)" << endl
+        << "  -m, --merge <file>       merge the results of the given contest files into file" << endl
+        << "  -q, --query <sql>        run a query on the result database of the contest file" << endl
+        << "                           (tables tasks, states, task_results, case_results)" << endl
+        << "  -e, --export <file>      export the results as .html, or one record per case as .csv or .jsonl" << endl
+        << "Exit status: 0 judged and saved, 1 bad arguments, 2 cannot read the contest file," << endl
+        << "             3 cannot save the results, 4 invalid compiler or special judge seen" << endl
+        << "             or stored results unreadable," << endl
+        << "             5 the contest files to merge have different tasks, 6 the query failed" << endl;
+}
+
+static Contest* loadContest(const QString &filePath, Settings *settings, QTextStream &err)
+{
+    Contest *contest = new Contest(settings->parent());
+    contest->setSettings(settings);
+    ContestFileState state = contest->loadFromFile(filePath);
+    if (state == CannotOpenContestFile)
+        err << QString("Cannot open file %1").arg(filePath) << endl;
+    if (state == BrokenContestFile)
+        err << QString("File %1 is broken").arg(filePath) << endl;
+    if (state == ContestFileLoaded) return contest;
+    delete contest;
+    return 0;
+}
+
+static int mergeContests(const QString &outputPath, const QStringList &inputList,
+                         Settings *settings, QTextStream &err)
+{
+    Contest *contest = loadContest(inputList[0], settings, err);
+    if (! contest) return 2;
+    for (int i = 1; i < inputList.size(); i ++) {
+        Contest *other = loadContest(inputList[i], settings, err);
+        if (! other) return 2;
+        if (! contest->mergeResultsFrom(other)) {
+            err << QString("Tasks in %1 differ from %2").arg(inputList[i]).arg(inputList[0]) << endl;
+            return 5;
+        }
+        delete other;
+    }
+    if (! contest->saveToFile(outputPath)) {
+        err << QString("Cannot save file %1").arg(outputPath) << endl;
+        return 3;
+    }
+    return 0;
+}
+
+static int queryDatabase(const QString &statement, const QString &filePath,
+                         Settings *settings, QTextStream &err)
+{
+    QString databaseFileName = ResultDatabase::databaseFileName(filePath);
+    if (! QFileInfo(databaseFileName).exists()) {
+        settings->setResultDatabaseEnabled(true);
+        Contest *contest = loadContest(filePath, settings, err);
+        if (! contest) return 2;
+        delete contest;
+    }
+    ResultDatabase *database = new ResultDatabase(settings->parent());
+    if (! database->open(databaseFileName)) {
+        err << QString("Cannot open database %1").arg(databaseFileName) << endl;
+        return 6;
+    }
+    
+    QTextStream out(stdout);
+    bool succeeded;
+    {
+        QSqlQuery query(database->getDatabase());
+        query.setForwardOnly(true);
+        succeeded = query.exec(statement);
+        if (succeeded) {
+            QSqlRecord record = query.record();
+            QStringList row;
+            for (int i = 0; i < record.count(); i ++)
+                row.append(record.fieldName(i));
+            if (! row.isEmpty()) out << row.join("\t") << endl;
+            while (query.next()) {
+                row.clear();
+                for (int i = 0; i < record.count(); i ++)
+                    row.append(query.value(i).toString().replace('\t', ' ').replace('\n', ' '));
+                out << row.join("\t") << endl;
+            }
+        } else
+            err << query.lastError().text() << endl;
+    }
+    delete database;
+    return succeeded ? 0 : 6;
+}
+
+static int exportContest(const QString &outputPath, const QString &filePath,
+                         Settings *settings, QTextStream &err)
+{
+    QString suffix = QFileInfo(outputPath).suffix();
+    ResultExporter::ExportFormat format;
+    if (suffix == "html")
+        format = ResultExporter::HtmlFormat;
+    else if (suffix == "csv")
+        format = ResultExporter::CsvFormat;
+    else if (suffix == "jsonl")
+        format = ResultExporter::JsonLinesFormat;
+    else {
+        err << QString("Unknown export format %1").arg(outputPath) << endl;
+        return 1;
+    }
+    
+    Contest *contest = loadContest(filePath, settings, err);
+    if (! contest) return 2;
+    CliReporter *reporter = new CliReporter(settings->parent());
+    reporter->setContest(contest);
+    ResultExporter *exporter = new ResultExporter(settings->parent());
+    exporter->setContest(contest);
+    if (! exporter->exportFile(outputPath, format)) {
+        err << QString("Cannot save file %1").arg(outputPath) << endl;
+        return 3;
+    }
+    // failures found by the rendering threads arrive as queued signals
+    QCoreApplication::processEvents();
+    return reporter->getFailureCount() > 0 ? 4 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream err(stderr);
+    
+    QStringList arguments = a.arguments();
+    QStringList nameList, titleList, workerList;
+    QString filePath;
+    bool saveResult = true, staleOnly = false, recheckOnly = false, resumeOnly = false;
+    int shardIndex = 0, shardCount = 0;
+    
+    if (arguments.size() > 1 && (arguments[1] == "-m" || arguments[1] == "--merge")) {
+        if (arguments.size() < 4) {
+            printUsage(err);
+            return 1;
+        }
+        Settings *settings = new Settings(&a);
+        settings->loadSettings();
+        return mergeContests(arguments[2], arguments.mid(3), settings, err);
+    }
+    
+    if (arguments.size() > 1 && (arguments[1] == "-e" || arguments[1] == "--export")) {
+        if (arguments.size() != 4) {
+            printUsage(err);
+            return 1;
+        }
+        Settings *settings = new Settings(&a);
+        settings->loadSettings();
+        return exportContest(arguments[2], QFileInfo(arguments[3]).absoluteFilePath(), settings, err);
+    }
+    
+    if (arguments.size() > 1 && (arguments[1] == "-q" || arguments[1] == "--query")) {
+        if (arguments.size() != 4) {
+            printUsage(err);
+            return 1;
+        }
+        Settings *settings = new Settings(&a);
+        settings->loadSettings();
+        return queryDatabase(arguments[2], QFileInfo(arguments[3]).absoluteFilePath(), settings, err);
+    }
+    
+    for (int i = 1; i < arguments.size(); i ++) {
+        if ((arguments[i] == "-c" || arguments[i] == "--contestant") && i + 1 < arguments.size())
+            nameList.append(arguments[++ i]);
+        else if ((arguments[i] == "-t" || arguments[i] == "--task") && i + 1 < arguments.size())
+            titleList.append(arguments[++ i]);
+        else if ((arguments[i] == "-w" || arguments[i] == "--worker") && i + 1 < arguments.size())
+            workerList.append(arguments[++ i]);
+        else if ((arguments[i] == "-s" || arguments[i] == "--shard") && i + 1 < arguments.size()) {
+            QStringList shard = arguments[++ i].split("/");
+            if (shard.size() == 2) {
+                shardIndex = shard[0].toInt();
+                shardCount = shard[1].toInt();
+            }
+            if (shardCount <= 0 || shardIndex <= 0 || shardIndex > shardCount) {
+                printUsage(err);
+                return 1;
+            }
+        } else if (arguments[i] == "-n" || arguments[i] == "--no-save")
+            saveResult = false;
+        else if (arguments[i] == "--stale")
+            staleOnly = true;
+        else if (arguments[i] == "--recheck")
+            recheckOnly = true;
+        else if (arguments[i] == "--resume")
+            resumeOnly = true;
+        else if (arguments[i].startsWith("-") || ! filePath.isEmpty()) {
+            printUsage(err);
+            return 1;
+        } else
+            filePath = arguments[i];
+    }
+    if (filePath.isEmpty()) {
+        printUsage(err);
+        return 1;
+    }
+    filePath = QFileInfo(filePath).absoluteFilePath();
+    
+    Settings *settings = new Settings(&a);
+    settings->loadSettings();
+    if (! workerList.isEmpty()) settings->setWorkerHosts(workerList.join(";"));
+    Contest *contest = loadContest(filePath, settings, err);
+    if (! contest) return 2;
+    contest->setJournalEnabled(saveResult);
+    if (contest->getRecoveredCount() > 0)
+        err << QString("Recovered %1 unsaved result(s) from the journal").arg(contest->getRecoveredCount()) << endl;
+    QDir::setCurrent(QFileInfo(filePath).path());
+    contest->refreshContestantList();
+    
+    QList<Task*> taskList = contest->getTaskList();
+    QList<int> indexList;
+    for (int i = 0; i < titleList.size(); i ++) {
+        int index = -1;
+        for (int j = 0; j < taskList.size(); j ++)
+            if (taskList[j]->getProblemTile() == titleList[i]) index = j;
+        if (index == -1) {
+            err << QString("No task named %1").arg(titleList[i]) << endl;
+            return 1;
+        }
+        if (! indexList.contains(index)) indexList.append(index);
+    }
+    if (titleList.isEmpty())
+        for (int i = 0; i < taskList.size(); i ++)
+            indexList.append(i);
+    
+    for (int i = 0; i < nameList.size(); i ++)
+        if (! contest->getContestant(nameList[i])) {
+            err << QString("No contestant named %1").arg(nameList[i]) << endl;
+            return 1;
+        }
+    if (nameList.isEmpty()) {
+        QList<Contestant*> contestantList = contest->getContestantList();
+        for (int i = 0; i < contestantList.size(); i ++)
+            nameList.append(contestantList[i]->getContestantName());
+    }
+    if (shardCount > 0)
+        for (int i = nameList.size() - 1; i >= 0; i --)
+            if (Contest::getShardIndex(nameList[i], shardCount) != shardIndex - 1)
+                nameList.removeAt(i);
+    
+    CliReporter *reporter = new CliReporter(&a);
+    reporter->setContest(contest);
+    QEventLoop eventLoop;
+    QObject::connect(contest, SIGNAL(judgingFinished()), &eventLoop, SLOT(quit()));
+    if (staleOnly || recheckOnly || resumeOnly) {
+        QList< QPair<QString, int> > jobList;
+        if (resumeOnly)
+            jobList = contest->getResumeJobs();
+        else
+            jobList = recheckOnly ? contest->getRecheckJobs() : contest->getStaleJobs();
+        for (int i = jobList.size() - 1; i >= 0; i --)
+            if (! nameList.contains(jobList[i].first) || ! indexList.contains(jobList[i].second))
+                jobList.removeAt(i);
+        if (recheckOnly)
+            contest->recheck(jobList);
+        else
+            contest->judge(jobList);
+    } else
+        contest->judge(nameList, indexList);
+    eventLoop.exec();
+    
+    if (saveResult && ! contest->saveToFile(filePath)) {
+        err << QString("Cannot save file %1").arg(filePath) << endl;
+        return 3;
+    }
+    return reporter->getFailureCount() > 0 ? 4 : 0;
+}
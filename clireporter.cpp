@@ -0,0 +1,166 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "clireporter.h"
+#include "contest.h"
+
+CliReporter::CliReporter(QObject *parent) :
+    QObject(parent), out(stdout)
+{
+    failureCount = 0;
+}
+
+void CliReporter::setContest(Contest *contest)
+{
+    connect(contest, SIGNAL(singleCaseFinished(int, int, int, int, int)),
+            this, SLOT(singleCaseFinished(int, int, int, int, int)));
+    connect(contest, SIGNAL(taskJudgingStarted(QString)),
+            this, SLOT(taskJudgingStarted(QString)));
+    connect(contest, SIGNAL(contestantJudgingStart(QString)),
+            this, SLOT(contestantJudgingStart(QString)));
+    connect(contest, SIGNAL(contestantJudgingFinished()),
+            this, SLOT(contestantJudgingFinished()));
+    connect(contest, SIGNAL(compileError(int, int)),
+            this, SLOT(compileError(int, int)));
+    connect(contest, SIGNAL(compileFailed(QString, QString, int)),
+            this, SLOT(compileFailed(QString, QString, int)));
+    connect(contest, SIGNAL(numberOfWorkersChanged(int, QString)),
+            this, SLOT(numberOfWorkersChanged(int, QString)));
+    connect(contest, SIGNAL(detailsLoadFailed(QString)),
+            this, SLOT(detailsLoadFailed(QString)));
+}
+
+int CliReporter::getFailureCount() const
+{
+    return failureCount;
+}
+
+void CliReporter::singleCaseFinished(int, int x, int y, int result, int processor)
+{
+    QString text;
+    switch (ResultState(result)) {
+        case CorrectAnswer: {
+            text = tr("Correct answer");
+            break;
+        }
+        case WrongAnswer: {
+            text = tr("Wrong answer");
+            break;
+        }
+        case PartlyCorrect: {
+            text = tr("Partly correct");
+            break;
+        }
+        case TimeLimitExceeded: {
+            text = tr("Time limit exceeded");
+            break;
+        }
+        case MemoryLimitExceeded: {
+            text = tr("Memory limit exceeded");
+            break;
+        }
+        case CannotStartProgram: {
+            text = tr("Cannot start program");
+            break;
+        }
+        case FileError: {
+            text = tr("File error");
+            break;
+        }
+        case RunTimeError: {
+            text = tr("Run time error");
+            break;
+        }
+        case InvalidSpecialJudge: {
+            text = tr("Invalid special judge");
+            failureCount ++;
+            break;
+        }
+        case SpecialJudgeTimeLimitExceeded: {
+            text = tr("Special judge time limit exceeded");
+            failureCount ++;
+            break;
+        }
+        case SpecialJudgeRunTimeError: {
+            text = tr("Special judge run time error");
+            failureCount ++;
+            break;
+        }
+    }
+    
+    out << "    " << tr("Test case %1.%2: ").arg(x + 1).arg(y + 1) << text;
+    if (processor != -1) out << tr(" (CPU %1)").arg(processor);
+    out << endl;
+}
+
+void CliReporter::taskJudgingStarted(const QString &taskName)
+{
+    out << "  " << tr("Start judging task %1").arg(taskName) << endl;
+}
+
+void CliReporter::contestantJudgingStart(const QString &contestantName)
+{
+    out << tr("Start judging contestant %1").arg(contestantName) << endl;
+}
+
+void CliReporter::contestantJudgingFinished()
+{
+    out << endl;
+}
+
+void CliReporter::compileError(int, int compileState)
+{
+    QString text;
+    switch (CompileState(compileState)) {
+        case NoValidSourceFile: {
+            text = tr("Cannot find valid source file");
+            break;
+        }
+        case CompileError: {
+            text = tr("Compile error");
+            break;
+        }
+        case CompileTimeLimitExceeded: {
+            text = tr("Compile time limit exceeded");
+            break;
+        }
+        case InvalidCompiler: {
+            text = tr("Invalid compiler");
+            failureCount ++;
+            break;
+        }
+    }
+    out << "    " << text << endl;
+}
+
+void CliReporter::compileFailed(const QString &contestantName, const QString &taskName, int)
+{
+    out << "  " << tr("Compilation of task %1 for contestant %2 failed").arg(taskName, contestantName) << endl;
+}
+
+void CliReporter::numberOfWorkersChanged(int number, const QString &reason)
+{
+    out << "    " << tr("Using %1 judging threads (%2)").arg(number).arg(reason) << endl;
+}
+
+void CliReporter::detailsLoadFailed(const QString &contestantName)
+{
+    QTextStream err(stderr);
+    err << tr("Cannot read the results of %1 from the contest file").arg(contestantName) << endl;
+    failureCount ++;
+}
@@ -0,0 +1,51 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef CLIREPORTER_H
+#define CLIREPORTER_H
+
+#include <QtCore>
+#include <QObject>
+#include "globaltype.h"
+
+class Contest;
+
+class CliReporter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CliReporter(QObject *parent = 0);
+    void setContest(Contest*);
+    int getFailureCount() const;
+
+private:
+    QTextStream out;
+    int failureCount;
+
+public slots:
+    void singleCaseFinished(int, int, int, int, int);
+    void taskJudgingStarted(const QString&);
+    void contestantJudgingStart(const QString&);
+    void contestantJudgingFinished();
+    void compileError(int, int);
+    void compileFailed(const QString&, const QString&, int);
+    void numberOfWorkersChanged(int, const QString&);
+    void detailsLoadFailed(const QString&);
+};
+
+#endif // CLIREPORTER_H
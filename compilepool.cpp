@@ -0,0 +1,200 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "compilepool.h"
+#include "compilethread.h"
+#include "cancellationtoken.h"
+#include "fileutility.h"
+#include "settings.h"
+#include "task.h"
+
+CompilePool::CompilePool(QObject *parent) :
+    QObject(parent)
+{
+    settings = 0;
+    cancellationToken = 0;
+    concurrencyController = 0;
+    waitLoop = 0;
+}
+
+CompilePool::~CompilePool()
+{
+    QList<CompileThread*> threads = startedJobs.values();
+    for (int i = 0; i < threads.size(); i ++) {
+        threads[i]->wait();
+        delete threads[i];
+    }
+    startedJobs.clear();
+    FileUtility::clearPath(Settings::compilePath());
+    QDir().rmdir(Settings::compilePath());
+    if (settings) pruneCache(qint64(settings->getCompileCacheSizeLimit()) * 1024 * 1024);
+}
+
+void CompilePool::setSettings(Settings *_settings)
+{
+    settings = _settings;
+}
+
+void CompilePool::setTaskList(const QList<Task*> &list)
+{
+    taskList = list;
+}
+
+void CompilePool::setCancellationToken(CancellationToken *token)
+{
+    cancellationToken = token;
+}
+
+void CompilePool::setConcurrencyController(ConcurrencyController *controller)
+{
+    concurrencyController = controller;
+}
+
+bool CompilePool::isCancelled() const
+{
+    return cancellationToken && cancellationToken->isCancelled();
+}
+
+void CompilePool::addJob(const QString &contestantName, int index)
+{
+    if (taskList[index]->getTaskType() != Task::Traditional) return;
+    pendingJobs.append(qMakePair(contestantName, index));
+}
+
+void CompilePool::addPriorityJob(const QString &contestantName, int index)
+{
+    if (taskList[index]->getTaskType() != Task::Traditional) return;
+    QPair<QString, int> job(contestantName, index);
+    if (startedJobs.contains(job)) return;
+    pendingJobs.removeAll(job);
+    pendingJobs.prepend(job);
+    schedule();
+}
+
+void CompilePool::startJob(const QPair<QString, int> &job)
+{
+    CompileThread *thread = new CompileThread();
+    thread->setSettings(settings);
+    thread->setTask(taskList[job.second]);
+    thread->setContestantName(job.first);
+    thread->setWorkingDirectory(Settings::compilePath() + job.first + QDir::separator()
+                                + QString::number(job.second) + QDir::separator());
+    thread->setCancellationToken(cancellationToken);
+    thread->setConcurrencyController(concurrencyController);
+    connect(thread, SIGNAL(finished()), this, SLOT(threadFinished()));
+    startedJobs.insert(job, thread);
+    thread->start();
+}
+
+void CompilePool::schedule()
+{
+    while (! isCancelled() && ! pendingJobs.isEmpty()
+           && startedJobs.size() < qMax(1, settings->getCompileAheadDepth()))
+        startJob(pendingJobs.takeFirst());
+}
+
+CompileThread* CompilePool::takeCompileThread(const QString &contestantName, int index)
+{
+    if (isCancelled()) return 0;
+    
+    QPair<QString, int> job(contestantName, index);
+    if (! startedJobs.contains(job)) {
+        pendingJobs.removeAll(job);
+        startJob(job);
+    }
+    CompileThread *thread = startedJobs.take(job);
+    schedule();
+    
+    waitLoop = new QEventLoop(this);
+    connect(thread, SIGNAL(finished()), waitLoop, SLOT(quit()));
+    if (! thread->isFinished()) {
+        QTimer *cancelTimer = new QTimer(waitLoop);
+        connect(cancelTimer, SIGNAL(timeout()), this, SLOT(checkCancelled()));
+        cancelTimer->start(100);
+        waitLoop->exec();
+    }
+    delete waitLoop;
+    waitLoop = 0;
+    
+    if (isCancelled()) {
+        releaseCompileThread(thread);
+        return 0;
+    }
+    
+    thread->wait();
+    return thread;
+}
+
+void CompilePool::releaseCompileThread(CompileThread *thread)
+{
+    if (! thread) return;
+    thread->wait();
+    FileUtility::clearPath(thread->getWorkingDirectory());
+    QDir().rmdir(thread->getWorkingDirectory());
+    QDir().rmdir(Settings::compilePath() + thread->getContestantName());
+    delete thread;
+}
+
+void CompilePool::threadFinished()
+{
+    if (isCancelled()) return;
+    QMapIterator< QPair<QString, int>, CompileThread* > i(startedJobs);
+    while (i.hasNext()) {
+        i.next();
+        if (! i.value()->isFinished() || reportedJobs.contains(i.key())) continue;
+        if (i.value()->getCompileState() == CompileSuccessfully) continue;
+        reportedJobs.insert(i.key());
+        emit compileFailed(i.key().first, i.key().second, int(i.value()->getCompileState()));
+    }
+}
+
+void CompilePool::checkCancelled()
+{
+    if (waitLoop && isCancelled()) waitLoop->quit();
+}
+
+void CompilePool::pruneCache(qint64 limit)
+{
+    QDir cacheDir(Settings::compileCachePath());
+    QStringList entryList = cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QMultiMap<QDateTime, QString> entries;
+    QMap<QString, qint64> entrySize;
+    qint64 totalSize = 0;
+    for (int i = 0; i < entryList.size(); i ++) {
+        if (entryList[i].contains('.')) continue;
+        QString entryPath = Settings::compileCachePath() + entryList[i] + QDir::separator();
+        QFileInfoList fileList = QDir(entryPath + "files").entryInfoList(QDir::Files);
+        qint64 size = QFileInfo(entryPath + "state").size();
+        for (int j = 0; j < fileList.size(); j ++)
+            size += fileList[j].size();
+        QFileInfo usedInfo(entryPath + "used");
+        if (! usedInfo.exists()) usedInfo = QFileInfo(entryPath + "state");
+        entries.insert(usedInfo.lastModified(), entryList[i]);
+        entrySize.insert(entryList[i], size);
+        totalSize += size;
+    }
+    
+    QMapIterator<QDateTime, QString> i(entries);
+    while (totalSize > limit && i.hasNext()) {
+        i.next();
+        QString entryPath = Settings::compileCachePath() + i.value() + QDir::separator();
+        FileUtility::clearPath(entryPath);
+        cacheDir.rmdir(i.value());
+        totalSize -= entrySize.value(i.value());
+    }
+}
@@ -0,0 +1,68 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef COMPILEPOOL_H
+#define COMPILEPOOL_H
+
+#include <QtCore>
+#include <QObject>
+
+class Settings;
+class Task;
+class CompileThread;
+class CancellationToken;
+class ConcurrencyController;
+
+class CompilePool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CompilePool(QObject *parent = 0);
+    ~CompilePool();
+    void setSettings(Settings*);
+    void setTaskList(const QList<Task*>&);
+    void setCancellationToken(CancellationToken*);
+    void setConcurrencyController(ConcurrencyController*);
+    void addJob(const QString&, int);
+    void addPriorityJob(const QString&, int);
+    CompileThread* takeCompileThread(const QString&, int);
+    void releaseCompileThread(CompileThread*);
+
+private:
+    Settings *settings;
+    QList<Task*> taskList;
+    QList< QPair<QString, int> > pendingJobs;
+    QMap< QPair<QString, int>, CompileThread* > startedJobs;
+    QSet< QPair<QString, int> > reportedJobs;
+    CancellationToken *cancellationToken;
+    ConcurrencyController *concurrencyController;
+    QEventLoop *waitLoop;
+    bool isCancelled() const;
+    void startJob(const QPair<QString, int>&);
+    void schedule();
+    void pruneCache(qint64);
+
+private slots:
+    void threadFinished();
+    void checkCancelled();
+
+signals:
+    void compileFailed(const QString&, int, int);
+};
+
+#endif // COMPILEPOOL_H
@@ -0,0 +1,368 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "compilethread.h"
+#include "cancellationtoken.h"
+#include "processorpool.h"
+#include "concurrencycontroller.h"
+#include "settings.h"
+#include "compiler.h"
+#include "task.h"
+
+CompileThread::CompileThread(QObject *parent) :
+    QThread(parent)
+{
+    moveToThread(this);
+    compileState = NoValidSourceFile;
+    interpreterFlag = false;
+    timeLimitRatio = 1;
+    memoryLimitRatio = 1;
+    disableMemoryLimitCheck = false;
+    cancellationToken = 0;
+    concurrencyController = 0;
+}
+
+void CompileThread::setSettings(Settings *_settings)
+{
+    settings = _settings;
+}
+
+void CompileThread::setTask(Task *_task)
+{
+    task = _task;
+}
+
+void CompileThread::setContestantName(const QString &name)
+{
+    contestantName = name;
+}
+
+void CompileThread::setWorkingDirectory(const QString &directory)
+{
+    workingDirectory = directory;
+}
+
+void CompileThread::setCancellationToken(CancellationToken *token)
+{
+    cancellationToken = token;
+}
+
+void CompileThread::setConcurrencyController(ConcurrencyController *controller)
+{
+    concurrencyController = controller;
+}
+
+const QString& CompileThread::getContestantName() const
+{
+    return contestantName;
+}
+
+const QString& CompileThread::getWorkingDirectory() const
+{
+    return workingDirectory;
+}
+
+CompileState CompileThread::getCompileState() const
+{
+    return compileState;
+}
+
+const QString& CompileThread::getCompileMessage() const
+{
+    return compileMessage;
+}
+
+const QString& CompileThread::getSourceFile() const
+{
+    return sourceFile;
+}
+
+const QString& CompileThread::getExecutableFile() const
+{
+    return executableFile;
+}
+
+const QString& CompileThread::getArguments() const
+{
+    return arguments;
+}
+
+bool CompileThread::getInterpreterFlag() const
+{
+    return interpreterFlag;
+}
+
+double CompileThread::getTimeLimitRatio() const
+{
+    return timeLimitRatio;
+}
+
+double CompileThread::getMemoryLimitRatio() const
+{
+    return memoryLimitRatio;
+}
+
+bool CompileThread::getDisableMemoryLimitCheck() const
+{
+    return disableMemoryLimitCheck;
+}
+
+const QProcessEnvironment& CompileThread::getEnvironment() const
+{
+    return environment;
+}
+
+void CompileThread::run()
+{
+    if (concurrencyController) concurrencyController->beginHousekeeping();
+    compile();
+    if (concurrencyController) concurrencyController->endHousekeeping();
+}
+
+void CompileThread::compile()
+{
+    compileState = NoValidSourceFile;
+    QDir contestantDir = QDir(Settings::sourcePath() + contestantName);
+    QList<Compiler*> compilerList = settings->getCompilerList();
+    
+    for (int i = 0; i < compilerList.size(); i ++) {
+        if (task->getCompilerConfiguration(compilerList[i]->getCompilerName()) == "disable") continue;
+        QStringList filters = compilerList[i]->getSourceExtensions();
+        for (int j = 0; j < filters.size(); j ++)
+            filters[j] = task->getSourceFileName() + "." + filters[j];
+        QStringList files = contestantDir.entryList(filters, QDir::Files);
+        sourceFile = "";
+        for (int j = 0; j < files.size(); j ++) {
+            qint64 fileSize = QFileInfo(Settings::sourcePath() + contestantName + QDir::separator() + files[j]).size();
+            if (fileSize <= settings->getFileSizeLimit() * 1024) {
+                sourceFile = files[j];
+                break;
+            }
+        }
+        
+        if (! sourceFile.isEmpty()) {
+            QDir().mkpath(workingDirectory);
+            QFile::copy(Settings::sourcePath() + contestantName + QDir::separator() + sourceFile,
+                        workingDirectory + sourceFile);
+            QStringList configurationNames = compilerList[i]->getConfigurationNames();
+            QStringList compilerArguments = compilerList[i]->getCompilerArguments();
+            QStringList interpreterArguments = compilerList[i]->getInterpreterArguments();
+            QString currentConfiguration = task->getCompilerConfiguration(compilerList[i]->getCompilerName());
+            for (int j = 0; j < configurationNames.size(); j ++)
+                if (configurationNames[j] == currentConfiguration) {
+                    timeLimitRatio = compilerList[i]->getTimeLimitRatio();
+                    memoryLimitRatio = compilerList[i]->getMemoryLimitRatio();
+                    disableMemoryLimitCheck = compilerList[i]->getDisableMemoryLimitCheck();
+                    environment = compilerList[i]->getEnvironment();
+                    QStringList values = environment.toStringList();
+                    for (int k = 0; k < values.size(); k ++) {
+                        int tmp = values[k].indexOf("=");
+                        QString variable = values[k].mid(0, tmp);
+                        environment.insert(variable, 
+                                           environment.value(variable) + ";"
+                                           + QProcessEnvironment::systemEnvironment().value(variable));
+                    }
+                    
+                    if (compilerList[i]->getCompilerType() == Compiler::Typical) {
+#ifdef Q_OS_WIN32
+                                executableFile = task->getSourceFileName() + ".exe";
+#endif
+#ifdef Q_OS_LINUX
+                                executableFile = task->getSourceFileName();
+#endif
+                                interpreterFlag = false;
+                    } else {
+                        executableFile = compilerList[i]->getInterpreterLocation();
+                        arguments = interpreterArguments[j];
+                        arguments.replace("%s.*", sourceFile);
+                        arguments.replace("%s", task->getSourceFileName());
+                        interpreterFlag = true;
+                    }
+                    
+                    if (compilerList[i]->getCompilerType() != Compiler::InterpretiveWithoutByteCode) {
+                        QString arguments = compilerArguments[j];
+                        arguments.replace("%s.*", sourceFile);
+                        arguments.replace("%s", task->getSourceFileName());
+                        QString key = getCacheKey(compilerList[i], arguments);
+                        if (restoreFromCache(key)) break;
+                        int processor = -1;
+                        if (settings->getPinJudgingThreads())
+                            processor = settings->getHousekeepingProcessor();
+                        QProcess *compiler = new PinnedProcess(processor, this);
+                        compiler->setProcessChannelMode(QProcess::MergedChannels);
+                        compiler->setProcessEnvironment(environment);
+                        compiler->setWorkingDirectory(workingDirectory);
+                        compiler->start(QString("\"") + compilerList[i]->getCompilerLocation() + "\" " + arguments);
+                        if (! compiler->waitForStarted(-1)) {
+                            compileState = InvalidCompiler;
+                            delete compiler;
+                            break;
+                        }
+                        QElapsedTimer timer;
+                        timer.start();
+                        bool flag = false;
+                        while (timer.elapsed() < settings->getCompileTimeLimit()) {
+                            if (compiler->state() != QProcess::Running) {
+                                flag = true;
+                                break;
+                            }
+                            if (cancellationToken && cancellationToken->isCancelled()) {
+                                compiler->kill();
+                                delete compiler;
+                                return;
+                            }
+                            msleep(10);
+                        }
+                        if (! flag) {
+                            compiler->kill();
+                            compileState = CompileTimeLimitExceeded;
+                        } else
+                            if (compiler->exitCode() != 0) {
+                                compileState = CompileError;
+                                compileMessage = QString::fromLocal8Bit(compiler->readAllStandardOutput().data());
+                            } else {
+                                if (compilerList[i]->getCompilerType() == Compiler::Typical) {
+                                    if (! QDir(workingDirectory).exists(executableFile))
+                                        compileState = InvalidCompiler;
+                                    else
+                                        compileState = CompileSuccessfully;
+                                } else {
+                                    QStringList filters = compilerList[i]->getBytecodeExtensions();
+                                    for (int k = 0; k < filters.size(); k ++)
+                                        filters[k] = QString("*.") + filters[k];
+                                    if (QDir(workingDirectory)
+                                            .entryList(filters, QDir::Files).size() == 0)
+                                        compileState = InvalidCompiler;
+                                    else
+                                        compileState = CompileSuccessfully;
+                                }
+                            }
+                        delete compiler;
+                        saveToCache(key);
+                    }
+                    
+                    if (compilerList[i]->getCompilerType() == Compiler::InterpretiveWithoutByteCode)
+                        compileState = CompileSuccessfully;
+                    
+                    break;
+                }
+            break;
+        }
+    }
+}
+
+QString CompileThread::getCacheKey(Compiler *compiler, const QString &compilerArguments) const
+{
+    QFile source(workingDirectory + sourceFile);
+    if (! source.open(QFile::ReadOnly)) return QString();
+    QFileInfo compilerInfo(resolveCompilerLocation(compiler->getCompilerLocation()));
+    QStringList values = environment.toStringList();
+    values.sort();
+    
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(source.readAll());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(compilerInfo.filePath().toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(QString("%1 %2 %3").arg(compiler->getCompilerType()).arg(compilerInfo.size())
+                 .arg(compilerInfo.lastModified().toString(Qt::ISODate)).toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(compilerArguments.toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(values.join("\n").toUtf8());
+    return QString(hash.result().toHex());
+}
+
+QString CompileThread::resolveCompilerLocation(const QString &location) const
+{
+    QFileInfo info(location);
+    if (info.isAbsolute() || location.contains('/') || location.contains('\\'))
+        return info.exists() ? info.canonicalFilePath() : location;
+    
+    QString path = environment.value("PATH", QProcessEnvironment::systemEnvironment().value("PATH"));
+#ifdef Q_OS_WIN32
+    QStringList dirList = path.split(";", QString::SkipEmptyParts);
+    dirList.prepend(workingDirectory);
+#endif
+#ifdef Q_OS_LINUX
+    QStringList dirList = path.split(QRegExp("[:;]"), QString::SkipEmptyParts);
+#endif
+    for (int i = 0; i < dirList.size(); i ++) {
+        QFileInfo candidate(QDir(dirList[i]), location);
+#ifdef Q_OS_WIN32
+        if (! candidate.isFile()) candidate = QFileInfo(QDir(dirList[i]), location + ".exe");
+#endif
+        if (candidate.isFile()) return candidate.canonicalFilePath();
+    }
+    return location;
+}
+
+bool CompileThread::restoreFromCache(const QString &key)
+{
+    if (key.isEmpty() || settings->getCompileCacheSizeLimit() == 0) return false;
+    QString cacheDirectory = Settings::compileCachePath() + key + QDir::separator();
+    QFile stateFile(cacheDirectory + "state");
+    if (! stateFile.open(QFile::ReadOnly)) return false;
+    QDataStream in(&stateFile);
+    int state;
+    QString message;
+    in >> state >> message;
+    if (in.status() != QDataStream::Ok) return false;
+    
+    QString filesDirectory = cacheDirectory + "files" + QDir::separator();
+    QStringList fileList = QDir(filesDirectory).entryList(QDir::Files);
+    for (int i = 0; i < fileList.size(); i ++) {
+        QFile::remove(workingDirectory + fileList[i]);
+        if (! QFile::copy(filesDirectory + fileList[i], workingDirectory + fileList[i])) return false;
+    }
+    QFile usedFile(cacheDirectory + "used");
+    if (usedFile.open(QFile::WriteOnly | QFile::Truncate)) usedFile.close();
+    compileState = CompileState(state);
+    compileMessage = message;
+    return true;
+}
+
+void CompileThread::saveToCache(const QString &key)
+{
+    if (key.isEmpty() || settings->getCompileCacheSizeLimit() == 0) return;
+    if (compileState != CompileSuccessfully && compileState != CompileError) return;
+    QString cacheDirectory = Settings::compileCachePath() + key;
+    if (QDir(cacheDirectory).exists()) return;
+    
+    QString stagingDirectory = cacheDirectory + "." + QString::number(quintptr(this), 16);
+    QString filesDirectory = stagingDirectory + QDir::separator() + "files" + QDir::separator();
+    QDir().mkpath(filesDirectory);
+    QStringList fileList = QDir(workingDirectory).entryList(QDir::Files);
+    for (int i = 0; i < fileList.size(); i ++)
+        if (fileList[i] != sourceFile)
+            QFile::copy(workingDirectory + fileList[i], filesDirectory + fileList[i]);
+    QFile stateFile(stagingDirectory + QDir::separator() + "state");
+    if (stateFile.open(QFile::WriteOnly)) {
+        QDataStream out(&stateFile);
+        out << int(compileState) << compileMessage;
+        stateFile.close();
+        if (QDir().rename(stagingDirectory, cacheDirectory)) return;
+    }
+    
+    fileList = QDir(filesDirectory).entryList(QDir::Files);
+    for (int i = 0; i < fileList.size(); i ++)
+        QFile::remove(filesDirectory + fileList[i]);
+    QDir().rmdir(filesDirectory);
+    QFile::remove(stagingDirectory + QDir::separator() + "state");
+    QDir().rmdir(stagingDirectory);
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef COMPILETHREAD_H
+#define COMPILETHREAD_H
+
+#include <QtCore>
+#include <QThread>
+#include "globaltype.h"
+
+class Settings;
+class Task;
+class Compiler;
+class CancellationToken;
+class ConcurrencyController;
+
+class CompileThread : public QThread
+{
+    Q_OBJECT
+public:
+    explicit CompileThread(QObject *parent = 0);
+    void setSettings(Settings*);
+    void setTask(Task*);
+    void setContestantName(const QString&);
+    void setWorkingDirectory(const QString&);
+    void setCancellationToken(CancellationToken*);
+    void setConcurrencyController(ConcurrencyController*);
+    const QString& getContestantName() const;
+    const QString& getWorkingDirectory() const;
+    CompileState getCompileState() const;
+    const QString& getCompileMessage() const;
+    const QString& getSourceFile() const;
+    const QString& getExecutableFile() const;
+    const QString& getArguments() const;
+    bool getInterpreterFlag() const;
+    double getTimeLimitRatio() const;
+    double getMemoryLimitRatio() const;
+    bool getDisableMemoryLimitCheck() const;
+    const QProcessEnvironment& getEnvironment() const;
+    void run();
+
+private:
+    Settings *settings;
+    Task *task;
+    QString contestantName;
+    QString workingDirectory;
+    CompileState compileState;
+    QString compileMessage;
+    QString sourceFile;
+    QString executableFile;
+    QString arguments;
+    bool interpreterFlag;
+    double timeLimitRatio;
+    double memoryLimitRatio;
+    bool disableMemoryLimitCheck;
+    QProcessEnvironment environment;
+    CancellationToken *cancellationToken;
+    ConcurrencyController *concurrencyController;
+    void compile();
+    QString resolveCompilerLocation(const QString&) const;
+    QString getCacheKey(Compiler*, const QString&) const;
+    bool restoreFromCache(const QString&);
+    void saveToCache(const QString&);
+};
+
+#endif // COMPILETHREAD_H
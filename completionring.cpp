@@ -0,0 +1,74 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "completionring.h"
+
+CompletionRing::CompletionRing(int minimumCapacity) :
+    enqueuePosition(0)
+{
+    int capacity = 2;
+    while (capacity < minimumCapacity) capacity <<= 1;
+    cells = new Cell[capacity];
+    for (int i = 0; i < capacity; i ++)
+        cells[i].sequence = i;
+    mask = capacity - 1;
+    dequeuePosition = 0;
+}
+
+CompletionRing::~CompletionRing()
+{
+    delete [] cells;
+}
+
+void CompletionRing::push(const CompletionRecord &record)
+{
+    int position = enqueuePosition;
+    Cell *cell;
+    while (true) {
+        cell = &cells[position & mask];
+        int difference = cell->sequence.fetchAndAddAcquire(0) - position;
+        if (difference == 0) {
+            if (enqueuePosition.testAndSetRelaxed(position, position + 1)) break;
+            position = enqueuePosition;
+        } else if (difference < 0) {
+            QThread::yieldCurrentThread();
+            position = enqueuePosition;
+        } else
+            position = enqueuePosition;
+    }
+    cell->record = record;
+    cell->sequence.fetchAndStoreRelease(position + 1);
+    available.release();
+}
+
+bool CompletionRing::pop(CompletionRecord &record)
+{
+    Cell *cell = &cells[dequeuePosition & mask];
+    if (cell->sequence.fetchAndAddAcquire(0) - (dequeuePosition + 1) < 0) return false;
+    record = cell->record;
+    cell->sequence.fetchAndStoreRelease(dequeuePosition + mask + 1);
+    dequeuePosition ++;
+    return true;
+}
+
+void CompletionRing::waitForRecords()
+{
+    available.acquire();
+    int pending = available.available();
+    if (pending > 0) available.tryAcquire(pending);
+}
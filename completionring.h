@@ -0,0 +1,58 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef COMPLETIONRING_H
+#define COMPLETIONRING_H
+
+#include <QtCore>
+
+struct CompletionRecord
+{
+    int slot;
+    int timeUsed;
+    int memoryUsed;
+    int score;
+    int result;
+    int processor;
+    bool needRejudge;
+};
+
+class CompletionRing
+{
+public:
+    explicit CompletionRing(int);
+    ~CompletionRing();
+    void push(const CompletionRecord&);
+    bool pop(CompletionRecord&);
+    void waitForRecords();
+
+private:
+    struct Cell
+    {
+        QAtomicInt sequence;
+        CompletionRecord record;
+    };
+    Cell *cells;
+    int mask;
+    QAtomicInt enqueuePosition;
+    int dequeuePosition;
+    QSemaphore available;
+    Q_DISABLE_COPY(CompletionRing)
+};
+
+#endif // COMPLETIONRING_H
@@ -0,0 +1,146 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include <QtCore>
+#include <QtTest>
+#include "completionring.h"
+
+class RingProducer : public QThread
+{
+public:
+    RingProducer(CompletionRing *_ring, int _producer, int _count)
+    {
+        ring = _ring;
+        producer = _producer;
+        count = _count;
+    }
+    
+    void run()
+    {
+        for (int i = 0; i < count; i ++) {
+            CompletionRecord record;
+            record.slot = producer;
+            record.timeUsed = i;
+            record.memoryUsed = producer * count + i;
+            record.score = 0;
+            record.result = 0;
+            record.processor = producer;
+            record.needRejudge = i % 2 == 1;
+            ring->push(record);
+        }
+    }
+
+private:
+    CompletionRing *ring;
+    int producer;
+    int count;
+};
+
+class CompletionRingTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void singleThread();
+    void multipleProducers_data();
+    void multipleProducers();
+};
+
+void CompletionRingTest::singleThread()
+{
+    CompletionRing ring(3);
+    CompletionRecord record;
+    QVERIFY(! ring.pop(record));
+    for (int round = 0; round < 5; round ++) {
+        for (int i = 0; i < 4; i ++) {
+            record.slot = round * 4 + i;
+            ring.push(record);
+        }
+        for (int i = 0; i < 4; i ++) {
+            QVERIFY(ring.pop(record));
+            QCOMPARE(record.slot, round * 4 + i);
+        }
+        QVERIFY(! ring.pop(record));
+    }
+}
+
+void CompletionRingTest::multipleProducers_data()
+{
+    QTest::addColumn<int>("capacity");
+    QTest::addColumn<int>("producers");
+    QTest::addColumn<int>("count");
+    
+    QTest::newRow("tight ring") << 2 << 8 << 20000;
+    QTest::newRow("small ring") << 16 << 8 << 50000;
+    QTest::newRow("roomy ring") << 4096 << 4 << 100000;
+}
+
+void CompletionRingTest::multipleProducers()
+{
+    QFETCH(int, capacity);
+    QFETCH(int, producers);
+    QFETCH(int, count);
+    
+    CompletionRing ring(capacity);
+    QList<RingProducer*> threads;
+    for (int i = 0; i < producers; i ++)
+        threads.append(new RingProducer(&ring, i, count));
+    for (int i = 0; i < producers; i ++)
+        threads[i]->start();
+    
+    // every record must arrive exactly once, and each producer's records in the order it pushed them
+    QVector<bool> seen(producers * count, false);
+    QVector<int> next(producers, 0);
+    int received = 0, corrupted = 0, duplicates = 0, reordered = 0;
+    CompletionRecord record;
+    while (received < producers * count) {
+        if (! ring.pop(record)) {
+            ring.waitForRecords();
+            continue;
+        }
+        received ++;
+        if (record.slot < 0 || record.slot >= producers || record.timeUsed < 0 || record.timeUsed >= count
+                || record.memoryUsed != record.slot * count + record.timeUsed
+                || record.processor != record.slot || record.needRejudge != (record.timeUsed % 2 == 1)) {
+            corrupted ++;
+            continue;
+        }
+        if (seen[record.memoryUsed]) duplicates ++;
+        seen[record.memoryUsed] = true;
+        if (record.timeUsed != next[record.slot]) reordered ++;
+        next[record.slot] = record.timeUsed + 1;
+    }
+    
+    for (int i = 0; i < producers; i ++) {
+        QVERIFY(threads[i]->wait(30000));
+        delete threads[i];
+    }
+    QVERIFY(! ring.pop(record));
+    QCOMPARE(corrupted, 0);
+    QCOMPARE(duplicates, 0);
+    QCOMPARE(reordered, 0);
+    QCOMPARE(seen.count(false), 0);
+}
+
+int runCompletionRingTest(int argc, char *argv[])
+{
+    CompletionRingTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "completionringtest.moc"
@@ -0,0 +1,166 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "concurrencycontroller.h"
+#include "processorpool.h"
+
+#define ProbeDuration 10000000
+#define SampleInterval 500
+#define WindowSize 8
+
+ConcurrencyController::ConcurrencyController(QObject *parent) :
+    QThread(parent)
+{
+    minimumNumberOfWorkers = 1;
+    maximumNumberOfWorkers = 1;
+    numberOfWorkers = 1;
+    noiseTarget = 0.05;
+    housekeepingProcessor = -1;
+    housekeepingJobs = 0;
+    housekeepingEpoch = 0;
+    stopped = false;
+    probeIterations = 1 << 16;
+    baseline = 0;
+}
+
+void ConcurrencyController::setRange(int minimum, int maximum)
+{
+    maximumNumberOfWorkers = qMax(1, maximum);
+    minimumNumberOfWorkers = qBound(1, minimum, maximumNumberOfWorkers);
+    numberOfWorkers = maximumNumberOfWorkers;
+}
+
+void ConcurrencyController::setNoiseTarget(double target)
+{
+    noiseTarget = target;
+}
+
+void ConcurrencyController::setHousekeepingProcessor(int processor)
+{
+    housekeepingProcessor = processor;
+}
+
+void ConcurrencyController::beginHousekeeping()
+{
+    housekeepingJobs.ref();
+    housekeepingEpoch.ref();
+}
+
+void ConcurrencyController::endHousekeeping()
+{
+    housekeepingJobs.deref();
+}
+
+void ConcurrencyController::calibrate()
+{
+    while (probeIterations < (1 << 30) && probe() < ProbeDuration)
+        probeIterations <<= 1;
+    QList<double> list;
+    for (int i = 0; i < 5; i ++)
+        list.append(probe());
+    qSort(list);
+    baseline = list[2];
+    samples.clear();
+}
+
+int ConcurrencyController::getNumberOfWorkers() const
+{
+    return numberOfWorkers;
+}
+
+void ConcurrencyController::stop()
+{
+    mutex.lock();
+    stopped = true;
+    stopCondition.wakeAll();
+    mutex.unlock();
+    wait();
+}
+
+void ConcurrencyController::run()
+{
+    ProcessorPool::bindCurrentThread(housekeepingProcessor);
+    calibrate();
+    mutex.lock();
+    while (! stopped) {
+        stopCondition.wait(&mutex, SampleInterval);
+        if (stopped) break;
+        mutex.unlock();
+        sample();
+        mutex.lock();
+    }
+    mutex.unlock();
+}
+
+double ConcurrencyController::probe() const
+{
+    volatile unsigned int value = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < probeIterations; i ++)
+        value = value * 1103515245u + 12345u;
+    return double(timer.nsecsElapsed());
+}
+
+double ConcurrencyController::getHostLoad() const
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/loadavg");
+    if (file.open(QFile::ReadOnly)) {
+        bool ok;
+        double load = QString(file.readAll()).section(' ', 0, 0).toDouble(&ok);
+        if (ok) return load / qMax(1, QThread::idealThreadCount());
+    }
+#endif
+    return 0;
+}
+
+void ConcurrencyController::sample()
+{
+    if (baseline <= 0) return;
+    // compiles share the housekeeping processor, so probes that overlap one say nothing about judging
+    int epoch = housekeepingEpoch;
+    if (housekeepingJobs > 0) return;
+    double value = probe();
+    if (housekeepingJobs > 0 || housekeepingEpoch != epoch) return;
+    samples.append(value);
+    if (samples.size() < WindowSize) return;
+    
+    double mean = 0, deviation = 0;
+    for (int i = 0; i < samples.size(); i ++)
+        mean += samples[i];
+    mean /= samples.size();
+    for (int i = 0; i < samples.size(); i ++)
+        deviation += (samples[i] - mean) * (samples[i] - mean);
+    deviation = qSqrt(deviation / samples.size());
+    double noise = qMax(deviation / mean, (mean - baseline) / baseline);
+    double load = getHostLoad();
+    samples.clear();
+    
+    QString reason = tr("noise %1%, load %2").arg(noise * 100, 0, 'f', 1).arg(load, 0, 'f', 2);
+    int workers = numberOfWorkers;
+    if ((noise > noiseTarget || load > 1) && workers > minimumNumberOfWorkers) {
+        workers --;
+        numberOfWorkers = workers;
+        emit numberOfWorkersChanged(workers, reason);
+    } else if (noise < noiseTarget / 2 && load < 0.8 && workers < maximumNumberOfWorkers) {
+        workers ++;
+        numberOfWorkers = workers;
+        emit numberOfWorkersChanged(workers, reason);
+    }
+}
@@ -0,0 +1,62 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef CONCURRENCYCONTROLLER_H
+#define CONCURRENCYCONTROLLER_H
+
+#include <QtCore>
+#include <QThread>
+
+class ConcurrencyController : public QThread
+{
+    Q_OBJECT
+public:
+    explicit ConcurrencyController(QObject *parent = 0);
+    void setRange(int, int);
+    void setNoiseTarget(double);
+    void setHousekeepingProcessor(int);
+    void beginHousekeeping();
+    void endHousekeeping();
+    void calibrate();
+    int getNumberOfWorkers() const;
+    void sample();
+    void stop();
+    void run();
+
+private:
+    int minimumNumberOfWorkers;
+    int maximumNumberOfWorkers;
+    QAtomicInt numberOfWorkers;
+    double noiseTarget;
+    int housekeepingProcessor;
+    QAtomicInt housekeepingJobs;
+    QAtomicInt housekeepingEpoch;
+    bool stopped;
+    QMutex mutex;
+    QWaitCondition stopCondition;
+    int probeIterations;
+    double baseline;
+    QList<double> samples;
+    double probe() const;
+    double getHostLoad() const;
+
+signals:
+    void numberOfWorkersChanged(int, const QString&);
+};
+
+#endif // CONCURRENCYCONTROLLER_H
@@ -16,19 +16,48 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ***************************************************************************/
 
-#include <QMessageBox>
 #include "contest.h"
 #include "task.h"
 #include "testcase.h"
 #include "settings.h"
 #include "compiler.h"
 #include "contestant.h"
-#include "judgingthread.h"
+#include "messagepool.h"
+#include "contestfile.h"
+#include "contestsaver.h"
+#include "resultjournal.h"
+#include "resultdatabase.h"
 #include "assignmentthread.h"
+#include "judgingcontroller.h"
 
 Contest::Contest(QObject *parent) :
     QObject(parent)
 {
+    controller = 0;
+    savedFileSize = 0;
+    savedTaskOffset = 0;
+    savedDirectoryOffset = 0;
+    garbageBytes = 0;
+    journal = 0;
+    saver = 0;
+    database = 0;
+    savingDatabaseChanges = -1;
+    journalEnabled = true;
+    recoveredCount = 0;
+}
+
+Contest::~Contest()
+{
+    if (controller) {
+        controller->cancel();
+        controller->wait();
+        delete controller;
+    }
+    if (saver) saver->wait();
+    delete database;
+    qDeleteAll(contestantList);
+    contestantList.clear();
+    MessagePool::squeeze();
 }
 
 void Contest::setSettings(Settings *_settings)
@@ -98,6 +127,7 @@ void Contest::deleteTask(int index)
     if (0 <= index && index < taskList.size()) {
         delete taskList[index];
         taskList.removeAt(index);
+        if (database) database->removeTask(index);
     }
     emit taskDeletedForContestant(index);
     emit taskDeletedForViewer(index);
@@ -108,182 +138,67 @@ void Contest::refreshContestantList()
     QStringList nameList = QDir(Settings::sourcePath()).entryList(QStringList(), QDir::Dirs | QDir::NoDotAndDotDot);
     QStringList curNameList = contestantList.keys();
     for (int i = 0; i < curNameList.size(); i ++)
-        if (! nameList.contains(curNameList[i])) {
-            delete contestantList[curNameList[i]];
-            contestantList.remove(curNameList[i]);
-        }
+        if (! nameList.contains(curNameList[i]))
+            deleteContestant(curNameList[i]);
     for (int i = 0; i < nameList.size(); i ++)
         if (! contestantList.contains(nameList[i])) {
             Contestant *newContestant = new Contestant(this);
             newContestant->setContestantName(nameList[i]);
             for (int j = 0; j < taskList.size(); j ++)
                 newContestant->addTask();
-            contestantList.insert(nameList[i], newContestant);
-            connect(this, SIGNAL(taskAddedForContestant()),
-                    newContestant, SLOT(addTask()));
-            connect(this, SIGNAL(taskDeletedForContestant(int)),
-                    newContestant, SLOT(deleteTask(int)));
+            addContestant(newContestant);
         }
 }
 
+void Contest::addContestant(Contestant *contestant)
+{
+    connect(this, SIGNAL(taskAddedForContestant()),
+            contestant, SLOT(addTask()));
+    connect(this, SIGNAL(taskDeletedForContestant(int)),
+            contestant, SLOT(deleteTask(int)));
+    connect(contestant, SIGNAL(detailsLoadFailed(QString)),
+            this, SIGNAL(detailsLoadFailed(QString)));
+    contestantList.insert(contestant->getContestantName(), contestant);
+}
+
 void Contest::deleteContestant(const QString &name)
 {
     if (! contestantList.contains(name)) return;
+    if (contestantList[name]->getDetailsOffset() >= 0)
+        releasedOffsets.append(contestantList[name]->getDetailsOffset());
     delete contestantList[name];
     contestantList.remove(name);
+    if (database) database->removeContestant(name);
 }
 
-void Contest::clearPath(const QString &curDir)
+void Contest::applyTaskResult(const QString &contestantName, int index, QObject *_thread,
+                              QObject *_rejudgeThread, bool lastTaskOfContestant)
 {
-    QDir dir(curDir);
-    QStringList fileList = dir.entryList(QDir::Files);
-    for (int i = 0; i < fileList.size(); i ++)
-        if (! dir.remove(fileList[i])) {
-#ifdef Q_OS_WIN32
-            QProcess::execute(QString("attrib -R \"") + curDir + fileList[i] + "\"");
-#endif
-#ifdef Q_OS_LINUX
-            QProcess::execute(QString("chmod +w \"") + curDir + fileList[i] + "\"");
-#endif
-            dir.remove(fileList[i]);
-        }
-    QStringList dirList = dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
-    for (int i = 0; i < dirList.size(); i ++) {
-        clearPath(curDir + dirList[i] + QDir::separator());
-        dir.rmdir(dirList[i]);
+    Contestant *contestant = contestantList.value(contestantName);
+    AssignmentThread *thread = qobject_cast<AssignmentThread*>(_thread);
+    AssignmentThread *rejudgeThread = qobject_cast<AssignmentThread*>(_rejudgeThread);
+    if (! contestant || ! thread) {
+        delete _thread;
+        delete _rejudgeThread;
+        return;
     }
-}
-
-void Contest::judge(Contestant *contestant)
-{
-    emit contestantJudgingStart(contestant->getContestantName());
-    QDir(QDir::current()).mkdir(Settings::temporaryPath());
-    for (int i = 0; i < taskList.size(); i ++) {
-        emit taskJudgingStarted(taskList[i]->getProblemTile());
-        
-        AssignmentThread *thread = new AssignmentThread();
-        connect(thread, SIGNAL(singleCaseFinished(int, int, int, int)),
-                this, SIGNAL(singleCaseFinished(int, int, int, int)));
-        connect(thread, SIGNAL(compileError(int, int)),
-                this, SIGNAL(compileError(int, int)));
-        connect(this, SIGNAL(stopJudgingSignal()),
-                thread, SLOT(stopJudgingSlot()));
-        thread->setSettings(settings);
-        thread->setTask(taskList[i]);
-        thread->setContestantName(contestant->getContestantName());
-        QEventLoop *eventLoop = new QEventLoop(this);
-        connect(thread, SIGNAL(finished()), eventLoop, SLOT(quit()));
-        thread->start();
-        eventLoop->exec();
-        delete eventLoop;
-        
-        if (stopJudging) {
-            delete thread;
-            clearPath(Settings::temporaryPath());
-            QDir().rmdir(Settings::temporaryPath());
-            return;
+    
+    if (thread->getRecheckMode()) {
+        QList<QStringList> message = contestant->getMessage(index);
+        const QList< QPair<int, int> > &recheckList = thread->getRecheckList();
+        for (int i = 0; i < recheckList.size(); i ++) {
+            int a = recheckList[i].first, b = recheckList[i].second;
+            contestant->setCaseResult(index, a, b, thread->getResult()[a][b], thread->getScore()[a][b]);
+            message[a][b] = thread->getMessage()[a][b];
         }
-        
-        contestant->setCompileState(i, thread->getCompileState());
-        contestant->setCompileMessage(i, thread->getCompileMessage());
-        contestant->setSourceFile(i, thread->getSourceFile());
-        contestant->setInputFiles(i, thread->getInputFiles());
-        contestant->setResult(i, thread->getResult());
-        contestant->setMessage(i, thread->getMessage());
-        contestant->setScore(i, thread->getScore());
-        contestant->setTimeUsed(i, thread->getTimeUsed());
-        contestant->setMemoryUsed(i, thread->getMemoryUsed());
-        QList< QPair<int, int> > needRejudge = thread->getNeedRejudge();
-        
+        contestant->setMessage(index, message);
+        contestant->setFingerprint(index, judgingFingerprints.value(qMakePair(contestantName, index)));
+        if (lastTaskOfContestant) contestant->setJudgingTime(QDateTime::currentDateTime());
+        journalTaskResult(contestantName, index);
+        if (database) database->addTaskResult(contestant, index);
         delete thread;
-        clearPath(Settings::temporaryPath());
-        
-        if (needRejudge.size() > 0) {
-            AssignmentThread *thread = new AssignmentThread();
-            connect(thread, SIGNAL(singleCaseFinished(int, int, int, int)),
-                    this, SIGNAL(singleCaseFinished(int, int, int, int)));
-            connect(thread, SIGNAL(compileError(int, int)),
-                    this, SIGNAL(compileError(int, int)));
-            connect(this, SIGNAL(stopJudgingSignal()),
-                    thread, SLOT(stopJudgingSlot()));
-            thread->setCheckRejudgeMode(true);
-            thread->setNeedRejudge(needRejudge);
-            thread->setSettings(settings);
-            thread->setTask(taskList[i]);
-            thread->setContestantName(contestant->getContestantName());
-            QEventLoop *eventLoop = new QEventLoop(this);
-            connect(thread, SIGNAL(finished()), eventLoop, SLOT(quit()));
-            thread->start();
-            eventLoop->exec();
-            delete eventLoop;
-            
-            if (stopJudging) {
-                delete thread;
-                clearPath(Settings::temporaryPath());
-                QDir().rmdir(Settings::temporaryPath());
-                return;
-            }
-            
-            QList< QList<ResultState> > result = contestant->getResult(i);
-            QList<QStringList> message = contestant->getMessage(i);
-            QList< QList<int> > score = contestant->getSocre(i);
-            QList< QList<int> > timeUsed = contestant->getTimeUsed(i);
-            QList< QList<int> > memoryUsed = contestant->getMemoryUsed(i);
-            
-            for (int j = 0; j < needRejudge.size(); j ++) {
-                int a = needRejudge[j].first, b = needRejudge[j].second;
-                result[a][b] = thread->getResult()[a][b];
-                message[a][b] = thread->getMessage()[a][b];
-                score[a][b] = thread->getScore()[a][b];
-                timeUsed[a][b] = thread->getTimeUsed()[a][b];
-                memoryUsed[a][b] = thread->getMemoryUsed()[a][b];
-            }
-            
-            contestant->setResult(i, result);
-            contestant->setMessage(i, message);
-            contestant->setScore(i, score);
-            contestant->setTimeUsed(i, timeUsed);
-            contestant->setMemoryUsed(i, memoryUsed);
-            
-            delete thread;
-            clearPath(Settings::temporaryPath());
-        }
-        
-        contestant->setCheckJudged(i, true);
+        delete rejudgeThread;
         emit taskJudgingFinished();
-    }
-    contestant->setJudgingTime(QDateTime::currentDateTime());
-    QDir().rmdir(Settings::temporaryPath());
-    emit contestantJudgingFinished();
-}
-
-void Contest::judge(Contestant *contestant, int index)
-{
-    emit contestantJudgingStart(contestant->getContestantName());
-    QDir(QDir::current()).mkdir(Settings::temporaryPath());
-    
-    emit taskJudgingStarted(taskList[index]->getProblemTile());
-    
-    AssignmentThread *thread = new AssignmentThread();
-    connect(thread, SIGNAL(singleCaseFinished(int, int, int, int)),
-            this, SIGNAL(singleCaseFinished(int, int, int, int)));
-    connect(thread, SIGNAL(compileError(int, int)),
-            this, SIGNAL(compileError(int, int)));
-    connect(this, SIGNAL(stopJudgingSignal()),
-            thread, SLOT(stopJudgingSlot()));
-    thread->setSettings(settings);
-    thread->setTask(taskList[index]);
-    thread->setContestantName(contestant->getContestantName());
-    QEventLoop *eventLoop = new QEventLoop(this);
-    connect(thread, SIGNAL(finished()), eventLoop, SLOT(quit()));
-    thread->start();
-    eventLoop->exec();
-    delete eventLoop;
-    
-    if (stopJudging) {
-        delete thread;
-        clearPath(Settings::temporaryPath());
-        QDir().rmdir(Settings::temporaryPath());
         return;
     }
     
@@ -291,119 +206,479 @@ void Contest::judge(Contestant *contestant, int index)
     contestant->setCompileMessage(index, thread->getCompileMessage());
     contestant->setSourceFile(index, thread->getSourceFile());
     contestant->setInputFiles(index, thread->getInputFiles());
+    
+    QList<QStringList> message = thread->getMessage();
     contestant->setResult(index, thread->getResult());
-    contestant->setMessage(index, thread->getMessage());
     contestant->setScore(index, thread->getScore());
     contestant->setTimeUsed(index, thread->getTimeUsed());
     contestant->setMemoryUsed(index, thread->getMemoryUsed());
-    QList< QPair<int, int> > needRejudge = thread->getNeedRejudge();
+    contestant->setProcessorUsed(index, thread->getProcessorUsed());
     
-    delete thread;
-    clearPath(Settings::temporaryPath());
-    
-    if (needRejudge.size() > 0) {
-        AssignmentThread *thread = new AssignmentThread();
-        connect(thread, SIGNAL(singleCaseFinished(int, int, int, int)),
-                this, SIGNAL(singleCaseFinished(int, int, int, int)));
-        connect(thread, SIGNAL(compileError(int, int)),
-                this, SIGNAL(compileError(int, int)));
-        connect(this, SIGNAL(stopJudgingSignal()),
-                thread, SLOT(stopJudgingSlot()));
-        thread->setCheckRejudgeMode(true);
-        thread->setNeedRejudge(needRejudge);
-        thread->setSettings(settings);
-        thread->setTask(taskList[index]);
-        thread->setContestantName(contestant->getContestantName());
-        QEventLoop *eventLoop = new QEventLoop(this);
-        connect(thread, SIGNAL(finished()), eventLoop, SLOT(quit()));
-        thread->start();
-        eventLoop->exec();
-        delete eventLoop;
-        
-        if (stopJudging) {
-            delete thread;
-            clearPath(Settings::temporaryPath());
-            QDir().rmdir(Settings::temporaryPath());
-            return;
-        }
-        
-        QList< QList<ResultState> > result = contestant->getResult(index);
-        QList<QStringList> message = contestant->getMessage(index);
-        QList< QList<int> > score = contestant->getSocre(index);
-        QList< QList<int> > timeUsed = contestant->getTimeUsed(index);
-        QList< QList<int> > memoryUsed = contestant->getMemoryUsed(index);
-        
+    if (rejudgeThread) {
+        const QList< QPair<int, int> > &needRejudge = thread->getNeedRejudge();
         for (int i = 0; i < needRejudge.size(); i ++) {
             int a = needRejudge[i].first, b = needRejudge[i].second;
-            result[a][b] = thread->getResult()[a][b];
-            message[a][b] = thread->getMessage()[a][b];
-            score[a][b] = thread->getScore()[a][b];
-            timeUsed[a][b] = thread->getTimeUsed()[a][b];
-            memoryUsed[a][b] = thread->getMemoryUsed()[a][b];
+            contestant->setCaseResult(index, a, b, rejudgeThread->getResult()[a][b],
+                                      rejudgeThread->getScore()[a][b]);
+            contestant->setCaseUsage(index, a, b, rejudgeThread->getTimeUsed()[a][b],
+                                     rejudgeThread->getMemoryUsed()[a][b], rejudgeThread->getProcessorUsed()[a][b]);
+            message[a][b] = rejudgeThread->getMessage()[a][b];
         }
-        
-        contestant->setResult(index, result);
-        contestant->setMessage(index, message);
-        contestant->setScore(index, score);
-        contestant->setTimeUsed(index, timeUsed);
-        contestant->setMemoryUsed(index, memoryUsed);
-        
-        delete thread;
-        clearPath(Settings::temporaryPath());
     }
     
+    contestant->setMessage(index, message);
     contestant->setCheckJudged(index, true);
+    contestant->setOutputHash(index, thread->getOutputHash());
+    contestant->setFingerprint(index, judgingFingerprints.value(qMakePair(contestantName, index)));
+    if (lastTaskOfContestant) contestant->setJudgingTime(QDateTime::currentDateTime());
+    journalTaskResult(contestantName, index);
+    if (database) database->addTaskResult(contestant, index);
+    delete thread;
+    delete rejudgeThread;
     emit taskJudgingFinished();
-    
-    contestant->setJudgingTime(QDateTime::currentDateTime());
-    QDir().rmdir(Settings::temporaryPath());
-    emit contestantJudgingFinished();
+}
+
+void Contest::progressSnapshot(const QList< QList<int> > &progressList)
+{
+    for (int i = 0; i < progressList.size(); i ++) {
+        const QList<int> &item = progressList[i];
+        emit singleCaseFinished(item[0], item[1], item[2], item[3], item[4]);
+    }
 }
 
 void Contest::judge(const QString &name)
 {
-    clearPath(Settings::temporaryPath());
-    stopJudging = false;
-    judge(contestantList.value(name));
+    judge(QStringList() << name);
 }
 
 void Contest::judge(const QString &name, int index)
 {
-    clearPath(Settings::temporaryPath());
-    stopJudging = false;
-    judge(contestantList.value(name), index);
+    judge(QStringList() << name, QList<int>() << index);
+}
+
+void Contest::judge(const QStringList &nameList)
+{
+    QList<int> indexList;
+    for (int i = 0; i < taskList.size(); i ++)
+        indexList.append(i);
+    judge(nameList, indexList);
+}
+
+void Contest::judge(const QStringList &nameList, const QList<int> &indexList)
+{
+    QList< QPair<QString, int> > jobList;
+    for (int i = 0; i < nameList.size(); i ++)
+        for (int j = 0; j < indexList.size(); j ++)
+            jobList.append(qMakePair(nameList[i], indexList[j]));
+    judge(jobList);
+}
+
+void Contest::judge(const QList< QPair<QString, int> > &jobList)
+{
+    runJudging(jobList, QMap< QPair<QString, int>, QList<QStringList> >());
+}
+
+void Contest::recheck(const QList< QPair<QString, int> > &jobList)
+{
+    QMap< QPair<QString, int>, QList<QStringList> > recheckOutputs;
+    for (int i = 0; i < jobList.size(); i ++) {
+        Contestant *contestant = contestantList.value(jobList[i].first);
+        int index = jobList[i].second;
+        if (! contestant || index >= taskList.size()) continue;
+        if (taskList[index]->getTaskType() != Task::Traditional) continue;
+        QList<QStringList> outputs;
+        if (getRecheckOutputs(contestant, index, outputs))
+            recheckOutputs.insert(jobList[i], outputs);
+    }
+    runJudging(jobList, recheckOutputs);
+}
+
+void Contest::runJudging(const QList< QPair<QString, int> > &jobList,
+                         const QMap< QPair<QString, int>, QList<QStringList> > &recheckOutputs)
+{
+    if (controller) return;
+    controller = new JudgingController();
+    controller->setSettings(settings);
+    controller->setTaskList(taskList);
+    QMap<int, QString> taskFingerprints;
+    for (int i = 0; i < jobList.size(); i ++)
+        if (contestantList.contains(jobList[i].first) && jobList[i].second < taskList.size()) {
+            int index = jobList[i].second;
+            if (! taskFingerprints.contains(index))
+                taskFingerprints.insert(index, getTaskFingerprint(index));
+            judgingFingerprints.insert(jobList[i], getSourceFingerprint(jobList[i].first, index)
+                                       + ":" + taskFingerprints.value(index));
+            if (recheckOutputs.contains(jobList[i]))
+                controller->addRecheckJob(jobList[i].first, index, recheckOutputs.value(jobList[i]));
+            else
+                controller->addJob(jobList[i].first, index);
+            remainingJobs.append(jobList[i]);
+        }
+    resumeJobs.clear();
+    journalRunStarted(remainingJobs);
+    if (database) database->setTaskList(taskList);
+    
+    connect(controller, SIGNAL(progressSnapshot(QList<QList<int> >)),
+            this, SLOT(progressSnapshot(QList<QList<int> >)));
+    connect(controller, SIGNAL(taskJudgingStarted(QString)),
+            this, SIGNAL(taskJudgingStarted(QString)));
+    connect(controller, SIGNAL(taskJudged(QString, int, QObject*, QObject*, bool)),
+            this, SLOT(applyTaskResult(QString, int, QObject*, QObject*, bool)));
+    connect(controller, SIGNAL(contestantJudgingStart(QString)),
+            this, SIGNAL(contestantJudgingStart(QString)));
+    connect(controller, SIGNAL(contestantJudgingFinished()),
+            this, SIGNAL(contestantJudgingFinished()));
+    connect(controller, SIGNAL(compileError(int, int)),
+            this, SIGNAL(compileError(int, int)));
+    connect(controller, SIGNAL(compileFailed(QString, QString, int)),
+            this, SIGNAL(compileFailed(QString, QString, int)));
+    connect(controller, SIGNAL(numberOfWorkersChanged(int, QString)),
+            this, SIGNAL(numberOfWorkersChanged(int, QString)));
+    connect(controller, SIGNAL(finished()), this, SLOT(judgingControllerFinished()));
+    controller->start();
+}
+
+void Contest::judgingControllerFinished()
+{
+    controller->wait();
+    delete controller;
+    controller = 0;
+    judgingFingerprints.clear();
+    remainingJobs.clear();
+    if (journal) journal->appendRecord(ResultJournal::RunFinishedRecord, QByteArray());
+    if (database) database->flush();
+    MessagePool::squeeze();
+    emit judgingFinished();
+}
+
+void Contest::resumeJudging()
+{
+    judge(QList< QPair<QString, int> >(resumeJobs));
+}
+
+void Contest::setJournalEnabled(bool enabled)
+{
+    journalEnabled = enabled;
+}
+
+int Contest::getRecoveredCount() const
+{
+    return recoveredCount;
+}
+
+const QList< QPair<QString, int> >& Contest::getResumeJobs() const
+{
+    return resumeJobs;
+}
+
+QByteArray Contest::getTaskDigest(int index)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    taskList[index]->writeToStream(out);
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+void Contest::journalRunStarted(const QList< QPair<QString, int> > &jobList)
+{
+    if (! journalEnabled || journalFileName.isEmpty()) return;
+    if (! journal) journal = new ResultJournal(this);
+    if (! journal->isOpen() && ! journal->open(journalFileName, false)) return;
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << jobList;
+    journal->appendRecord(ResultJournal::RunStartedRecord, payload);
+}
+
+void Contest::journalTaskResult(const QString &contestantName, int index)
+{
+    remainingJobs.removeAll(qMakePair(contestantName, index));
+    if (! journal || ! journal->isOpen()) return;
+    unsavedResults.append(qMakePair(contestantName, index));
+    appendTaskResultRecord(contestantName, index);
+}
+
+void Contest::appendTaskResultRecord(const QString &contestantName, int index)
+{
+    if (! contestantList.contains(contestantName) || index >= taskList.size()) return;
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << contestantName << index << getTaskDigest(index);
+    contestantList.value(contestantName)->writeTaskToStream(index, out);
+    journal->appendRecord(ResultJournal::TaskResultRecord, payload);
+}
+
+void Contest::replayJournal()
+{
+    QList< QPair<int, QByteArray> > records = ResultJournal::readRecords(journalFileName);
+    recoveredCount = 0;
+    resumeJobs.clear();
+    QList<QByteArray> taskDigests;
+    for (int i = 0; i < taskList.size(); i ++)
+        taskDigests.append(getTaskDigest(i));
+    
+    for (int i = 0; i < records.size(); i ++) {
+        QDataStream in(records[i].second);
+        if (records[i].first == ResultJournal::RunStartedRecord)
+            in >> resumeJobs;
+        if (records[i].first == ResultJournal::RunFinishedRecord)
+            resumeJobs.clear();
+        if (records[i].first == ResultJournal::TaskResultRecord) {
+            QString contestantName;
+            int index;
+            QByteArray digest;
+            in >> contestantName >> index >> digest;
+            resumeJobs.removeAll(qMakePair(contestantName, index));
+            Contestant *contestant = contestantList.value(contestantName);
+            if (! contestant || index < 0 || index >= taskList.size() || digest != taskDigests[index]) continue;
+            contestant->readTaskFromStream(index, in);
+            if (database) database->addTaskResult(contestant, index);
+            recoveredCount ++;
+        }
+    }
+    for (int i = resumeJobs.size() - 1; i >= 0; i --)
+        if (! contestantList.contains(resumeJobs[i].first) || resumeJobs[i].second >= taskList.size())
+            resumeJobs.removeAt(i);
+}
+
+void Contest::restartJournal()
+{
+    QList< QPair<QString, int> > pendingJobs = controller ? remainingJobs : resumeJobs;
+    if (! journalEnabled || (! controller && pendingJobs.isEmpty() && unsavedResults.isEmpty())) {
+        delete journal;
+        journal = 0;
+        unsavedResults.clear();
+        if (journalEnabled) QFile::remove(journalFileName);
+        return;
+    }
+    if (! journal) journal = new ResultJournal(this);
+    if (! journal->open(journalFileName, true)) return;
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << pendingJobs;
+    journal->appendRecord(ResultJournal::RunStartedRecord, payload);
+    for (int i = 0; i < unsavedResults.size(); i ++)
+        appendTaskResultRecord(unsavedResults[i].first, unsavedResults[i].second);
 }
 
 void Contest::judgeAll()
 {
-    clearPath(Settings::temporaryPath());
-    stopJudging = false;
-    QList<Contestant*> contestants = contestantList.values();
-    for (int i = 0; i < contestants.size(); i ++) {
-        judge(contestants[i]);
-        if (stopJudging) break;
+    judge(QStringList(contestantList.keys()));
+}
+
+void Contest::judgeStale()
+{
+    judge(getStaleJobs());
+}
+
+QString Contest::getSourceFingerprint(const QString &contestantName, int index) const
+{
+    Task *task = taskList[index];
+    QStringList filters;
+    if (task->getTaskType() == Task::Traditional)
+        filters.append(task->getSourceFileName() + ".*");
+    else
+        for (int i = 0; i < task->getTestCaseList().size(); i ++) {
+            QStringList inputFiles = task->getTestCase(i)->getInputFiles();
+            for (int j = 0; j < inputFiles.size(); j ++)
+                filters.append(QFileInfo(inputFiles[j]).completeBaseName() + "." + task->getAnswerFileExtension());
+        }
+    
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QDir contestantDir(Settings::sourcePath() + contestantName);
+    QStringList fileList = contestantDir.entryList(filters, QDir::Files, QDir::Name);
+    for (int i = 0; i < fileList.size(); i ++) {
+        QFile file(contestantDir.filePath(fileList[i]));
+        if (! file.open(QFile::ReadOnly)) continue;
+        hash.addData(fileList[i].toUtf8());
+        hash.addData(QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1));
+    }
+    return hash.result().toHex();
+}
+
+QString Contest::getRunFingerprint(int index)
+{
+    Task *task = taskList[index];
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << int(task->getTaskType()) << task->getSourceFileName() << task->getAnswerFileExtension();
+    out << task->getInputFileName() << task->getOutputFileName();
+    out << task->getStandardInputCheck() << task->getStandardOutputCheck();
+    
+    const QList<Compiler*> &compilerList = settings->getCompilerList();
+    for (int i = 0; i < compilerList.size(); i ++) {
+        out << int(compilerList[i]->getCompilerType()) << compilerList[i]->getCompilerName();
+        out << compilerList[i]->getSourceExtensions() << compilerList[i]->getCompilerLocation();
+        out << compilerList[i]->getInterpreterLocation() << compilerList[i]->getConfigurationNames();
+        out << compilerList[i]->getCompilerArguments() << compilerList[i]->getInterpreterArguments();
+        QStringList environment = compilerList[i]->getEnvironment().toStringList();
+        environment.sort();
+        out << environment << compilerList[i]->getTimeLimitRatio() << compilerList[i]->getMemoryLimitRatio();
+        out << compilerList[i]->getDisableMemoryLimitCheck();
+        out << task->getCompilerConfiguration(compilerList[i]->getCompilerName());
+    }
+    out << settings->getFileSizeLimit();
+    
+    for (int i = 0; i < task->getTestCaseList().size(); i ++) {
+        TestCase *testCase = task->getTestCase(i);
+        out << testCase->getTimeLimit() << testCase->getMemoryLimit();
+        QStringList inputFiles = testCase->getInputFiles();
+        for (int j = 0; j < inputFiles.size(); j ++) {
+            QFileInfo info(Settings::dataPath() + inputFiles[j]);
+            out << inputFiles[j] << info.size() << info.lastModified();
+        }
+    }
+    
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
+QString Contest::getCheckFingerprint(int index)
+{
+    Task *task = taskList[index];
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << int(task->getComparisonMode()) << task->getDiffArguments() << task->getRealPrecision();
+    out << settings->getSpecialJudgeTimeLimit();
+    
+    QStringList fileList;
+    for (int i = 0; i < task->getTestCaseList().size(); i ++) {
+        out << task->getTestCase(i)->getFullScore();
+        fileList.append(task->getTestCase(i)->getOutputFiles());
     }
+    if (task->getComparisonMode() == Task::SpecialJudgeMode)
+        fileList.append(task->getSpecialJudge());
+    for (int i = 0; i < fileList.size(); i ++) {
+        QFileInfo info(Settings::dataPath() + fileList[i]);
+        out << fileList[i] << info.size() << info.lastModified();
+    }
+    
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
+QString Contest::getTaskFingerprint(int index)
+{
+    return getRunFingerprint(index) + ":" + getCheckFingerprint(index);
+}
+
+QString Contest::getFingerprint(const QString &contestantName, int index)
+{
+    return getSourceFingerprint(contestantName, index) + ":" + getTaskFingerprint(index);
+}
+
+QList< QPair<QString, int> > Contest::getStaleJobs()
+{
+    QList< QPair<QString, int> > jobList;
+    QStringList taskFingerprints;
+    for (int i = 0; i < taskList.size(); i ++)
+        taskFingerprints.append(getTaskFingerprint(i));
+    QList<Contestant*> list = contestantList.values();
+    for (int i = 0; i < list.size(); i ++)
+        for (int j = 0; j < taskList.size(); j ++) {
+            QString name = list[i]->getContestantName();
+            if (! list[i]->getCheckJudged(j)
+                    || list[i]->getFingerprint(j) != getSourceFingerprint(name, j) + ":" + taskFingerprints[j])
+                jobList.append(qMakePair(name, j));
+        }
+    return jobList;
+}
+
+bool Contest::getRecheckOutputs(Contestant *contestant, int index, QList<QStringList> &outputs) const
+{
+    const QList< QList<ResultState> > &result = contestant->getResult(index);
+    QList<QStringList> outputHash = contestant->getOutputHash(index);
+    outputs.clear();
+    for (int i = 0; i < result.size(); i ++) {
+        outputs.append(QStringList());
+        for (int j = 0; j < result[i].size(); j ++) {
+            QString hash;
+            if (i < outputHash.size() && j < outputHash[i].size()) hash = outputHash[i][j];
+            if (! hash.isEmpty() && result[i][j] != TimeLimitExceeded
+                    && ! QFileInfo(Settings::outputArchivePath() + hash).exists()) return false;
+            switch (result[i][j]) {
+                case TimeLimitExceeded:
+                case MemoryLimitExceeded:
+                case CannotStartProgram:
+                case RunTimeError:
+                    outputs[i].append("");
+                    break;
+                case FileError:
+                    outputs[i].append(hash);
+                    break;
+                default:
+                    if (hash.isEmpty()) return false;
+                    outputs[i].append(hash);
+            }
+        }
+    }
+    return true;
+}
+
+QList< QPair<QString, int> > Contest::getRecheckJobs()
+{
+    QList< QPair<QString, int> > jobList;
+    QStringList runFingerprints, taskFingerprints;
+    for (int i = 0; i < taskList.size(); i ++) {
+        runFingerprints.append(getRunFingerprint(i));
+        taskFingerprints.append(runFingerprints[i] + ":" + getCheckFingerprint(i));
+    }
+    QList<Contestant*> list = contestantList.values();
+    for (int i = 0; i < list.size(); i ++)
+        for (int j = 0; j < taskList.size(); j ++) {
+            if (! list[i]->getCheckJudged(j)) continue;
+            QString name = list[i]->getContestantName();
+            QString sourceFingerprint = getSourceFingerprint(name, j);
+            QString fingerprint = list[i]->getFingerprint(j);
+            if (fingerprint == sourceFingerprint + ":" + taskFingerprints[j]) continue;
+            if (! fingerprint.startsWith(sourceFingerprint + ":" + runFingerprints[j] + ":")) continue;
+            QList<QStringList> outputs;
+            if (taskList[j]->getTaskType() == Task::Traditional && ! getRecheckOutputs(list[i], j, outputs)) continue;
+            jobList.append(qMakePair(name, j));
+        }
+    return jobList;
+}
+
+int Contest::addPriorityJudging(const QString &name)
+{
+    if (! controller || ! contestantList.contains(name)) return 0;
+    int total = controller->addPriorityJob(name);
+    if (total > 0) emit priorityJudgingAdded(total);
+    return total;
+}
+
+bool Contest::isJudging() const
+{
+    return controller != 0;
+}
+
+bool Contest::isBackgroundPaused() const
+{
+    return controller && controller->isBackgroundPaused();
+}
+
+void Contest::pauseBackgroundSlot()
+{
+    if (controller) controller->setBackgroundPaused(true);
+}
+
+void Contest::resumeBackgroundSlot()
+{
+    if (controller) controller->setBackgroundPaused(false);
 }
 
 void Contest::stopJudgingSlot()
 {
-    stopJudging = true;
-    emit stopJudgingSignal();
+    if (controller) controller->cancel();
 }
 
-void Contest::writeToStream(QDataStream &out)
+void Contest::writeTasksToStream(QDataStream &out)
 {
     out << contestTitle;
     out << taskList.size();
     for (int i = 0; i < taskList.size(); i ++)
         taskList[i]->writeToStream(out);
-    out << contestantList.size();
-    QList<Contestant*> list = contestantList.values();
-    for (int i = 0; i < list.size(); i ++)
-        list[i]->writeToStream(out);
 }
 
-void Contest::readFromStream(QDataStream &in)
+void Contest::readTasksFromStream(QDataStream &in)
 {
     int count;
     in >> contestTitle;
@@ -414,14 +689,384 @@ void Contest::readFromStream(QDataStream &in)
         newTask->refreshCompilerConfiguration(settings);
         taskList.append(newTask);
     }
+}
+
+void Contest::writeToStream(QDataStream &out)
+{
+    writeTasksToStream(out);
+    out << contestantList.size();
+    QList<Contestant*> list = contestantList.values();
+    for (int i = 0; i < list.size(); i ++)
+        list[i]->writeToStream(out);
+    for (int i = 0; i < list.size(); i ++) {
+        QStringList fingerprintList;
+        for (int j = 0; j < taskList.size(); j ++)
+            fingerprintList.append(list[i]->getFingerprint(j));
+        out << fingerprintList;
+    }
+    for (int i = 0; i < list.size(); i ++) {
+        QList< QList<QStringList> > outputHashList;
+        for (int j = 0; j < taskList.size(); j ++)
+            outputHashList.append(list[i]->getOutputHash(j));
+        out << outputHashList;
+    }
+}
+
+bool Contest::saveToFile(const QString &fileName)
+{
+    waitForSave();
+    prepareSave(fileName);
+    saver->save();
+    return finishSave();
+}
+
+void Contest::saveInBackground(const QString &fileName)
+{
+    if (saver) return;
+    prepareSave(fileName);
+    connect(saver, SIGNAL(finished()), this, SLOT(backgroundSaveFinished()));
+    saver->start(QThread::LowPriority);
+}
+
+bool Contest::isSaving() const
+{
+    return saver != 0;
+}
+
+void Contest::waitForSave()
+{
+    if (! saver) return;
+    saver->wait();
+    emit saveFinished(finishSave());
+}
+
+void Contest::backgroundSaveFinished()
+{
+    if (! saver || sender() != saver || ! saver->isFinished()) return;
+    emit saveFinished(finishSave());
+}
+
+void Contest::prepareSave(const QString &fileName)
+{
+    QByteArray taskData;
+    QDataStream taskOut(&taskData, QIODevice::WriteOnly);
+    writeTasksToStream(taskOut);
+    
+    QFileInfo savedInfo(savedFileName);
+    bool sourceValid = ! savedFileName.isEmpty() && savedInfo.size() == savedFileSize
+                       && savedInfo.lastModified() == savedLastModified;
+    
+    saver = new ContestSaver(this);
+    saver->setFileName(QFileInfo(fileName).absoluteFilePath());
+    if (sourceValid) saver->setSourceFile(savedFileName, savedDirectoryOffset);
+    saver->setTaskData(taskData, savedTaskOffset, taskData != savedTaskData);
+    if (settings) saver->setCompression(settings->getCompressionCodec(), settings->getCompressionLevel());
+    saver->setGarbageBytes(garbageBytes);
+    saver->setReleasedOffsets(releasedOffsets);
+    savingTaskData = taskData;
+    savingReleasedOffsets = releasedOffsets;
+    savingResults = unsavedResults;
+    savingDatabaseChanges = database ? database->getChangeCount() : -1;
+    unsavedResults.clear();
+    savingContestants.clear();
+    savingOffsets.clear();
+    savingDirty.clear();
+    
+    QList<Contestant*> list = contestantList.values();
+    for (int i = 0; i < list.size(); i ++) {
+        bool dirty = list[i]->isDirty();
+        bool writeDetails = ! list[i]->isDetailsBroken() && (dirty || list[i]->getDetailsOffset() < 0 || ! sourceValid);
+        saver->addContestant(list[i]->createSnapshot(), writeDetails, list[i]->getDetailsOffset());
+        if (writeDetails) list[i]->setDirty(false);
+        savingContestants.append(list[i]);
+        savingOffsets.append(list[i]->getDetailsOffset());
+        savingDirty.append(dirty);
+    }
+}
+
+bool Contest::finishSave()
+{
+    QString fileName = saver->getFileName();
+    bool saved = saver->getSaved();
+    if (saved && ! saver->getAppended()) {
+        saved = ContestFile::replaceFile(ContestSaver::temporaryFileName(fileName), fileName);
+        if (! saved) QFile::remove(ContestSaver::temporaryFileName(fileName));
+    }
+    
+    if (saved) {
+        const QList<qint64> &offsets = saver->getDetailsOffsets();
+        for (int i = 0; i < savingReleasedOffsets.size(); i ++)
+            releasedOffsets.removeOne(savingReleasedOffsets[i]);
+        for (int i = 0; i < savingContestants.size(); i ++) {
+            if (savingContestants[i]) {
+                savingContestants[i]->moveDetails(fileName, offsets[i]);
+                continue;
+            }
+            releasedOffsets.removeOne(savingOffsets[i]);
+            releasedOffsets.append(offsets[i]);
+        }
+        garbageBytes = saver->getGarbageBytes();
+        rememberSavedFile(fileName, savingTaskData, saver->getTaskOffset(), saver->getDirectoryOffset());
+        journalFileName = fileName + ".journal";
+        restartJournal();
+        bool databaseChanged = ! database || database->getChangeCount() != savingDatabaseChanges;
+        openResultDatabase(fileName);
+        if (database && ! databaseChanged) database->setSavedStamp(getSavedStamp());
+    } else {
+        for (int i = 0; i < savingContestants.size(); i ++)
+            if (savingContestants[i] && savingDirty[i]) savingContestants[i]->setDirty(true);
+        unsavedResults = savingResults + unsavedResults;
+        const QStringList &brokenContestants = saver->getBrokenContestants();
+        for (int i = 0; i < brokenContestants.size(); i ++)
+            emit detailsLoadFailed(brokenContestants[i]);
+    }
+    
+    savingContestants.clear();
+    savingResults.clear();
+    saver->deleteLater();
+    saver = 0;
+    MessagePool::squeeze();
+    return saved;
+}
+
+void Contest::openResultDatabase(const QString &fileName)
+{
+    if (! settings->getResultDatabaseEnabled()) {
+        delete database;
+        database = 0;
+        return;
+    }
+    QString databaseFileName = ResultDatabase::databaseFileName(fileName);
+    if (database && database->getFileName() == databaseFileName) return;
+    if (! database) database = new ResultDatabase(this);
+    if (! database->open(databaseFileName)) return;
+    // the mirror is written as results arrive, so it only matches the contest file if the last save stamped it
+    QString stamp = getSavedStamp();
+    if (! stamp.isEmpty() && database->getSavedStamp() == stamp) return;
+    database->rebuild(taskList, getContestantList());
+    if (unsavedResults.isEmpty()) database->setSavedStamp(stamp);
+}
+
+void Contest::rememberSavedFile(const QString &fileName, const QByteArray &taskData, qint64 taskOffset, qint64 directoryOffset)
+{
+    QFileInfo info(fileName);
+    savedFileName = info.absoluteFilePath();
+    savedFileSize = info.size();
+    savedLastModified = info.lastModified();
+    savedTaskData = taskData;
+    savedTaskOffset = taskOffset;
+    savedDirectoryOffset = directoryOffset;
+}
+
+QString Contest::getSavedStamp() const
+{
+    if (savedFileName.isEmpty()) return QString();
+    return QString("%1:%2:%3").arg(savedDirectoryOffset).arg(savedFileSize)
+           .arg(savedLastModified.toString("yyyy-MM-ddThh:mm:ss.zzz"));
+}
+
+ContestFileState Contest::loadFromFile(const QString &fileName)
+{
+    ContestFileState state = readContestFile(fileName);
+    if (state == ContestFileLoaded) {
+        journalFileName = QFileInfo(fileName).absoluteFilePath() + ".journal";
+        openResultDatabase(fileName);
+        replayJournal();
+        if (database) database->flush();
+    }
+    return state;
+}
+
+ContestFileState Contest::readContestFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (! file.open(QFile::ReadOnly)) return CannotOpenContestFile;
+    
+    QDataStream _in(&file);
+    unsigned checkNumber;
+    _in >> checkNumber;
+    if (checkNumber == unsigned(ChunkedMagicNumber)) return loadChunkedFile(file, false);
+    if (checkNumber == unsigned(CodecMagicNumber)) return loadChunkedFile(file, true);
+    if (checkNumber != unsigned(MagicNumber)) return BrokenContestFile;
+    
+    quint16 checksum;
+    int len;
+    _in >> checksum >> len;
+    if (len < 0) return BrokenContestFile;
+    QByteArray data(len, 0);
+    if (_in.readRawData(data.data(), len) != len || qChecksum(data.data(), len) != checksum)
+        return BrokenContestFile;
+    
+    data = qUncompress(data);
+    QDataStream in(data);
+    readFromStream(in);
+    return ContestFileLoaded;
+}
+
+ContestFileState Contest::loadChunkedFile(QFile &file, bool tagged)
+{
+    QDataStream _in(&file);
+    qint64 directoryOffset;
+    _in >> directoryOffset;
+    QByteArray directory;
+    if (_in.status() != QDataStream::Ok || ! file.seek(directoryOffset)
+            || ! ContestFile::readBlock(&file, directory, tagged)) return BrokenContestFile;
+    
+    QDataStream directoryIn(directory);
+    qint64 taskOffset;
+    int count;
+    directoryIn >> taskOffset >> count;
+    QByteArray data;
+    if (directoryIn.status() != QDataStream::Ok || ! file.seek(taskOffset)
+            || ! ContestFile::readBlock(&file, data, tagged)) return BrokenContestFile;
+    QDataStream in(data);
+    readTasksFromStream(in);
+    
+    QString filePath = QFileInfo(file).absoluteFilePath();
+    garbageBytes = 0;
+    for (int i = 0; i < count && directoryIn.status() == QDataStream::Ok; i ++) {
+        qint64 offset;
+        directoryIn >> offset;
+        Contestant *newContestant = new Contestant(this);
+        newContestant->readSummaryFromStream(directoryIn);
+        newContestant->setDetailsLocation(filePath, offset);
+        addContestant(newContestant);
+    }
+    if (directoryIn.status() != QDataStream::Ok) return BrokenContestFile;
+    if (! directoryIn.atEnd()) directoryIn >> garbageBytes;
+    file.close();
+    rememberSavedFile(filePath, data, taskOffset, directoryOffset);
+    return ContestFileLoaded;
+}
+
+bool Contest::readContestTitle(const QString &fileName, QString &title)
+{
+    QFile file(fileName);
+    if (! file.open(QFile::ReadOnly)) return false;
+    QDataStream _in(&file);
+    unsigned checkNumber;
+    _in >> checkNumber;
+    
+    if (checkNumber == unsigned(ChunkedMagicNumber) || checkNumber == unsigned(CodecMagicNumber)) {
+        bool tagged = checkNumber == unsigned(CodecMagicNumber);
+        qint64 directoryOffset, taskOffset;
+        _in >> directoryOffset;
+        QByteArray directory, data;
+        if (_in.status() != QDataStream::Ok || ! file.seek(directoryOffset)
+                || ! ContestFile::readBlock(&file, directory, tagged)) return false;
+        QDataStream directoryIn(directory);
+        directoryIn >> taskOffset;
+        if (directoryIn.status() != QDataStream::Ok || ! file.seek(taskOffset)
+                || ! ContestFile::readBlock(&file, data, tagged)) return false;
+        QDataStream in(data);
+        in >> title;
+        return in.status() == QDataStream::Ok;
+    }
+    
+    if (checkNumber != unsigned(MagicNumber)) return false;
+    quint16 checksum;
+    int len;
+    _in >> checksum >> len;
+    if (len < 0) return false;
+    QByteArray data(len, 0);
+    if (_in.readRawData(data.data(), len) != len || qChecksum(data.data(), len) != checksum)
+        return false;
+    data = qUncompress(data);
+    QDataStream in(data);
+    in >> title;
+    return in.status() == QDataStream::Ok;
+}
+
+bool Contest::hasSameTasks(Contest *other)
+{
+    const QList<Task*> &otherTaskList = other->getTaskList();
+    if (taskList.size() != otherTaskList.size()) return false;
+    for (int i = 0; i < taskList.size(); i ++) {
+        QByteArray data, otherData;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        QDataStream otherOut(&otherData, QIODevice::WriteOnly);
+        taskList[i]->writeToStream(out);
+        otherTaskList[i]->writeToStream(otherOut);
+        if (data != otherData) return false;
+    }
+    return true;
+}
+
+bool Contest::mergeResultsFrom(Contest *other)
+{
+    if (! hasSameTasks(other)) return false;
+    
+    QList<Contestant*> otherContestantList = other->getContestantList();
+    for (int i = 0; i < otherContestantList.size(); i ++) {
+        Contestant *otherContestant = otherContestantList[i];
+        bool judged = false;
+        for (int j = 0; j < taskList.size(); j ++)
+            if (otherContestant->getCheckJudged(j)) judged = true;
+        if (! judged) continue;
+        
+        QString name = otherContestant->getContestantName();
+        Contestant *contestant = contestantList.value(name);
+        if (contestant && contestant->getJudingTime() >= otherContestant->getJudingTime()) {
+            bool curJudged = false;
+            for (int j = 0; j < taskList.size(); j ++)
+                if (contestant->getCheckJudged(j)) curJudged = true;
+            if (curJudged) continue;
+        }
+        
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        otherContestant->writeToStream(out);
+        QDataStream in(data);
+        deleteContestant(name);
+        contestant = new Contestant(this);
+        contestant->readFromStream(in);
+        for (int j = 0; j < taskList.size(); j ++) {
+            contestant->setFingerprint(j, otherContestant->getFingerprint(j));
+            contestant->setOutputHash(j, otherContestant->getOutputHash(j));
+            if (otherContestant->getCheckJudged(j))
+                contestant->setProcessorUsed(j, otherContestant->getProcessorUsed(j));
+        }
+        addContestant(contestant);
+        if (database)
+            for (int j = 0; j < taskList.size(); j ++)
+                if (contestant->getCheckJudged(j)) database->addTaskResult(contestant, j);
+    }
+    if (database) database->flush();
+    return true;
+}
+
+int Contest::getShardIndex(const QString &name, int count)
+{
+    QByteArray hash = QCryptographicHash::hash(name.toUtf8(), QCryptographicHash::Sha1);
+    quint32 value = (quint32(uchar(hash[0])) << 24) | (quint32(uchar(hash[1])) << 16)
+                    | (quint32(uchar(hash[2])) << 8) | quint32(uchar(hash[3]));
+    return int(value % quint32(count));
+}
+
+void Contest::readFromStream(QDataStream &in)
+{
+    QList<Contestant*> list;
+    int count;
+    readTasksFromStream(in);
     in >> count;
     for (int i = 0; i < count; i ++) {
         Contestant *newContestant = new Contestant(this);
         newContestant->readFromStream(in);
-        connect(this, SIGNAL(taskAddedForContestant()),
-                newContestant, SLOT(addTask()));
-        connect(this, SIGNAL(taskDeletedForContestant(int)),
-                newContestant, SLOT(deleteTask(int)));
-        contestantList.insert(newContestant->getContestantName(), newContestant);
+        addContestant(newContestant);
+        list.append(newContestant);
+    }
+    if (in.atEnd()) return;
+    for (int i = 0; i < list.size(); i ++) {
+        QStringList fingerprintList;
+        in >> fingerprintList;
+        for (int j = 0; j < fingerprintList.size(); j ++)
+            list[i]->setFingerprint(j, fingerprintList[j]);
+    }
+    if (in.atEnd()) return;
+    for (int i = 0; i < list.size(); i ++) {
+        QList< QList<QStringList> > outputHashList;
+        in >> outputHashList;
+        for (int j = 0; j < outputHashList.size(); j ++)
+            list[i]->setOutputHash(j, outputHashList[j]);
     }
 }
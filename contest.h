@@ -23,16 +23,23 @@
 #include <QObject>
 #include "globaltype.h"
 #define MagicNumber 0x20111127
+#define ChunkedMagicNumber 0x20121127
+#define CodecMagicNumber 0x20121129
 
 class Task;
 class Settings;
 class Contestant;
+class JudgingController;
+class ResultJournal;
+class ResultDatabase;
+class ContestSaver;
 
 class Contest : public QObject
 {
     Q_OBJECT
 public:
     explicit Contest(QObject *parent = 0);
+    ~Contest();
     void setSettings(Settings*);
     void setContestTitle(const QString&);
     const QString& getContestTitle() const;
@@ -45,38 +52,119 @@ public:
     void deleteTask(int);
     void refreshContestantList();
     void deleteContestant(const QString&);
+    int addPriorityJudging(const QString&);
+    bool isJudging() const;
+    bool isBackgroundPaused() const;
     void writeToStream(QDataStream&);
     void readFromStream(QDataStream&);
+    bool saveToFile(const QString&);
+    void saveInBackground(const QString&);
+    bool isSaving() const;
+    void waitForSave();
+    ContestFileState loadFromFile(const QString&);
+    QString getFingerprint(const QString&, int);
+    QList< QPair<QString, int> > getStaleJobs();
+    QList< QPair<QString, int> > getRecheckJobs();
+    bool hasSameTasks(Contest*);
+    bool mergeResultsFrom(Contest*);
+    static int getShardIndex(const QString&, int);
+    static bool readContestTitle(const QString&, QString&);
+    void setJournalEnabled(bool);
+    int getRecoveredCount() const;
+    const QList< QPair<QString, int> >& getResumeJobs() const;
 
 private:
     QString contestTitle;
     Settings *settings;
     QList<Task*> taskList;
     QMap<QString, Contestant*> contestantList;
-    bool stopJudging;
-    void judge(Contestant*);
-    void judge(Contestant*, int);
-    void clearPath(const QString&);
+    JudgingController *controller;
+    QMap< QPair<QString, int>, QString > judgingFingerprints;
+    QString savedFileName;
+    qint64 savedFileSize;
+    QDateTime savedLastModified;
+    QByteArray savedTaskData;
+    qint64 savedTaskOffset;
+    qint64 savedDirectoryOffset;
+    qint64 garbageBytes;
+    QList<qint64> releasedOffsets;
+    ContestSaver *saver;
+    QByteArray savingTaskData;
+    QList<qint64> savingReleasedOffsets;
+    QList< QPointer<Contestant> > savingContestants;
+    QList<qint64> savingOffsets;
+    QList<bool> savingDirty;
+    ResultJournal *journal;
+    QString journalFileName;
+    bool journalEnabled;
+    int recoveredCount;
+    QList< QPair<QString, int> > resumeJobs;
+    QList< QPair<QString, int> > remainingJobs;
+    QList< QPair<QString, int> > unsavedResults;
+    QList< QPair<QString, int> > savingResults;
+    int savingDatabaseChanges;
+    ResultDatabase *database;
+    QString getSourceFingerprint(const QString&, int) const;
+    QString getRunFingerprint(int);
+    QString getCheckFingerprint(int);
+    QString getTaskFingerprint(int);
+    bool getRecheckOutputs(Contestant*, int, QList<QStringList>&) const;
+    void addContestant(Contestant*);
+    void writeTasksToStream(QDataStream&);
+    void readTasksFromStream(QDataStream&);
+    ContestFileState readContestFile(const QString&);
+    ContestFileState loadChunkedFile(QFile&, bool);
+    QByteArray getTaskDigest(int);
+    void journalTaskResult(const QString&, int);
+    void appendTaskResultRecord(const QString&, int);
+    void journalRunStarted(const QList< QPair<QString, int> >&);
+    void replayJournal();
+    void restartJournal();
+    void openResultDatabase(const QString&);
+    void prepareSave(const QString&);
+    bool finishSave();
+    void rememberSavedFile(const QString&, const QByteArray&, qint64, qint64);
+    QString getSavedStamp() const;
+    void runJudging(const QList< QPair<QString, int> >&, const QMap< QPair<QString, int>, QList<QStringList> >&);
+
+private slots:
+    void applyTaskResult(const QString&, int, QObject*, QObject*, bool);
+    void progressSnapshot(const QList< QList<int> >&);
+    void backgroundSaveFinished();
+    void judgingControllerFinished();
 
 public slots:
     void judge(const QString&);
     void judge(const QString&, int);
+    void judge(const QStringList&);
+    void judge(const QStringList&, const QList<int>&);
+    void judge(const QList< QPair<QString, int> >&);
     void judgeAll();
+    void judgeStale();
+    void recheck(const QList< QPair<QString, int> >&);
+    void resumeJudging();
+    void pauseBackgroundSlot();
+    void resumeBackgroundSlot();
     void stopJudgingSlot();
 
 signals:
+    void saveFinished(bool);
+    void detailsLoadFailed(const QString&);
     void taskAddedForContestant();
     void taskDeletedForContestant(int);
     void taskAddedForViewer();
     void taskDeletedForViewer(int);
     void problemTitleChanged();
-    void singleCaseFinished(int, int, int, int);
+    void singleCaseFinished(int, int, int, int, int);
     void taskJudgingStarted(QString);
     void taskJudgingFinished();
+    void judgingFinished();
     void contestantJudgingStart(QString);
     void contestantJudgingFinished();
     void compileError(int, int);
-    void stopJudgingSignal();
+    void compileFailed(QString, QString, int);
+    void numberOfWorkersChanged(int, const QString&);
+    void priorityJudgingAdded(int);
 };
 
 #endif // CONTEST_H
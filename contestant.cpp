@@ -17,11 +17,17 @@
 ***************************************************************************/
 
 #include "contestant.h"
+#include "messagepool.h"
 #include "contest.h"
+#include "contestfile.h"
 
 Contestant::Contestant(QObject *parent) :
     QObject(parent)
 {
+    detailsOffset = -1;
+    detailsBroken = false;
+    totalUsedTime = -1;
+    dirty = true;
 }
 
 const QString& Contestant::getContestantName() const
@@ -36,47 +42,62 @@ bool Contestant::getCheckJudged(int index) const
 
 CompileState Contestant::getCompileState(int index) const
 {
+    loadDetails();
     return compileState[index];
 }
 
 const QString& Contestant::getSourceFile(int index) const
 {
+    loadDetails();
     return sourceFile[index];
 }
 
 const QString& Contestant::getCompileMessage(int index) const
 {
+    loadDetails();
     return compileMesaage[index];
 }
 
 const QList<QStringList>& Contestant::getInputFiles(int index) const
 {
+    loadDetails();
     return inputFiles[index];
 }
 
-const QList< QList<ResultState> >& Contestant::getResult(int index) const
+QList< QList<ResultState> > Contestant::getResult(int index) const
 {
-    return result[index];
+    loadDetails();
+    return taskResult[index].getResult();
 }
 
 const QList<QStringList>& Contestant::getMessage(int index) const
 {
+    loadDetails();
     return message[index];
 }
 
-const QList< QList<int> >& Contestant::getSocre(int index) const
+QList< QList<int> > Contestant::getSocre(int index) const
 {
-    return score[index];
+    loadDetails();
+    return taskResult[index].getScore();
 }
 
-const QList< QList<int> >& Contestant::getTimeUsed(int index) const
+QList< QList<int> > Contestant::getTimeUsed(int index) const
 {
-    return timeUsed[index];
+    loadDetails();
+    return taskResult[index].getTimeUsed();
 }
 
-const QList< QList<int> >& Contestant::getMemoryUsed(int index) const
+QList< QList<int> > Contestant::getMemoryUsed(int index) const
 {
-    return memoryUsed[index];
+    loadDetails();
+    return taskResult[index].getMemoryUsed();
+}
+
+QList< QList<int> > Contestant::getProcessorUsed(int index) const
+{
+    loadDetails();
+    return taskResult[index].getProcessorUsed();
 }
 
 QDateTime Contestant::getJudingTime() const
@@ -84,107 +105,175 @@ QDateTime Contestant::getJudingTime() const
     return judgingTime;
 }
 
+QString Contestant::getFingerprint(int index) const
+{
+    if (0 > index || index >= fingerprint.size()) return QString();
+    return fingerprint[index];
+}
+
+QList<QStringList> Contestant::getOutputHash(int index) const
+{
+    loadDetails();
+    if (0 > index || index >= outputHash.size()) return QList<QStringList>();
+    return outputHash[index];
+}
+
 void Contestant::setContestantName(const QString &name)
 {
+    loadDetails();
     contestantName = name;
+    dirty = true;
 }
 
 void Contestant::setCheckJudged(int index, bool check)
 {
+    loadDetails();
     checkJudged[index] = check;
+    dirty = true;
 }
 
 void Contestant::setCompileState(int index, CompileState state)
 {
+    loadDetails();
     compileState[index] = state;
+    dirty = true;
 }
 
 void Contestant::setSourceFile(int index, const QString &fileName)
 {
+    loadDetails();
     sourceFile[index] = fileName;
+    dirty = true;
 }
 
 void Contestant::setCompileMessage(int index, const QString &text)
 {
-    compileMesaage[index] = text;
+    loadDetails();
+    compileMesaage[index] = MessagePool::intern(text);
+    dirty = true;
 }
 
 void Contestant::setInputFiles(int index, const QList<QStringList> &files)
 {
+    loadDetails();
     inputFiles[index] = files;
+    dirty = true;
 }
 
 void Contestant::setResult(int index, const QList< QList<ResultState> > &_result)
 {
-    result[index] = _result;
+    loadDetails();
+    taskResult[index].setResult(_result);
+    dirty = true;
 }
 
 void Contestant::setMessage(int index, const QList<QStringList>&_message)
 {
-    message[index] = _message;
+    loadDetails();
+    message[index] = MessagePool::intern(_message);
+    dirty = true;
 }
 
 void Contestant::setScore(int index, const QList< QList<int> > &_score)
 {
-    score[index] = _score;
+    loadDetails();
+    taskResult[index].setScore(_score);
+    dirty = true;
 }
 
 void Contestant::setTimeUsed(int index, const QList< QList<int> > &_timeUsed)
 {
-    timeUsed[index] = _timeUsed;
+    loadDetails();
+    taskResult[index].setTimeUsed(_timeUsed);
+    dirty = true;
 }
 
 void Contestant::setMemoryUsed(int index, const QList< QList<int> > &_memoryUsed)
 {
-    memoryUsed[index] = _memoryUsed;
+    loadDetails();
+    taskResult[index].setMemoryUsed(_memoryUsed);
+    dirty = true;
+}
+
+void Contestant::setProcessorUsed(int index, const QList< QList<int> > &_processorUsed)
+{
+    loadDetails();
+    taskResult[index].setProcessorUsed(_processorUsed);
+    dirty = true;
+}
+
+void Contestant::setCaseResult(int index, int testCase, int caseIndex, ResultState _result, int _score)
+{
+    loadDetails();
+    taskResult[index].setCaseResult(testCase, caseIndex, _result, _score);
+    dirty = true;
+}
+
+void Contestant::setCaseUsage(int index, int testCase, int caseIndex, int _timeUsed, int _memoryUsed, int _processorUsed)
+{
+    loadDetails();
+    taskResult[index].setCaseUsage(testCase, caseIndex, _timeUsed, _memoryUsed, _processorUsed);
+    dirty = true;
 }
 
 void Contestant::setJudgingTime(QDateTime time)
 {
+    loadDetails();
     judgingTime = time;
+    dirty = true;
+}
+
+void Contestant::setFingerprint(int index, const QString &_fingerprint)
+{
+    if (0 > index || index >= fingerprint.size()) return;
+    fingerprint[index] = _fingerprint;
+    dirty = true;
+}
+
+void Contestant::setOutputHash(int index, const QList<QStringList> &hash)
+{
+    loadDetails();
+    if (0 > index || index >= outputHash.size()) return;
+    outputHash[index] = hash;
+    dirty = true;
 }
 
 void Contestant::addTask()
 {
+    loadDetails();
     checkJudged.append(false);
     compileState.append(NoValidSourceFile);
     sourceFile.append("");
     compileMesaage.append("");
     inputFiles.append(QList<QStringList>());
-    result.append(QList< QList<ResultState> >());
+    taskResult.append(TaskResult());
     message.append(QList<QStringList>());
-    score.append(QList< QList<int> >());
-    timeUsed.append(QList< QList<int> >());
-    memoryUsed.append(QList< QList<int> >());
+    fingerprint.append("");
+    outputHash.append(QList<QStringList>());
+    dirty = true;
 }
 
 void Contestant::deleteTask(int index)
 {
+    loadDetails();
     checkJudged.removeAt(index);
     compileState.removeAt(index);
     sourceFile.removeAt(index);
     compileMesaage.removeAt(index);
     inputFiles.removeAt(index);
-    result.removeAt(index);
+    taskResult.removeAt(index);
     message.removeAt(index);
-    score.removeAt(index);
-    timeUsed.removeAt(index);
-    memoryUsed.removeAt(index);
+    fingerprint.removeAt(index);
+    outputHash.removeAt(index);
+    dirty = true;
 }
 
 int Contestant::getTaskScore(int index) const
 {
     if (0 > index || index >= checkJudged.size()) return -1;
     if (! checkJudged[index]) return -1;
-    int total = 0;
-    for (int i = 0; i < score[index].size(); i ++) {
-        int minv = 1000000000;
-        for (int j = 0; j < score[index][i].size(); j ++)
-            if (score[index][i][j] < minv) minv = score[index][i][j];
-        if (minv == 1000000000) minv = 0;
-        total += minv;
-    }
-    return total;
+    if (! detailsFile.isEmpty()) return taskScore.value(index, 0);
+    return taskResult[index].getTaskScore();
 }
 
 int Contestant::getTotalScore() const
@@ -193,7 +282,7 @@ int Contestant::getTotalScore() const
     for (int i = 0; i < checkJudged.size(); i ++)
         if (! checkJudged[i]) return -1;
     int total = 0;
-    for (int i = 0; i < score.size(); i ++)
+    for (int i = 0; i < checkJudged.size(); i ++)
         total += getTaskScore(i);
     return total;
 }
@@ -203,36 +292,42 @@ int Contestant::getTotalUsedTime() const
     if (checkJudged.size() == 0) return -1;
     for (int i = 0; i < checkJudged.size(); i ++)
         if (! checkJudged[i]) return -1;
+    if (! detailsFile.isEmpty()) return totalUsedTime;
     int total = 0;
-    for (int i = 0; i < timeUsed.size(); i ++)
-        for (int j = 0; j < timeUsed[i].size(); j ++)
-            for (int k = 0; k < timeUsed[i][j].size(); k ++)
-                if (timeUsed[i][j][k] >= 0) total += timeUsed[i][j][k];
+    for (int i = 0; i < taskResult.size(); i ++)
+        total += taskResult[i].getTotalTimeUsed();
     return total;
 }
 
 void Contestant::writeToStream(QDataStream &out)
 {
+    loadDetails();
     out << contestantName;
     out << checkJudged;
     out << sourceFile;
     out << compileMesaage;
     out << inputFiles;
     out << message;
-    out << score;
-    out << timeUsed;
-    out << memoryUsed;
+    out << quint32(taskResult.size());
+    for (int i = 0; i < taskResult.size(); i ++)
+        out << taskResult[i].getScore();
+    out << quint32(taskResult.size());
+    for (int i = 0; i < taskResult.size(); i ++)
+        out << taskResult[i].getTimeUsed();
+    out << quint32(taskResult.size());
+    for (int i = 0; i < taskResult.size(); i ++)
+        out << taskResult[i].getMemoryUsed();
     out << judgingTime;
     out << compileState.size();
     for (int i = 0; i < compileState.size(); i ++)
         out << int(compileState[i]);
-    out << result.size();
-    for (int i = 0; i < result.size(); i ++) {
-        out << result[i].size();
-        for (int j = 0; j < result[i].size(); j ++) {
-            out << result[i][j].size();
-            for (int k = 0; k < result[i][j].size(); k ++)
-                out << int(result[i][j][k]);
+    out << taskResult.size();
+    for (int i = 0; i < taskResult.size(); i ++) {
+        out << taskResult[i].getTestCaseCount();
+        for (int j = 0; j < taskResult[i].getTestCaseCount(); j ++) {
+            out << taskResult[i].getCaseCount(j);
+            for (int k = 0; k < taskResult[i].getCaseCount(j); k ++)
+                out << int(taskResult[i].getResult(j, k));
         }
     }
 }
@@ -243,12 +338,22 @@ void Contestant::readFromStream(QDataStream &in)
     in >> checkJudged;
     in >> sourceFile;
     in >> compileMesaage;
+    QList< QList< QList<int> > > score, timeUsed, memoryUsed;
     in >> inputFiles;
     in >> message;
     in >> score;
     in >> timeUsed;
     in >> memoryUsed;
     in >> judgingTime;
+    compileMesaage = MessagePool::intern(compileMesaage);
+    for (int i = 0; i < message.size(); i ++)
+        message[i] = MessagePool::intern(message[i]);
+    fingerprint.clear();
+    outputHash.clear();
+    for (int i = 0; i < checkJudged.size(); i ++) {
+        fingerprint.append("");
+        outputHash.append(QList<QStringList>());
+    }
     int count, _count, __count, tmp;
     in >> count;
     for (int i = 0; i < count; i ++) {
@@ -257,15 +362,283 @@ void Contestant::readFromStream(QDataStream &in)
     }
     in >> count;
     for (int i = 0; i < count; i ++) {
-        result.append(QList< QList<ResultState> >());
+        QList< QList<ResultState> > result;
         in >> _count;
         for (int j = 0; j < _count; j ++) {
-            result[i].append(QList<ResultState>());
+            result.append(QList<ResultState>());
             in >> __count;
             for (int k = 0; k < __count; k ++) {
                 in >> tmp;
-                result[i][j].append(ResultState(tmp));
+                result[j].append(ResultState(tmp));
             }
         }
+        taskResult.append(TaskResult());
+        taskResult[i].setResult(result);
+        if (i < score.size()) taskResult[i].setScore(score[i]);
+        if (i < timeUsed.size()) taskResult[i].setTimeUsed(timeUsed[i]);
+        if (i < memoryUsed.size()) taskResult[i].setMemoryUsed(memoryUsed[i]);
+    }
+}
+
+void Contestant::writeTaskToStream(int index, QDataStream &out)
+{
+    loadDetails();
+    out << checkJudged[index];
+    out << int(compileState[index]);
+    out << sourceFile[index];
+    out << compileMesaage[index];
+    out << inputFiles[index];
+    const TaskResult &_taskResult = taskResult[index];
+    out << _taskResult.getTestCaseCount();
+    for (int i = 0; i < _taskResult.getTestCaseCount(); i ++) {
+        QList<int> _result;
+        for (int j = 0; j < _taskResult.getCaseCount(i); j ++)
+            _result.append(int(_taskResult.getResult(i, j)));
+        out << _result;
+    }
+    out << message[index];
+    out << _taskResult.getScore();
+    out << _taskResult.getTimeUsed();
+    out << _taskResult.getMemoryUsed();
+    out << outputHash[index];
+    out << fingerprint[index];
+    out << judgingTime;
+    out << _taskResult.getProcessorUsed();
+}
+
+void Contestant::readTaskFromStream(int index, QDataStream &in)
+{
+    loadDetails();
+    int tmp, count;
+    bool judged;
+    in >> judged;
+    checkJudged[index] = judged;
+    in >> tmp;
+    compileState[index] = CompileState(tmp);
+    in >> sourceFile[index];
+    in >> compileMesaage[index];
+    in >> inputFiles[index];
+    in >> count;
+    QList< QList<ResultState> > result;
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; i ++) {
+        QList<int> _result;
+        in >> _result;
+        result.append(QList<ResultState>());
+        for (int j = 0; j < _result.size(); j ++)
+            result[i].append(ResultState(_result[j]));
+    }
+    QList< QList<int> > score, timeUsed, memoryUsed;
+    in >> message[index];
+    compileMesaage[index] = MessagePool::intern(compileMesaage[index]);
+    message[index] = MessagePool::intern(message[index]);
+    in >> score;
+    in >> timeUsed;
+    in >> memoryUsed;
+    taskResult[index].clear();
+    taskResult[index].setResult(result);
+    taskResult[index].setScore(score);
+    taskResult[index].setTimeUsed(timeUsed);
+    taskResult[index].setMemoryUsed(memoryUsed);
+    in >> outputHash[index];
+    in >> fingerprint[index];
+    in >> judgingTime;
+    if (! in.atEnd()) {
+        QList< QList<int> > processorUsed;
+        in >> processorUsed;
+        taskResult[index].setProcessorUsed(processorUsed);
+    }
+    dirty = true;
+}
+
+void Contestant::writeSummaryToStream(QDataStream &out)
+{
+    if (isDetailsBroken()) {
+        out << contestantName << savedCheckJudged << judgingTime << fingerprint << taskScore << totalUsedTime;
+        return;
+    }
+    QList<int> _taskScore;
+    for (int i = 0; i < checkJudged.size(); i ++)
+        _taskScore.append(getTaskScore(i));
+    out << contestantName;
+    out << checkJudged;
+    out << judgingTime;
+    out << fingerprint;
+    out << _taskScore;
+    out << getTotalUsedTime();
+}
+
+void Contestant::readSummaryFromStream(QDataStream &in)
+{
+    in >> contestantName;
+    in >> checkJudged;
+    in >> judgingTime;
+    in >> fingerprint;
+    in >> taskScore;
+    in >> totalUsedTime;
+    while (fingerprint.size() < checkJudged.size())
+        fingerprint.append("");
+}
+
+void Contestant::writeDetailsToStream(QDataStream &out)
+{
+    writeToStream(out);
+    out << outputHash;
+    out << quint32(taskResult.size());
+    for (int i = 0; i < taskResult.size(); i ++)
+        out << taskResult[i].getProcessorUsed();
+}
+
+void Contestant::readDetailsFromStream(QDataStream &in)
+{
+    QStringList _fingerprint = fingerprint;
+    compileState.clear();
+    taskResult.clear();
+    readFromStream(in);
+    fingerprint = _fingerprint;
+    while (fingerprint.size() < checkJudged.size())
+        fingerprint.append("");
+    in >> outputHash;
+    while (outputHash.size() < checkJudged.size())
+        outputHash.append(QList<QStringList>());
+    if (in.atEnd()) return;
+    QList< QList< QList<int> > > processorUsed;
+    in >> processorUsed;
+    for (int i = 0; i < processorUsed.size() && i < taskResult.size(); i ++)
+        taskResult[i].setProcessorUsed(processorUsed[i]);
+}
+
+void Contestant::setDetailsLocation(const QString &fileName, qint64 offset)
+{
+    detailsFile = fileName;
+    loadedFile.clear();
+    detailsOffset = offset;
+    detailsBroken = false;
+    dirty = false;
+}
+
+qint64 Contestant::getDetailsOffset() const
+{
+    return detailsOffset;
+}
+
+void Contestant::moveDetails(const QString &fileName, qint64 offset)
+{
+    if (! detailsFile.isEmpty())
+        detailsFile = fileName;
+    else
+        loadedFile = fileName;
+    detailsOffset = offset;
+}
+
+bool Contestant::isDirty() const
+{
+    return dirty;
+}
+
+void Contestant::setDirty(bool _dirty)
+{
+    dirty = _dirty;
+    if (! dirty) detailsBroken = false;
+}
+
+void Contestant::loadDetails() const
+{
+    if (detailsFile.isEmpty()) return;
+    Contestant *self = const_cast<Contestant*>(this);
+    QByteArray data;
+    bool loaded = ContestFile::readBlock(detailsFile, detailsOffset, data);
+    self->loadedFile = detailsFile;
+    self->detailsFile.clear();
+    QList<bool> _checkJudged = checkJudged;
+    if (loaded) {
+        QDataStream in(data);
+        self->readDetailsFromStream(in);
+        loaded = in.status() == QDataStream::Ok && checkJudged == _checkJudged
+                 && compileState.size() == checkJudged.size() && taskResult.size() == checkJudged.size();
+    }
+    if (! loaded) {
+        // keep the summary and the block on disk, so that saving never replaces them with the reset details
+        self->loadedFile.clear();
+        self->checkJudged = _checkJudged;
+        self->savedCheckJudged = _checkJudged;
+        self->resetDetails();
+        self->detailsBroken = true;
+        emit self->detailsLoadFailed(contestantName);
+    }
+}
+
+Contestant* Contestant::createSnapshot() const
+{
+    Contestant *snapshot = new Contestant;
+    snapshot->contestantName = contestantName;
+    snapshot->checkJudged = checkJudged;
+    snapshot->compileState = compileState;
+    snapshot->sourceFile = sourceFile;
+    snapshot->compileMesaage = compileMesaage;
+    snapshot->inputFiles = inputFiles;
+    snapshot->taskResult = taskResult;
+    snapshot->message = message;
+    snapshot->judgingTime = judgingTime;
+    snapshot->fingerprint = fingerprint;
+    snapshot->outputHash = outputHash;
+    snapshot->detailsFile = detailsFile;
+    snapshot->loadedFile = loadedFile;
+    snapshot->detailsOffset = detailsOffset;
+    snapshot->detailsBroken = detailsBroken;
+    snapshot->savedCheckJudged = savedCheckJudged;
+    snapshot->taskScore = taskScore;
+    snapshot->totalUsedTime = totalUsedTime;
+    snapshot->dirty = dirty;
+    return snapshot;
+}
+
+bool Contestant::isDetailsLoaded() const
+{
+    return detailsFile.isEmpty();
+}
+
+bool Contestant::isDetailsBroken() const
+{
+    return detailsBroken && ! dirty;
+}
+
+void Contestant::releaseDetails()
+{
+    if (dirty || loadedFile.isEmpty() || detailsOffset < 0) return;
+    QList<int> _taskScore;
+    for (int i = 0; i < checkJudged.size(); i ++)
+        _taskScore.append(getTaskScore(i));
+    totalUsedTime = getTotalUsedTime();
+    taskScore = _taskScore;
+    detailsFile = loadedFile;
+    loadedFile.clear();
+    compileState.clear();
+    sourceFile.clear();
+    compileMesaage.clear();
+    inputFiles.clear();
+    taskResult.clear();
+    message.clear();
+    outputHash.clear();
+}
+
+void Contestant::resetDetails()
+{
+    int count = checkJudged.size();
+    compileState.clear();
+    sourceFile.clear();
+    compileMesaage.clear();
+    inputFiles.clear();
+    taskResult.clear();
+    message.clear();
+    outputHash.clear();
+    for (int i = 0; i < count; i ++) {
+        checkJudged[i] = false;
+        compileState.append(NoValidSourceFile);
+        sourceFile.append("");
+        compileMesaage.append("");
+        inputFiles.append(QList<QStringList>());
+        taskResult.append(TaskResult());
+        message.append(QList<QStringList>());
+        outputHash.append(QList<QStringList>());
     }
 }
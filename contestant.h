@@ -22,6 +22,7 @@
 #include <QtCore>
 #include <QObject>
 #include "globaltype.h"
+#include "taskresult.h"
 
 class Contestant : public QObject
 {
@@ -35,12 +36,15 @@ public:
     const QString& getSourceFile(int) const;
     const QString& getCompileMessage(int) const;
     const QList<QStringList>& getInputFiles(int) const;
-    const QList< QList<ResultState> >& getResult(int) const;
+    QList< QList<ResultState> > getResult(int) const;
     const QList<QStringList>& getMessage(int) const;
-    const QList< QList<int> >& getSocre(int) const;
-    const QList< QList<int> >& getTimeUsed(int) const;
-    const QList< QList<int> >& getMemoryUsed(int) const;
+    QList< QList<int> > getSocre(int) const;
+    QList< QList<int> > getTimeUsed(int) const;
+    QList< QList<int> > getMemoryUsed(int) const;
+    QList< QList<int> > getProcessorUsed(int) const;
     QDateTime getJudingTime() const;
+    QString getFingerprint(int) const;
+    QList<QStringList> getOutputHash(int) const;
     int getTaskScore(int) const;
     int getTotalScore() const;
     int getTotalUsedTime() const;
@@ -56,10 +60,31 @@ public:
     void setScore(int, const QList< QList<int> >&);
     void setTimeUsed(int, const QList< QList<int> >&);
     void setMemoryUsed(int, const QList< QList<int> >&);
+    void setProcessorUsed(int, const QList< QList<int> >&);
+    void setCaseResult(int, int, int, ResultState, int);
+    void setCaseUsage(int, int, int, int, int, int);
     void setJudgingTime(QDateTime);
+    void setFingerprint(int, const QString&);
+    void setOutputHash(int, const QList<QStringList>&);
     
     void writeToStream(QDataStream&);
     void readFromStream(QDataStream&);    
+    void writeTaskToStream(int, QDataStream&);
+    void readTaskFromStream(int, QDataStream&);
+    void writeSummaryToStream(QDataStream&);
+    void readSummaryFromStream(QDataStream&);
+    void writeDetailsToStream(QDataStream&);
+    void readDetailsFromStream(QDataStream&);
+    void setDetailsLocation(const QString&, qint64);
+    qint64 getDetailsOffset() const;
+    void moveDetails(const QString&, qint64);
+    bool isDirty() const;
+    void setDirty(bool);
+    void loadDetails() const;
+    bool isDetailsLoaded() const;
+    bool isDetailsBroken() const;
+    void releaseDetails();
+    Contestant* createSnapshot() const;
 
 private:
     QString contestantName;
@@ -68,14 +93,23 @@ private:
     QStringList sourceFile;
     QStringList compileMesaage;
     QList< QList<QStringList> > inputFiles;
-    QList< QList< QList<ResultState> > > result;
+    QList<TaskResult> taskResult;
     QList< QList<QStringList> > message;
-    QList< QList< QList<int> > > score;
-    QList< QList< QList<int> > > timeUsed;
-    QList< QList< QList<int> > > memoryUsed;
     QDateTime judgingTime;
+    QStringList fingerprint;
+    QList< QList<QStringList> > outputHash;
+    QString detailsFile;
+    QString loadedFile;
+    qint64 detailsOffset;
+    bool detailsBroken;
+    QList<bool> savedCheckJudged;
+    QList<int> taskScore;
+    int totalUsedTime;
+    bool dirty;
+    void resetDetails();
 
 signals:
+    void detailsLoadFailed(const QString&);
 
 public slots:
     void addTask();
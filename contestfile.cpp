@@ -0,0 +1,358 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "contestfile.h"
+#include "contest.h"
+
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#include <io.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+#ifdef LEMON_ZSTD
+#include <zstd.h>
+#endif
+
+class ChecksumTable
+{
+public:
+    ChecksumTable()
+    {
+        for (quint32 i = 0; i < 256; i ++) {
+            quint32 value = i;
+            for (int j = 0; j < 8; j ++)
+                value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+            table[i] = value;
+        }
+    }
+    quint32 table[256];
+};
+
+// filled in before main() so that saving threads never race on it
+static ChecksumTable checksumTable;
+
+quint32 ContestFile::checksum(const QByteArray &data)
+{
+    const quint32 *table = checksumTable.table;
+    quint32 crc = 0xFFFFFFFFu;
+    const uchar *p = reinterpret_cast<const uchar*>(data.constData());
+    for (int i = 0; i < data.size(); i ++)
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md)
+
+static inline quint32 readWord(const uchar *p)
+{
+    return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+}
+
+static uchar* writeLength(uchar *op, int length)
+{
+    while (length >= 255) {
+        *op ++ = 255;
+        length -= 255;
+    }
+    *op ++ = uchar(length);
+    return op;
+}
+
+static uchar* writeSequence(uchar *op, const uchar *literals, int literalLength, int offset, int matchLength)
+{
+    uchar *token = op ++;
+    *token = uchar(qMin(literalLength, 15) << 4);
+    if (literalLength >= 15) op = writeLength(op, literalLength - 15);
+    memcpy(op, literals, literalLength);
+    op += literalLength;
+    if (offset == 0) return op;
+    *token |= uchar(qMin(matchLength, 15));
+    *op ++ = uchar(offset & 255);
+    *op ++ = uchar(offset >> 8);
+    if (matchLength >= 15) op = writeLength(op, matchLength - 15);
+    return op;
+}
+
+static int lz4Bound(int size)
+{
+    return size + size / 255 + 16;
+}
+
+// low levels skip ahead quickly over incompressible data, higher levels also try earlier positions with the same hash
+static int lz4Compress(const uchar *src, int size, uchar *dst, int level)
+{
+    const int minMatch = 4, lastLiterals = 5, matchFindLimit = 12, windowSize = 65536;
+    level = qBound(1, level, 9);
+    const int hashLog = 12 + level / 2, skipTrigger = level + 2, maxAttempts = 1 << ((level - 1) / 2);
+    const uchar *end = src + size, *anchor = src, *ip = src;
+    uchar *op = dst;
+    if (size > matchFindLimit) {
+        QVector<int> table(1 << hashLog, -1), chain(maxAttempts > 1 ? windowSize : 0);
+        const uchar *searchLimit = end - matchFindLimit, *matchLimit = end - lastLiterals;
+        int misses = 0;
+        while (ip < searchLimit) {
+            quint32 sequence = readWord(ip);
+            int position = int(ip - src);
+            int hash = int((sequence * 2654435761u) >> (32 - hashLog));
+            const uchar *match = 0, *matchEnd = ip;
+            int reference = table[hash];
+            for (int attempts = maxAttempts; reference >= 0 && position - reference < windowSize && attempts > 0; attempts --) {
+                if (readWord(src + reference) == sequence) {
+                    const uchar *p = ip + minMatch, *q = src + reference + minMatch;
+                    while (p < matchLimit && *p == *q) {
+                        p ++;
+                        q ++;
+                    }
+                    if (p > matchEnd) {
+                        match = src + reference;
+                        matchEnd = p;
+                    }
+                }
+                if (chain.isEmpty()) break;
+                reference = chain[reference & (windowSize - 1)];
+            }
+            if (! chain.isEmpty()) chain[position & (windowSize - 1)] = table[hash];
+            table[hash] = position;
+            if (! match) {
+                ip += 1 + (misses ++ >> skipTrigger);
+                continue;
+            }
+            misses = 0;
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                ip --;
+                match --;
+            }
+            op = writeSequence(op, anchor, int(ip - anchor), int(ip - match), int(matchEnd - ip) - minMatch);
+            ip = anchor = matchEnd;
+        }
+    }
+    op = writeSequence(op, anchor, int(end - anchor), 0, 0);
+    return int(op - dst);
+}
+
+static bool readLength(const uchar *&ip, const uchar *end, int limit, int &length)
+{
+    uchar byte;
+    do {
+        if (ip >= end) return false;
+        byte = *ip ++;
+        length += byte;
+        if (length > limit) return false;
+    } while (byte == 255);
+    return true;
+}
+
+static bool lz4Uncompress(const uchar *src, int size, uchar *dst, int outputSize)
+{
+    const uchar *ip = src, *end = src + size;
+    uchar *op = dst, *outputEnd = dst + outputSize;
+    while (ip < end) {
+        int token = *ip ++;
+        int literalLength = token >> 4;
+        if (literalLength == 15 && ! readLength(ip, end, outputSize, literalLength)) return false;
+        if (literalLength > end - ip || literalLength > outputEnd - op) return false;
+        memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+        if (ip == end) break;
+        
+        if (end - ip < 2) return false;
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - dst) return false;
+        int matchLength = token & 15;
+        if (matchLength == 15 && ! readLength(ip, end, outputSize, matchLength)) return false;
+        matchLength += 4;
+        if (matchLength > outputEnd - op) return false;
+        const uchar *match = op - offset;
+        for (int i = 0; i < matchLength; i ++)
+            op[i] = match[i];
+        op += matchLength;
+    }
+    return op == outputEnd;
+}
+
+bool ContestFile::isCodecAvailable(int codec)
+{
+#ifdef LEMON_ZSTD
+    if (codec == ZstdCompression) return true;
+#endif
+    return codec == NoCompression || codec == ZlibCompression || codec == Lz4Compression;
+}
+
+QByteArray ContestFile::compress(const QByteArray &data, int codec, int level)
+{
+    if (! isCodecAvailable(codec)) codec = Lz4Compression;
+    QByteArray result;
+    result.append(char(codec)).append(char(level));
+    if (codec == ZlibCompression)
+        return result.append(qCompress(data, level));
+    if (codec == NoCompression)
+        return result.append(data);
+    
+    QDataStream out(&result, QIODevice::WriteOnly | QIODevice::Append);
+    out << quint32(data.size());
+    int headerSize = result.size();
+#ifdef LEMON_ZSTD
+    if (codec == ZstdCompression) {
+        result.resize(headerSize + int(ZSTD_compressBound(data.size())));
+        size_t compressedSize = ZSTD_compress(result.data() + headerSize, result.size() - headerSize,
+                                              data.constData(), data.size(), level);
+        if (ZSTD_isError(compressedSize)) return compress(data, Lz4Compression, level);
+        result.resize(headerSize + int(compressedSize));
+        return result;
+    }
+#endif
+    result.resize(headerSize + lz4Bound(data.size()));
+    int size = lz4Compress(reinterpret_cast<const uchar*>(data.constData()), data.size(),
+                           reinterpret_cast<uchar*>(result.data()) + headerSize, level);
+    result.resize(headerSize + size);
+    return result;
+}
+
+bool ContestFile::uncompress(const QByteArray &payload, QByteArray &data)
+{
+    if (payload.size() < 2) return false;
+    int codec = uchar(payload[0]);
+    QByteArray body = payload.mid(2);
+    if (codec == NoCompression) {
+        data = body;
+        return true;
+    }
+    if (codec == ZlibCompression) {
+        // qUncompress returns an empty array both for empty input and on failure
+        data = qUncompress(body);
+        return ! data.isEmpty() || body == QByteArray(4, 0);
+    }
+    if (! isCodecAvailable(codec) || body.size() < 4) return false;
+    
+    QDataStream in(body);
+    quint32 size;
+    in >> size;
+    if (size > quint32(0x7FFFFFFF)) return false;
+    // a sequence never expands to more than 255 bytes per input byte, so reject sizes from corrupt headers early
+    if (codec == Lz4Compression && quint64(size) > quint64(body.size()) * 255) return false;
+#ifdef LEMON_ZSTD
+    if (codec == ZstdCompression) {
+        if (ZSTD_getFrameContentSize(body.constData() + 4, body.size() - 4) != size) return false;
+        data.resize(int(size));
+        return ZSTD_decompress(data.data(), data.size(), body.constData() + 4, body.size() - 4) == size;
+    }
+#endif
+    data.resize(int(size));
+    return lz4Uncompress(reinterpret_cast<const uchar*>(body.constData()) + 4, body.size() - 4,
+                         reinterpret_cast<uchar*>(data.data()), data.size());
+}
+
+QByteArray ContestFile::packBlock(const QByteArray &data, int codec, int level)
+{
+    QByteArray payload = compress(data, codec, level), block;
+    QDataStream out(&block, QIODevice::WriteOnly);
+    out << quint64(payload.size()) << checksum(payload);
+    return block.append(payload);
+}
+
+bool ContestFile::writeBlock(QIODevice *device, const QByteArray &data, int codec, int level)
+{
+    QByteArray block = packBlock(data, codec, level);
+    return device->write(block) == block.size();
+}
+
+bool ContestFile::readBlock(QIODevice *device, QByteArray &data, bool tagged)
+{
+    QDataStream in(device);
+    quint64 length;
+    quint32 crc;
+    in >> length >> crc;
+    if (in.status() != QDataStream::Ok) return false;
+    if (length > quint64(device->size() - device->pos()) || length > quint64(0x7FFFFFFF)) return false;
+    
+    QByteArray compressed(int(length), 0);
+    if (in.readRawData(compressed.data(), int(length)) != int(length)) return false;
+    if (checksum(compressed) != crc) return false;
+    if (tagged) return uncompress(compressed, data);
+    data = qUncompress(compressed);
+    return true;
+}
+
+bool ContestFile::readBlock(const QString &fileName, qint64 offset, QByteArray &data)
+{
+    QFile file(fileName);
+    if (! file.open(QFile::ReadOnly)) return false;
+    QDataStream in(&file);
+    unsigned checkNumber;
+    in >> checkNumber;
+    if (in.status() != QDataStream::Ok || ! file.seek(offset)) return false;
+    return readBlock(&file, data, checkNumber == unsigned(CodecMagicNumber));
+}
+
+qint64 ContestFile::blockSize(QIODevice *device, qint64 offset)
+{
+    if (offset < 0 || ! device->seek(offset)) return 0;
+    QDataStream in(device);
+    quint64 length;
+    quint32 crc;
+    in >> length >> crc;
+    if (in.status() != QDataStream::Ok) return 0;
+    return qint64(sizeof(length) + sizeof(crc) + length);
+}
+
+bool ContestFile::readRawBlock(QIODevice *device, qint64 offset, QByteArray &block)
+{
+    const int headerSize = sizeof(quint64) + sizeof(quint32);
+    qint64 size = blockSize(device, offset);
+    if (size < headerSize || size > qint64(0x7FFFFFFF) || ! device->seek(offset)) return false;
+    block = device->read(size);
+    if (block.size() != size) return false;
+    QDataStream in(block);
+    quint64 length;
+    quint32 crc;
+    in >> length >> crc;
+    return checksum(block.mid(headerSize)) == crc;
+}
+
+bool ContestFile::sync(QFile *file)
+{
+    if (! file->flush()) return false;
+#ifdef Q_OS_WIN32
+    return FlushFileBuffers((HANDLE)_get_osfhandle(file->handle()));
+#endif
+#ifdef Q_OS_LINUX
+    return fsync(file->handle()) == 0;
+#endif
+    return true;
+}
+
+bool ContestFile::replaceFile(const QString &source, const QString &target)
+{
+#ifdef Q_OS_WIN32
+    return MoveFileExW((LPCWSTR)QDir::toNativeSeparators(source).utf16(),
+                       (LPCWSTR)QDir::toNativeSeparators(target).utf16(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#endif
+#ifdef Q_OS_LINUX
+    return rename(QFile::encodeName(source).constData(), QFile::encodeName(target).constData()) == 0;
+#endif
+    QFile::remove(target);
+    return QFile::rename(source, target);
+}
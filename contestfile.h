@@ -0,0 +1,42 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef CONTESTFILE_H
+#define CONTESTFILE_H
+
+#include <QtCore>
+#include "globaltype.h"
+
+class ContestFile
+{
+public:
+    static quint32 checksum(const QByteArray&);
+    static bool isCodecAvailable(int);
+    static QByteArray compress(const QByteArray&, int, int);
+    static bool uncompress(const QByteArray&, QByteArray&);
+    static QByteArray packBlock(const QByteArray&, int, int);
+    static bool writeBlock(QIODevice*, const QByteArray&, int, int);
+    static bool readBlock(QIODevice*, QByteArray&, bool);
+    static bool readBlock(const QString&, qint64, QByteArray&);
+    static qint64 blockSize(QIODevice*, qint64);
+    static bool readRawBlock(QIODevice*, qint64, QByteArray&);
+    static bool sync(QFile*);
+    static bool replaceFile(const QString&, const QString&);
+};
+
+#endif // CONTESTFILE_H
@@ -0,0 +1,214 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include <QtCore>
+#include <QtTest>
+#include "contestfile.h"
+#include "globaltype.h"
+
+static QByteArray sampleText(int lines)
+{
+    QByteArray data;
+    qsrand(1);
+    for (int i = 0; i < lines; i ++) {
+        data.append(QString("case %1 score %2 ").arg(qrand() % 997).arg(qrand() % 100).toLatin1());
+        data.append(qrand() % 5 ? "Correct\n" : "Wrong answer on line 3\n");
+    }
+    return data;
+}
+
+static QByteArray randomData(int size)
+{
+    QByteArray data(size, 0);
+    qsrand(2);
+    for (int i = 0; i < size; i ++)
+        data[i] = char(qrand());
+    return data;
+}
+
+static QByteArray lz4Payload(quint32 size, const QByteArray &sequences)
+{
+    QByteArray payload;
+    payload.append(char(Lz4Compression)).append(char(1));
+    QDataStream out(&payload, QIODevice::WriteOnly | QIODevice::Append);
+    out << size;
+    return payload.append(sequences);
+}
+
+class ContestFileTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void levelIsHonoured();
+    void unavailableCodecFallsBack();
+    void truncatedInput_data();
+    void truncatedInput();
+    void corruptedInput();
+    void malformedLz4_data();
+    void malformedLz4();
+    void corruptedBlock();
+};
+
+void ContestFileTest::roundTrip_data()
+{
+    QTest::addColumn<int>("codec");
+    QTest::addColumn<int>("level");
+    QTest::addColumn<QByteArray>("data");
+    
+    QList<QByteArray> inputs;
+    QStringList names;
+    inputs << QByteArray() << QByteArray("a") << QByteArray(100000, 'a') << sampleText(20000)
+           << randomData(70000) << randomData(300) + sampleText(200) + randomData(300) + QByteArray(1000, 'x');
+    names << "empty" << "one byte" << "one run" << "text" << "random" << "mixed";
+    QList<int> codecs;
+    codecs << NoCompression << ZlibCompression << Lz4Compression << ZstdCompression;
+    QList<int> levels;
+    levels << 1 << 6 << 9;
+    for (int i = 0; i < codecs.size(); i ++) {
+        if (! ContestFile::isCodecAvailable(codecs[i])) continue;
+        for (int j = 0; j < levels.size(); j ++)
+            for (int k = 0; k < inputs.size(); k ++) {
+                QString name = QString("codec %1, level %2, %3").arg(codecs[i]).arg(levels[j]).arg(names[k]);
+                QTest::newRow(name.toLatin1().constData()) << codecs[i] << levels[j] << inputs[k];
+            }
+    }
+}
+
+void ContestFileTest::roundTrip()
+{
+    QFETCH(int, codec);
+    QFETCH(int, level);
+    QFETCH(QByteArray, data);
+    
+    QByteArray payload = ContestFile::compress(data, codec, level), result;
+    QCOMPARE(int(uchar(payload[0])), codec);
+    QVERIFY(ContestFile::uncompress(payload, result));
+    QCOMPARE(result, data);
+}
+
+void ContestFileTest::levelIsHonoured()
+{
+    QByteArray data = sampleText(50000);
+    QList<int> codecs;
+    codecs << ZlibCompression << Lz4Compression << ZstdCompression;
+    for (int i = 0; i < codecs.size(); i ++) {
+        if (! ContestFile::isCodecAvailable(codecs[i])) continue;
+        QByteArray fast = ContestFile::compress(data, codecs[i], 1);
+        QByteArray small = ContestFile::compress(data, codecs[i], 9);
+        QVERIFY(small.size() < fast.size());
+        QCOMPARE(int(uchar(small[1])), 9);
+    }
+}
+
+void ContestFileTest::unavailableCodecFallsBack()
+{
+    QByteArray data = sampleText(100), result;
+    if (! ContestFile::isCodecAvailable(ZstdCompression)) {
+        QByteArray payload = ContestFile::compress(data, ZstdCompression, 6);
+        QCOMPARE(int(uchar(payload[0])), int(Lz4Compression));
+        QVERIFY(ContestFile::uncompress(payload, result));
+        QCOMPARE(result, data);
+        payload[0] = char(ZstdCompression);
+        QVERIFY(! ContestFile::uncompress(payload, result));
+    }
+    QByteArray payload = ContestFile::compress(data, Lz4Compression, 6);
+    payload[0] = char(200);
+    QVERIFY(! ContestFile::uncompress(payload, result));
+    QVERIFY(! ContestFile::uncompress(QByteArray(1, char(Lz4Compression)), result));
+}
+
+void ContestFileTest::truncatedInput_data()
+{
+    QTest::addColumn<int>("codec");
+    QList<int> codecs;
+    codecs << ZlibCompression << Lz4Compression << ZstdCompression;
+    for (int i = 0; i < codecs.size(); i ++)
+        if (ContestFile::isCodecAvailable(codecs[i]))
+            QTest::newRow(QString("codec %1").arg(codecs[i]).toLatin1().constData()) << codecs[i];
+}
+
+void ContestFileTest::truncatedInput()
+{
+    QFETCH(int, codec);
+    QByteArray payload = ContestFile::compress(sampleText(200), codec, 6), result;
+    int step = codec == ZlibCompression ? qMax(payload.size() / 16, 1) : 1;
+    for (int length = 2; length < payload.size(); length += step)
+        QVERIFY(! ContestFile::uncompress(payload.left(length), result));
+}
+
+void ContestFileTest::corruptedInput()
+{
+    QByteArray data = sampleText(500), result;
+    QByteArray payload = ContestFile::compress(data, Lz4Compression, 9);
+    qsrand(3);
+    for (int i = 0; i < 5000; i ++) {
+        QByteArray corrupted = payload;
+        int index = 2 + qrand() % (payload.size() - 2);
+        corrupted[index] = char(corrupted[index] ^ (1 << (qrand() % 8)));
+        if (ContestFile::uncompress(corrupted, result))
+            QCOMPARE(result.size(), data.size());
+    }
+}
+
+void ContestFileTest::malformedLz4_data()
+{
+    QTest::addColumn<QByteArray>("payload");
+    QTest::newRow("zero offset") << lz4Payload(5, QByteArray("\x10" "a\x00\x00", 4));
+    QTest::newRow("offset before start") << lz4Payload(5, QByteArray("\x10" "a\x02\x00", 4));
+    QTest::newRow("literals past input") << lz4Payload(40, QByteArray("\xF0\x0A" "abc", 5));
+    QTest::newRow("literals past output") << lz4Payload(2, QByteArray("\x30" "abc", 4));
+    QTest::newRow("match past output") << lz4Payload(5, QByteArray("\x1F" "a\x01\x00\x05", 5));
+    QTest::newRow("unterminated length") << lz4Payload(1000, QByteArray("\xF0\xFF\xFF", 3));
+    QTest::newRow("missing offset") << lz4Payload(5, QByteArray("\x10" "a\x01", 3));
+    QTest::newRow("output too short") << lz4Payload(10, QByteArray("\x30" "abc", 4));
+    QTest::newRow("huge size") << lz4Payload(0x7FFFFFF0u, QByteArray("\x10" "a\x01\x00", 4));
+    QTest::newRow("size over limit") << lz4Payload(0x80000000u, QByteArray("\x10" "a\x01\x00", 4));
+}
+
+void ContestFileTest::malformedLz4()
+{
+    QFETCH(QByteArray, payload);
+    QByteArray result;
+    QVERIFY(! ContestFile::uncompress(payload, result));
+}
+
+void ContestFileTest::corruptedBlock()
+{
+    QByteArray data = sampleText(100), result;
+    QByteArray block = ContestFile::packBlock(data, Lz4Compression, 6);
+    QBuffer buffer(&block);
+    buffer.open(QIODevice::ReadOnly);
+    QVERIFY(ContestFile::readBlock(&buffer, result, true));
+    QCOMPARE(result, data);
+    buffer.close();
+    
+    block[block.size() / 2] = char(block[block.size() / 2] ^ 1);
+    buffer.open(QIODevice::ReadOnly);
+    QVERIFY(! ContestFile::readBlock(&buffer, result, true));
+}
+
+int runContestFileTest(int argc, char *argv[])
+{
+    ContestFileTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "contestfiletest.moc"
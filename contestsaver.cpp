@@ -0,0 +1,295 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "contestsaver.h"
+#include "contestfile.h"
+#include "contest.h"
+#include "contestant.h"
+#include <QtConcurrentMap>
+
+class BlockPacker
+{
+public:
+    typedef QByteArray result_type;
+    
+    BlockPacker(int _codec, int _level) : codec(_codec), level(_level) {}
+    QByteArray operator()(const QByteArray &data) const
+    {
+        return data.isEmpty() ? QByteArray() : ContestFile::packBlock(data, codec, level);
+    }
+
+private:
+    int codec;
+    int level;
+};
+
+ContestSaver::ContestSaver(QObject *parent) :
+    QThread(parent)
+{
+    sourceDirectoryOffset = -1;
+    sourceTaskOffset = -1;
+    taskChanged = true;
+    garbageBytes = 0;
+    codec = Lz4Compression;
+    level = 0;
+    saved = false;
+    appended = false;
+    taskOffset = -1;
+    directoryOffset = -1;
+}
+
+ContestSaver::~ContestSaver()
+{
+    qDeleteAll(snapshotList);
+}
+
+void ContestSaver::setFileName(const QString &_fileName)
+{
+    fileName = _fileName;
+}
+
+void ContestSaver::setSourceFile(const QString &_sourceFile, qint64 directoryOffset)
+{
+    sourceFile = _sourceFile;
+    sourceDirectoryOffset = directoryOffset;
+}
+
+void ContestSaver::setTaskData(const QByteArray &data, qint64 offset, bool changed)
+{
+    taskData = data;
+    sourceTaskOffset = offset;
+    taskChanged = changed;
+}
+
+void ContestSaver::setCompression(int _codec, int _level)
+{
+    codec = _codec;
+    level = _level;
+}
+
+void ContestSaver::setGarbageBytes(qint64 bytes)
+{
+    garbageBytes = bytes;
+}
+
+void ContestSaver::setReleasedOffsets(const QList<qint64> &offsets)
+{
+    releasedOffsets = offsets;
+}
+
+void ContestSaver::addContestant(Contestant *snapshot, bool writeDetails, qint64 offset)
+{
+    snapshotList.append(snapshot);
+    writeDetailsList.append(writeDetails);
+    sourceOffsets.append(offset);
+}
+
+const QString& ContestSaver::getFileName() const
+{
+    return fileName;
+}
+
+bool ContestSaver::getSaved() const
+{
+    return saved;
+}
+
+bool ContestSaver::getAppended() const
+{
+    return appended;
+}
+
+qint64 ContestSaver::getTaskOffset() const
+{
+    return taskOffset;
+}
+
+qint64 ContestSaver::getDirectoryOffset() const
+{
+    return directoryOffset;
+}
+
+qint64 ContestSaver::getGarbageBytes() const
+{
+    return garbageBytes;
+}
+
+const QList<qint64>& ContestSaver::getDetailsOffsets() const
+{
+    return detailsOffsets;
+}
+
+const QStringList& ContestSaver::getBrokenContestants() const
+{
+    return brokenContestants;
+}
+
+QString ContestSaver::temporaryFileName(const QString &fileName)
+{
+    return fileName + ".saving";
+}
+
+bool ContestSaver::save()
+{
+    appended = false;
+    saved = false;
+    if (! serializeContestants()) return false;
+    saved = sourceFile == fileName && appendToFile();
+    if (saved) {
+        appended = true;
+        return true;
+    }
+    saved = rewriteFile();
+    if (! saved) QFile::remove(temporaryFileName(fileName));
+    return saved;
+}
+
+void ContestSaver::run()
+{
+    save();
+}
+
+bool ContestSaver::serializeContestants()
+{
+    for (int i = 0; i < snapshotList.size(); i ++) {
+        QByteArray summary, details;
+        if (writeDetailsList[i]) {
+            QDataStream detailsOut(&details, QIODevice::WriteOnly);
+            snapshotList[i]->writeDetailsToStream(detailsOut);
+            // details that cannot be read back must not be replaced by the reset ones
+            if (snapshotList[i]->isDetailsBroken())
+                brokenContestants.append(snapshotList[i]->getContestantName());
+        }
+        QDataStream summaryOut(&summary, QIODevice::WriteOnly);
+        snapshotList[i]->writeSummaryToStream(summaryOut);
+        summaryList.append(summary);
+        detailsList.append(details);
+        delete snapshotList[i];
+    }
+    snapshotList.clear();
+    return brokenContestants.isEmpty();
+}
+
+bool ContestSaver::appendToFile()
+{
+    QFile file(fileName);
+    if (! file.open(QFile::ReadWrite)) return false;
+    QDataStream in(&file);
+    unsigned checkNumber;
+    in >> checkNumber;
+    if (checkNumber != unsigned(CodecMagicNumber)) return false;
+    
+    qint64 garbage = garbageBytes + ContestFile::blockSize(&file, sourceDirectoryOffset);
+    if (taskChanged) garbage += ContestFile::blockSize(&file, sourceTaskOffset);
+    for (int i = 0; i < detailsList.size(); i ++)
+        if (! detailsList[i].isEmpty())
+            garbage += ContestFile::blockSize(&file, sourceOffsets[i]);
+    for (int i = 0; i < releasedOffsets.size(); i ++)
+        garbage += ContestFile::blockSize(&file, releasedOffsets[i]);
+    if (garbage * 2 > file.size()) return false;
+    
+    if (! file.seek(file.size())) return false;
+    taskOffset = sourceTaskOffset;
+    if (taskChanged) {
+        taskOffset = file.pos();
+        if (! ContestFile::writeBlock(&file, taskData, codec, level)) return false;
+    }
+    if (! writeContestants(file, 0)) return false;
+    
+    garbageBytes = garbage;
+    if (! writeDirectory(file)) return false;
+    file.close();
+    return true;
+}
+
+bool ContestSaver::rewriteFile()
+{
+    QFile source(sourceFile);
+    if (! sourceFile.isEmpty() && ! source.open(QFile::ReadOnly)) return false;
+    QFile file(temporaryFileName(fileName));
+    if (! file.open(QFile::WriteOnly)) return false;
+    QDataStream out(&file);
+    out << unsigned(CodecMagicNumber) << qint64(0) << quint8(codec) << quint8(level);
+    
+    taskOffset = file.pos();
+    if (! ContestFile::writeBlock(&file, taskData, codec, level)) return false;
+    if (! writeContestants(file, &source)) return false;
+    
+    garbageBytes = 0;
+    if (! writeDirectory(file)) return false;
+    file.close();
+    return true;
+}
+
+bool ContestSaver::writeContestants(QFile &file, QFile *source)
+{
+    bool sourceTagged = false;
+    if (source && source->isOpen()) {
+        QDataStream in(source);
+        unsigned checkNumber;
+        in >> checkNumber;
+        sourceTagged = checkNumber == unsigned(CodecMagicNumber);
+    }
+    
+    // compress a few blocks per processor at a time so that memory use stays bounded
+    int batchSize = qMax(QThread::idealThreadCount(), 1) * 4;
+    detailsOffsets.clear();
+    for (int start = 0; start < detailsList.size(); start += batchSize) {
+        QList<QByteArray> blockList = QtConcurrent::blockingMapped(detailsList.mid(start, batchSize),
+                                                                   BlockPacker(codec, level));
+        for (int i = 0; i < blockList.size(); i ++) {
+            qint64 offset = sourceOffsets[start + i];
+            if (blockList[i].isEmpty() && ! source) {
+                detailsOffsets.append(offset);
+                continue;
+            }
+            if (blockList[i].isEmpty()) {
+                if (! source->isOpen()) return false;
+                if (sourceTagged) {
+                    if (! ContestFile::readRawBlock(source, offset, blockList[i])) return false;
+                } else {
+                    QByteArray data;
+                    if (! source->seek(offset) || ! ContestFile::readBlock(source, data, false)) return false;
+                    blockList[i] = ContestFile::packBlock(data, codec, level);
+                }
+            }
+            detailsOffsets.append(file.pos());
+            if (file.write(blockList[i]) != blockList[i].size()) return false;
+        }
+    }
+    return true;
+}
+
+bool ContestSaver::writeDirectory(QFile &file)
+{
+    QByteArray directory;
+    QDataStream directoryOut(&directory, QIODevice::WriteOnly);
+    directoryOut << taskOffset << summaryList.size();
+    for (int i = 0; i < summaryList.size(); i ++) {
+        directoryOut << detailsOffsets[i];
+        directoryOut.writeRawData(summaryList[i].constData(), summaryList[i].size());
+    }
+    directoryOut << garbageBytes;
+    
+    directoryOffset = file.pos();
+    if (! ContestFile::writeBlock(&file, directory, codec, level) || ! ContestFile::sync(&file)) return false;
+    QDataStream out(&file);
+    if (! file.seek(sizeof(unsigned))) return false;
+    out << directoryOffset << quint8(codec) << quint8(level);
+    return out.status() == QDataStream::Ok && ContestFile::sync(&file);
+}
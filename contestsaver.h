@@ -0,0 +1,82 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef CONTESTSAVER_H
+#define CONTESTSAVER_H
+
+#include <QtCore>
+#include <QThread>
+#include "globaltype.h"
+
+class Contestant;
+
+class ContestSaver : public QThread
+{
+    Q_OBJECT
+public:
+    explicit ContestSaver(QObject *parent = 0);
+    ~ContestSaver();
+    void setFileName(const QString&);
+    void setSourceFile(const QString&, qint64);
+    void setTaskData(const QByteArray&, qint64, bool);
+    void setCompression(int, int);
+    void setGarbageBytes(qint64);
+    void setReleasedOffsets(const QList<qint64>&);
+    void addContestant(Contestant*, bool, qint64);
+    const QString& getFileName() const;
+    bool getSaved() const;
+    bool getAppended() const;
+    qint64 getTaskOffset() const;
+    qint64 getDirectoryOffset() const;
+    qint64 getGarbageBytes() const;
+    const QList<qint64>& getDetailsOffsets() const;
+    const QStringList& getBrokenContestants() const;
+    static QString temporaryFileName(const QString&);
+    bool save();
+    void run();
+
+private:
+    QString fileName;
+    QString sourceFile;
+    qint64 sourceDirectoryOffset;
+    QByteArray taskData;
+    qint64 sourceTaskOffset;
+    bool taskChanged;
+    qint64 garbageBytes;
+    int codec;
+    int level;
+    QList<qint64> releasedOffsets;
+    QList<Contestant*> snapshotList;
+    QList<bool> writeDetailsList;
+    QList<QByteArray> summaryList;
+    QList<QByteArray> detailsList;
+    QList<qint64> sourceOffsets;
+    bool saved;
+    bool appended;
+    qint64 taskOffset;
+    qint64 directoryOffset;
+    QList<qint64> detailsOffsets;
+    QStringList brokenContestants;
+    bool serializeContestants();
+    bool appendToFile();
+    bool rewriteFile();
+    bool writeContestants(QFile&, QFile*);
+    bool writeDirectory(QFile&);
+};
+
+#endif // CONTESTSAVER_H
@@ -0,0 +1,259 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include <QtCore>
+#include <QtTest>
+#include "contest.h"
+#include "contestant.h"
+#include "contestfile.h"
+#include "fileutility.h"
+#include "settings.h"
+#include "task.h"
+#include "globaltype.h"
+
+class ContestSaverTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString oldDirectory;
+    QString directory;
+    Settings settings;
+    Contest* createContest(const QStringList&);
+    void fillContestant(Contestant*, int);
+    QMap<QString, QByteArray> getContents(Contest*);
+    QMap<QString, int> getScores(Contest*);
+    Contest* loadContest(const QString&);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void roundTrip_data();
+    void roundTrip();
+};
+
+Contest* ContestSaverTest::createContest(const QStringList &nameList)
+{
+    FileUtility::clearPath(Settings::sourcePath());
+    for (int i = 0; i < nameList.size(); i ++)
+        QDir().mkpath(Settings::sourcePath() + nameList[i]);
+    
+    Contest *contest = new Contest();
+    contest->setSettings(&settings);
+    contest->setJournalEnabled(false);
+    contest->setContestTitle("Round trip");
+    for (int i = 0; i < 2; i ++) {
+        Task *task = new Task();
+        task->setProblemTitle(QString("task%1").arg(i));
+        task->setSourceFileName(QString("task%1").arg(i));
+        contest->addTask(task);
+    }
+    contest->refreshContestantList();
+    QList<Contestant*> contestantList = contest->getContestantList();
+    for (int i = 0; i < contestantList.size(); i ++)
+        fillContestant(contestantList[i], i);
+    return contest;
+}
+
+void ContestSaverTest::fillContestant(Contestant *contestant, int seed)
+{
+    for (int i = 0; i < 2; i ++) {
+        QList< QList<ResultState> > result;
+        QList< QList<int> > score, timeUsed, memoryUsed;
+        QList<QStringList> inputFiles, message;
+        for (int j = 0; j < 3; j ++) {
+            result.append(QList<ResultState>());
+            score.append(QList<int>());
+            timeUsed.append(QList<int>());
+            memoryUsed.append(QList<int>());
+            inputFiles.append(QStringList());
+            message.append(QStringList());
+            for (int k = 0; k <= (seed + j) % 3; k ++) {
+                bool correct = (seed + i + j + k) % 4 != 0;
+                result[j].append(correct ? CorrectAnswer : WrongAnswer);
+                score[j].append(correct ? 10 : 0);
+                timeUsed[j].append(seed * 100 + j * 10 + k);
+                memoryUsed[j].append((seed + 1) * 1024 * (k + 1));
+                inputFiles[j].append(QString("task%1_%2_%3.in").arg(i).arg(j).arg(k));
+                message[j].append(correct ? QString() : QString("Read %1, expect %2").arg(seed).arg(k));
+            }
+        }
+        contestant->setCheckJudged(i, true);
+        contestant->setCompileState(i, CompileSuccessfully);
+        contestant->setSourceFile(i, QString("task%1.cpp").arg(i));
+        contestant->setCompileMessage(i, QString("warning %1").arg(seed));
+        contestant->setInputFiles(i, inputFiles);
+        contestant->setResult(i, result);
+        contestant->setScore(i, score);
+        contestant->setTimeUsed(i, timeUsed);
+        contestant->setMemoryUsed(i, memoryUsed);
+        contestant->setMessage(i, message);
+    }
+    contestant->setJudgingTime(QDateTime(QDate(2012, 11, 27), QTime(9, 0)).addSecs(seed));
+}
+
+QMap<QString, QByteArray> ContestSaverTest::getContents(Contest *contest)
+{
+    QMap<QString, QByteArray> contents;
+    QList<Contestant*> contestantList = contest->getContestantList();
+    for (int i = 0; i < contestantList.size(); i ++) {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        contestantList[i]->writeToStream(out);
+        contents.insert(contestantList[i]->getContestantName(), data);
+    }
+    return contents;
+}
+
+QMap<QString, int> ContestSaverTest::getScores(Contest *contest)
+{
+    QMap<QString, int> scores;
+    QList<Contestant*> contestantList = contest->getContestantList();
+    for (int i = 0; i < contestantList.size(); i ++)
+        scores.insert(contestantList[i]->getContestantName(), contestantList[i]->getTotalScore());
+    return scores;
+}
+
+Contest* ContestSaverTest::loadContest(const QString &fileName)
+{
+    Contest *contest = new Contest();
+    contest->setSettings(&settings);
+    contest->setJournalEnabled(false);
+    if (contest->loadFromFile(fileName) != ContestFileLoaded) {
+        delete contest;
+        return 0;
+    }
+    return contest;
+}
+
+void ContestSaverTest::initTestCase()
+{
+    settings.setResultDatabaseEnabled(false);
+    oldDirectory = QDir::currentPath();
+    directory = QDir::tempPath() + QDir::separator()
+                + QString("lemon-savertest-%1").arg(QCoreApplication::applicationPid());
+    QVERIFY(QDir().mkpath(directory));
+    QVERIFY(QDir::setCurrent(directory));
+}
+
+void ContestSaverTest::cleanupTestCase()
+{
+    QDir::setCurrent(oldDirectory);
+    FileUtility::clearPath(directory + QDir::separator());
+    QDir().rmdir(directory);
+}
+
+void ContestSaverTest::roundTrip_data()
+{
+    QTest::addColumn<int>("codec");
+    
+    QTest::newRow("none") << int(NoCompression);
+    QTest::newRow("zlib") << int(ZlibCompression);
+    QTest::newRow("lz4") << int(Lz4Compression);
+    if (ContestFile::isCodecAvailable(ZstdCompression))
+        QTest::newRow("zstd") << int(ZstdCompression);
+}
+
+void ContestSaverTest::roundTrip()
+{
+    QFETCH(int, codec);
+    settings.setCompressionCodec(codec);
+    settings.setCompressionLevel(3);
+    QString firstFile = QString("first-%1.cdf").arg(codec);
+    QString secondFile = QString("second-%1.cdf").arg(codec);
+    
+    QStringList nameList;
+    nameList << "alice" << "bob" << "carol" << "dave" << "eve" << "frank";
+    Contest *contest = createContest(nameList);
+    QMap<QString, QByteArray> contents = getContents(contest);
+    QMap<QString, int> scores = getScores(contest);
+    QCOMPARE(contents.size(), nameList.size());
+    
+    // a new file is always rewritten from scratch
+    QVERIFY(contest->saveToFile(firstFile));
+    Contest *loaded = loadContest(firstFile);
+    QVERIFY(loaded);
+    QVERIFY(loaded->hasSameTasks(contest));
+    QCOMPARE(loaded->getContestTitle(), QString("Round trip"));
+    QCOMPARE(getScores(loaded), scores);
+    QCOMPARE(getContents(loaded), contents);
+    delete loaded;
+    
+    // changing one contestant appends its details and a new directory, leaving the old blocks alone
+    QFile file(firstFile);
+    QVERIFY(file.open(QFile::ReadOnly));
+    QByteArray before = file.readAll();
+    file.close();
+    QByteArray unchanged = contents.value("bob");
+    Contestant *changed = contest->getContestant("bob");
+    changed->setCaseResult(0, 0, 0, TimeLimitExceeded, 0);
+    changed->setCaseUsage(0, 0, 0, 1500, 2048, 1);
+    QVERIFY(contest->saveToFile(firstFile));
+    QVERIFY(file.open(QFile::ReadOnly));
+    QByteArray after = file.readAll();
+    file.close();
+    QVERIFY(after.size() > before.size());
+    QVERIFY(after.mid(14, before.size() - 14) == before.mid(14));
+    
+    contents = getContents(contest);
+    scores = getScores(contest);
+    QVERIFY(contents.value("bob") != unchanged);
+    loaded = loadContest(firstFile);
+    QVERIFY(loaded);
+    QCOMPARE(getScores(loaded), scores);
+    QCOMPARE(getContents(loaded), contents);
+    QCOMPARE(loaded->getContestant("bob")->getResult(0)[0][0], TimeLimitExceeded);
+    
+    // saving elsewhere rewrites the file, copying the unchanged blocks from the loaded one
+    QVERIFY(loaded->saveToFile(secondFile));
+    delete loaded;
+    loaded = loadContest(secondFile);
+    QVERIFY(loaded);
+    QCOMPARE(getScores(loaded), scores);
+    QCOMPARE(getContents(loaded), contents);
+    
+    // deleting contestants releases their blocks until the file is compacted by a rewrite
+    qint64 previousSize = QFileInfo(secondFile).size();
+    loaded->deleteContestant("alice");
+    loaded->deleteContestant("carol");
+    loaded->deleteContestant("dave");
+    loaded->deleteContestant("eve");
+    QVERIFY(loaded->saveToFile(secondFile));
+    QVERIFY(QFileInfo(secondFile).size() < previousSize);
+    delete loaded;
+    contents.remove("alice");
+    contents.remove("carol");
+    contents.remove("dave");
+    contents.remove("eve");
+    loaded = loadContest(secondFile);
+    QVERIFY(loaded);
+    QCOMPARE(getContents(loaded), contents);
+    delete loaded;
+    
+    delete contest;
+    QFile::remove(firstFile);
+    QFile::remove(secondFile);
+}
+
+int runContestSaverTest(int argc, char *argv[])
+{
+    ContestSaverTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "contestsavertest.moc"
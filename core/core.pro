@@ -0,0 +1,83 @@
+#
+#    Project Lemon - A tiny judging environment for OI contest
+#    Copyright (C) 2011 Zhipeng Jia
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+QT       += core network sql
+QT       -= gui
+
+TARGET = lemoncore
+TEMPLATE = lib
+CONFIG += staticlib
+DESTDIR = ../lib
+
+SOURCES += ../contest.cpp \
+    ../task.cpp \
+    ../taskresult.cpp \
+    ../testcase.cpp \
+    ../settings.cpp \
+    ../compiler.cpp \
+    ../contestant.cpp \
+    ../messagepool.cpp \
+    ../fileutility.cpp \
+    ../contestfile.cpp \
+    ../contestsaver.cpp \
+    ../judgingthread.cpp \
+    ../assignmentthread.cpp \
+    ../processorpool.cpp \
+    ../compilethread.cpp \
+    ../compilepool.cpp \
+    ../concurrencycontroller.cpp \
+    ../cancellationtoken.cpp \
+    ../judgingcontroller.cpp \
+    ../completionring.cpp \
+    ../remoteconnection.cpp \
+    ../remoteworker.cpp \
+    ../submissionwatcher.cpp \
+    ../resultjournal.cpp \
+    ../resultdatabase.cpp \
+    ../resultexporter.cpp
+
+HEADERS  += ../contest.h \
+    ../task.h \
+    ../taskresult.h \
+    ../testcase.h \
+    ../settings.h \
+    ../compiler.h \
+    ../contestant.h \
+    ../messagepool.h \
+    ../fileutility.h \
+    ../contestfile.h \
+    ../contestsaver.h \
+    ../judgingthread.h \
+    ../assignmentthread.h \
+    ../globaltype.h \
+    ../processorpool.h \
+    ../compilethread.h \
+    ../compilepool.h \
+    ../concurrencycontroller.h \
+    ../cancellationtoken.h \
+    ../judgingcontroller.h \
+    ../completionring.h \
+    ../remoteconnection.h \
+    ../remoteworker.h \
+    ../submissionwatcher.h \
+    ../resultjournal.h \
+    ../resultdatabase.h \
+    ../resultexporter.h
+
+# build with "qmake CONFIG+=zstd" to offer zstd compression for contest files
+zstd:DEFINES += LEMON_ZSTD
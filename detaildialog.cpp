@@ -39,179 +39,6 @@ DetailDialog::~DetailDialog()
     delete ui;
 }
 
-QString DetailDialog::getCode(Contest *contest, Contestant *contestant)
-{
-    QString htmlCode;
-    
-    QList<Task*> taskList = contest->getTaskList();
-    for (int i = 0; i < taskList.size(); i ++) {
-        htmlCode += "<p><span style=\"font-weight:bold; font-size:large;\">";
-        htmlCode += QString("%1 %2</span><br>").arg(tr("Task")).arg(taskList[i]->getProblemTile());
-        
-        if (! contestant->getCheckJudged(i)) {
-            htmlCode += QString("&nbsp;&nbsp;%1</p>").arg(tr("Not judged"));
-            continue;
-        }
-        
-        if (taskList[i]->getTaskType() == Task::Traditional) {
-            if (contestant->getCompileState(i) != CompileSuccessfully) {
-                switch (contestant->getCompileState(i)) {
-                    case NoValidSourceFile: {
-                        htmlCode += QString("&nbsp;&nbsp;%1</p>").arg(tr("Cannot find valid source file"));
-                        break;
-                    }
-                    case CompileTimeLimitExceeded: {
-                        htmlCode += QString("&nbsp;&nbsp;%1%2<br>").arg(tr("Source file: "))
-                                    .arg(contestant->getSourceFile(i));
-                        htmlCode += QString("&nbsp;&nbsp;%1</p>").arg(tr("Compile time limit exceeded"));
-                        break;
-                    }
-                    case InvalidCompiler: {
-                        htmlCode += QString("&nbsp;&nbsp;%1</p>").arg(tr("Cannot run given compiler"));
-                        break;
-                    }
-                    case CompileError: {
-                        htmlCode += QString("&nbsp;&nbsp;%1%2<br>").arg(tr("Source file: "))
-                                    .arg(contestant->getSourceFile(i));
-                        htmlCode += QString("&nbsp;&nbsp;%1").arg(tr("Compile error"));
-                        if (! contestant->getCompileMessage(i).isEmpty()) {
-                            QString compileMessage = contestant->getCompileMessage(i);
-                            compileMessage.replace("\r\n", "<br>");
-                            compileMessage.replace("\n", "<br>");
-                            compileMessage.replace("\r", "<br>");
-                            if (compileMessage.endsWith("<br>"))
-                                compileMessage.chop(4);
-                            htmlCode += "<table border=\"1\" cellpadding=\"1\">";
-                            htmlCode += "<tr><td style=\"padding: 0.5em\"><code>";
-                            htmlCode += compileMessage;
-                            htmlCode += "</code></td></tr></table>";
-                        }
-                        htmlCode += "</p>";
-                        break;
-                    }
-                }
-                continue;
-            }
-            htmlCode += QString("&nbsp;&nbsp;%1%2").arg(tr("Source file: ")).arg(contestant->getSourceFile(i));
-        }
-        
-        htmlCode += "<table border=\"1\" cellpadding=\"1\"><tr>";
-        htmlCode += QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th>").arg(tr("Test Case"));
-        htmlCode += QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th>").arg(tr("Input File"));
-        htmlCode += QString("<th scope=\"col\">%1</th>").arg(tr("Result"));
-        htmlCode += QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th>").arg(tr("Time Used"));
-        htmlCode += QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th>").arg(tr("Memory Used"));
-        htmlCode += QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th></tr>").arg(tr("Score"));
-        
-        QList<QStringList> inputFiles = contestant->getInputFiles(i);
-        QList< QList<ResultState> > result = contestant->getResult(i);
-        QList<QStringList> message = contestant->getMessage(i);
-        QList< QList<int> > timeUsed = contestant->getTimeUsed(i);
-        QList< QList<int> > memoryUsed = contestant->getMemoryUsed(i);
-        QList< QList<int> > score = contestant->getSocre(i);
-        
-        for (int j = 0; j < inputFiles.size(); j ++) {
-            for (int k = 0; k < inputFiles[j].size(); k ++) {
-                htmlCode += "<tr>";
-                if (k == 0) {
-                    htmlCode += QString("<td nowrap=\"nowrap\" rowspan=\"%1\" align=\"center\" valign=\"middle\">#%2</td>")
-                                .arg(inputFiles[j].size()).arg(j + 1);
-                }
-                
-                htmlCode += QString("<td nowrap=\"nowrap\" align=\"center\">%1</td>").arg(inputFiles[j][k]);
-                
-                QString text;
-                switch (result[j][k]) {
-                    case CorrectAnswer: {
-                        text = tr("Correct Answer");
-                        break;
-                    }
-                    case WrongAnswer: {
-                        text = tr("Wrong Answer");
-                        break;
-                    }
-                    case PartlyCorrect: {
-                        text = tr("Partly Correct");
-                        break;
-                    }
-                    case TimeLimitExceeded: {
-                        text = tr("Time Limit Exceeded");
-                        break;
-                    }
-                    case MemoryLimitExceeded: {
-                        text = tr("Memory Limit Exceeded");
-                        break;
-                    }
-                    case CannotStartProgram: {
-                        text = tr("Cannot Start Program");
-                        break;
-                    }
-                    case FileError: {
-                        text = tr("File Error");
-                        break;
-                    }
-                    case RunTimeError: {
-                        text = tr("Run Time Error");
-                        break;
-                    }
-                    case InvalidSpecialJudge: {
-                        text = tr("Invalid Special Judge");
-                        break;
-                    }
-                    case SpecialJudgeTimeLimitExceeded: {
-                        text = tr("Special Judge Time Limit Exceeded");
-                        break;
-                    }
-                    case SpecialJudgeRunTimeError: {
-                        text = tr("Special Judge Run Time Error");
-                        break;
-                    }
-                }
-                
-                htmlCode += QString("<td align=\"center\">%1").arg(text);
-                if (! message[j][k].isEmpty()) {
-                    QString tmp = message[j][k];
-                    tmp.replace("\n", "\\n");
-                    tmp.replace("\"", "\\");
-                    htmlCode += QString("<a href=\"javascript:alert(&quot;%1&quot;)\"> (...)")
-                                .arg(tmp);
-                }
-                htmlCode += "</td>";
-                
-                htmlCode += "<td nowrap=\"nowrap\" align=\"center\">";
-                if (timeUsed[j][k] != -1)
-                    htmlCode += QString("").sprintf("%.3lf s", double(timeUsed[j][k]) / 1000);
-                else
-                    htmlCode += tr("Invalid");
-                htmlCode += "</td>";
-                
-                htmlCode += "<td nowrap=\"nowrap\" align=\"center\">";
-                if (memoryUsed[j][k] != -1)
-                    htmlCode += QString("").sprintf("%.3lf MB", double(memoryUsed[j][k]) / 1024 / 1024);
-                else
-                    htmlCode += tr("Invalid");
-                htmlCode += "</td>";
-                
-                if (k == 0) {
-                    htmlCode += QString("<td rowspan=\"%1\" align=\"center\" valign=\"middle\">").arg(inputFiles[j].size());
-                    int minv = 1000000000;
-                    for (int t = 0; t < inputFiles[j].size(); t ++)
-                        if (score[j][t] < minv) minv = score[j][t];
-                    htmlCode += QString("%1</td>").arg(minv);
-                }
-                
-                htmlCode += "</tr>";
-            }
-        }
-        
-        htmlCode += "</table><br></p>";
-    }
-    
-    htmlCode += QString("<p><a href=\"#top\">%1</a></p>").arg(tr("Return to top"));
-    
-    return htmlCode;
-}
-
 void DetailDialog::refreshViewer(Contest *_contest, Contestant *_contestant)
 {
     contest = _contest;
@@ -279,6 +106,7 @@ void DetailDialog::refreshViewer(Contest *_contest, Contestant *_contestant)
         QList<QStringList> message = contestant->getMessage(i);
         QList< QList<int> > timeUsed = contestant->getTimeUsed(i);
         QList< QList<int> > memoryUsed = contestant->getMemoryUsed(i);
+        QList< QList<int> > processorUsed = contestant->getProcessorUsed(i);
         QList< QList<int> > score = contestant->getSocre(i);
         
         for (int j = 0; j < inputFiles.size(); j ++) {
@@ -349,6 +177,8 @@ void DetailDialog::refreshViewer(Contest *_contest, Contestant *_contestant)
                     htmlCode += QString("").sprintf("%.3lf s", double(timeUsed[j][k]) / 1000);
                 else
                     htmlCode += tr("Invalid");
+                if (processorUsed.value(j).value(k, -1) >= 0)
+                    htmlCode += QString(" (%1)").arg(tr("CPU %1").arg(processorUsed[j][k]));
                 htmlCode += "</td>";
                 
                 htmlCode += "<td nowrap=\"nowrap\" align=\"center\">";
@@ -387,6 +217,12 @@ void DetailDialog::showDialog()
     exec();
 }
 
+void DetailDialog::rejudgeFinished()
+{
+    emit rejudgeSignal();
+    refreshViewer(contest, contestant);
+}
+
 void DetailDialog::anchorClicked(const QUrl &url)
 {
     QStringList list = url.path().split(' ', QString::SkipEmptyParts);
@@ -394,12 +230,11 @@ void DetailDialog::anchorClicked(const QUrl &url)
     if (list[0] == "Rejudge") {
         JudgingDialog *dialog = new JudgingDialog(this);
         dialog->setModal(true);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
         dialog->setContest(contest);
+        connect(dialog, SIGNAL(finished(int)), this, SLOT(rejudgeFinished()));
         dialog->show();
         dialog->judge(contestant->getContestantName(), list[1].toInt());
-        delete dialog;
-        emit rejudgeSignal();
-        refreshViewer(contest, contestant);
     }
     
     if (list[0] == "CompileMessage") {
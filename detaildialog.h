@@ -39,7 +39,6 @@ public:
     ~DetailDialog();
     void refreshViewer(Contest*, Contestant*);
     void showDialog();
-    static QString getCode(Contest*, Contestant*);
 
 private:
     Ui::DetailDialog *ui;
@@ -48,6 +47,7 @@ private:
 
 private slots:
     void anchorClicked(const QUrl&);
+    void rejudgeFinished();
 
 signals:
     void rejudgeSignal();
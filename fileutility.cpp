@@ -0,0 +1,40 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "fileutility.h"
+
+void FileUtility::clearPath(const QString &curDir)
+{
+    QDir dir(curDir);
+    QStringList fileList = dir.entryList(QDir::Files);
+    for (int i = 0; i < fileList.size(); i ++)
+        if (! dir.remove(fileList[i])) {
+#ifdef Q_OS_WIN32
+            QProcess::execute(QString("attrib -R \"") + curDir + fileList[i] + "\"");
+#endif
+#ifdef Q_OS_LINUX
+            QProcess::execute(QString("chmod +w \"") + curDir + fileList[i] + "\"");
+#endif
+            dir.remove(fileList[i]);
+        }
+    QStringList dirList = dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+    for (int i = 0; i < dirList.size(); i ++) {
+        clearPath(curDir + dirList[i] + QDir::separator());
+        dir.rmdir(dirList[i]);
+    }
+}
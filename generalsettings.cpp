@@ -19,12 +19,16 @@
 #include "generalsettings.h"
 #include "ui_generalsettings.h"
 #include "settings.h"
+#include "globaltype.h"
+#include "contestfile.h"
 
 GeneralSettings::GeneralSettings(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::GeneralSettings)
 {
     ui->setupUi(this);
+    if (! ContestFile::isCodecAvailable(ZstdCompression))
+        ui->compressionCodec->removeItem(ZstdCompression);
     
     ui->defaultFullScore->setValidator(new QIntValidator(1, Settings::upperBoundForFullScore(), this));
     ui->defaultTimeLimit->setValidator(new QIntValidator(1, Settings::upperBoundForTimeLimit(), this));
@@ -33,6 +37,15 @@ GeneralSettings::GeneralSettings(QWidget *parent) :
     ui->specialJudgeTimeLimit->setValidator(new QIntValidator(1, Settings::upperBoundForTimeLimit(), this));
     ui->fileSizeLimit->setValidator(new QIntValidator(1, Settings::upperBoundForFileSizeLimit(), this));
     ui->numberOfThreads->setValidator(new QIntValidator(1, Settings::upperBoundForNumberOfThreads(), this));
+    ui->housekeepingProcessor->setValidator(new QIntValidator(-1, QThread::idealThreadCount() - 1, this));
+    ui->memoryBudget->setValidator(new QIntValidator(0, Settings::upperBoundForMemoryBudget(), this));
+    ui->compileAheadDepth->setValidator(new QIntValidator(1, Settings::upperBoundForCompileAheadDepth(), this));
+    ui->compileCacheSizeLimit->setValidator(new QIntValidator(0, Settings::upperBoundForCompileCacheSizeLimit(), this));
+    ui->minimumNumberOfThreads->setValidator(new QIntValidator(1, Settings::upperBoundForNumberOfThreads(), this));
+    ui->timingNoiseTarget->setValidator(new QIntValidator(1, Settings::upperBoundForTimingNoiseTarget(), this));
+    ui->autoSaveInterval->setValidator(new QIntValidator(0, Settings::upperBoundForAutoSaveInterval(), this));
+    ui->compressionLevel->setValidator(new QIntValidator(1, 9, this));
+    ui->workerHosts->setValidator(new QRegExpValidator(QRegExp("([\\w.-]+(:\\d+)?;)*[\\w.-]+(:\\d+)?"), this));
     ui->inputFileExtensions->setValidator(new QRegExpValidator(QRegExp("(\\w+;)*\\w+"), this));
     ui->outputFileExtensions->setValidator(new QRegExpValidator(QRegExp("(\\w+;)*\\w+"), this));
     
@@ -50,6 +63,34 @@ GeneralSettings::GeneralSettings(QWidget *parent) :
             this, SLOT(fileSizeLimitChanged(QString)));
     connect(ui->numberOfThreads, SIGNAL(textChanged(QString)),
             this, SLOT(numberOfThreadsChanged(QString)));
+    connect(ui->pinJudgingThreads, SIGNAL(toggled(bool)),
+            this, SLOT(pinJudgingThreadsChanged(bool)));
+    connect(ui->housekeepingProcessor, SIGNAL(textChanged(QString)),
+            this, SLOT(housekeepingProcessorChanged(QString)));
+    connect(ui->memoryBudget, SIGNAL(textChanged(QString)),
+            this, SLOT(memoryBudgetChanged(QString)));
+    connect(ui->compileAheadDepth, SIGNAL(textChanged(QString)),
+            this, SLOT(compileAheadDepthChanged(QString)));
+    connect(ui->compileCacheSizeLimit, SIGNAL(textChanged(QString)),
+            this, SLOT(compileCacheSizeLimitChanged(QString)));
+    connect(ui->adaptiveConcurrency, SIGNAL(toggled(bool)),
+            this, SLOT(adaptiveConcurrencyChanged(bool)));
+    connect(ui->minimumNumberOfThreads, SIGNAL(textChanged(QString)),
+            this, SLOT(minimumNumberOfThreadsChanged(QString)));
+    connect(ui->timingNoiseTarget, SIGNAL(textChanged(QString)),
+            this, SLOT(timingNoiseTargetChanged(QString)));
+    connect(ui->autoSaveInterval, SIGNAL(textChanged(QString)),
+            this, SLOT(autoSaveIntervalChanged(QString)));
+    connect(ui->compressionCodec, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(compressionCodecChanged(int)));
+    connect(ui->compressionLevel, SIGNAL(textChanged(QString)),
+            this, SLOT(compressionLevelChanged(QString)));
+    connect(ui->resultDatabaseEnabled, SIGNAL(toggled(bool)),
+            this, SLOT(resultDatabaseEnabledChanged(bool)));
+    connect(ui->workerHosts, SIGNAL(textChanged(QString)),
+            this, SLOT(workerHostsChanged(QString)));
+    connect(ui->workerToken, SIGNAL(textChanged(QString)),
+            this, SLOT(workerTokenChanged(QString)));
     connect(ui->inputFileExtensions, SIGNAL(textChanged(QString)),
             this, SLOT(inputFileExtensionsChanged(QString)));
     connect(ui->outputFileExtensions, SIGNAL(textChanged(QString)),
@@ -72,6 +113,26 @@ void GeneralSettings::resetEditSettings(Settings *settings)
     ui->specialJudgeTimeLimit->setText(QString("%1").arg(editSettings->getSpecialJudgeTimeLimit()));
     ui->fileSizeLimit->setText(QString("%1").arg(editSettings->getFileSizeLimit()));
     ui->numberOfThreads->setText(QString("%1").arg(editSettings->getNumberOfThreads()));
+    ui->pinJudgingThreads->setChecked(editSettings->getPinJudgingThreads());
+    ui->housekeepingProcessor->setText(QString("%1").arg(editSettings->getHousekeepingProcessor()));
+    ui->housekeepingProcessor->setEnabled(editSettings->getPinJudgingThreads());
+    ui->memoryBudget->setText(QString("%1").arg(editSettings->getMemoryBudget()));
+    ui->compileAheadDepth->setText(QString("%1").arg(editSettings->getCompileAheadDepth()));
+    ui->compileCacheSizeLimit->setText(QString("%1").arg(editSettings->getCompileCacheSizeLimit()));
+    ui->adaptiveConcurrency->setChecked(editSettings->getAdaptiveConcurrency());
+    ui->minimumNumberOfThreads->setText(QString("%1").arg(editSettings->getMinimumNumberOfThreads()));
+    ui->timingNoiseTarget->setText(QString("%1").arg(editSettings->getTimingNoiseTarget()));
+    ui->minimumNumberOfThreads->setEnabled(editSettings->getAdaptiveConcurrency());
+    ui->timingNoiseTarget->setEnabled(editSettings->getAdaptiveConcurrency());
+    ui->autoSaveInterval->setText(QString("%1").arg(editSettings->getAutoSaveInterval()));
+    int codec = editSettings->getCompressionCodec();
+    if (! ContestFile::isCodecAvailable(codec)) codec = Lz4Compression;
+    ui->compressionCodec->setCurrentIndex(codec);
+    ui->compressionLevel->setText(QString("%1").arg(editSettings->getCompressionLevel()));
+    ui->compressionLevel->setEnabled(codec != NoCompression);
+    ui->resultDatabaseEnabled->setChecked(editSettings->getResultDatabaseEnabled());
+    ui->workerHosts->setText(editSettings->getWorkerHosts().join(";"));
+    ui->workerToken->setText(editSettings->getWorkerToken());
     ui->inputFileExtensions->setText(editSettings->getInputFileExtensions().join(";"));
     ui->outputFileExtensions->setText(editSettings->getOutputFileExtensions().join(";"));
 }
@@ -113,6 +174,51 @@ bool GeneralSettings::checkValid()
         QMessageBox::warning(this, tr("Error"), tr("Empty number of threads!"), QMessageBox::Close);
         return false;
     }
+    if (ui->pinJudgingThreads->isChecked() && ui->housekeepingProcessor->text().isEmpty()) {
+        ui->housekeepingProcessor->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty reserved processor!"), QMessageBox::Close);
+        return false;
+    }
+    if (ui->memoryBudget->text().isEmpty()) {
+        ui->memoryBudget->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty memory budget!"), QMessageBox::Close);
+        return false;
+    }
+    if (ui->compileAheadDepth->text().isEmpty()) {
+        ui->compileAheadDepth->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty compile ahead depth!"), QMessageBox::Close);
+        return false;
+    }
+    if (ui->compileCacheSizeLimit->text().isEmpty()) {
+        ui->compileCacheSizeLimit->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty compile cache size limit!"), QMessageBox::Close);
+        return false;
+    }
+    if (ui->adaptiveConcurrency->isChecked() && ui->minimumNumberOfThreads->text().isEmpty()) {
+        ui->minimumNumberOfThreads->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty minimum number of threads!"), QMessageBox::Close);
+        return false;
+    }
+    if (ui->adaptiveConcurrency->isChecked() && ui->timingNoiseTarget->text().isEmpty()) {
+        ui->timingNoiseTarget->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty timing noise target!"), QMessageBox::Close);
+        return false;
+    }
+    if (ui->autoSaveInterval->text().isEmpty()) {
+        ui->autoSaveInterval->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty auto save interval!"), QMessageBox::Close);
+        return false;
+    }
+    if (ui->compressionCodec->currentIndex() != NoCompression && ui->compressionLevel->text().isEmpty()) {
+        ui->compressionLevel->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty compression level!"), QMessageBox::Close);
+        return false;
+    }
+    if (! ui->workerHosts->text().isEmpty() && ui->workerToken->text().isEmpty()) {
+        ui->workerToken->setFocus();
+        QMessageBox::warning(this, tr("Error"), tr("Empty worker token!"), QMessageBox::Close);
+        return false;
+    }
     return true;
 }
 
@@ -151,6 +257,80 @@ void GeneralSettings::numberOfThreadsChanged(const QString &text)
     editSettings->setNumberOfThreads(text.toInt());
 }
 
+void GeneralSettings::pinJudgingThreadsChanged(bool check)
+{
+    editSettings->setPinJudgingThreads(check);
+    ui->housekeepingProcessor->setEnabled(check);
+}
+
+void GeneralSettings::housekeepingProcessorChanged(const QString &text)
+{
+    editSettings->setHousekeepingProcessor(text.toInt());
+}
+
+void GeneralSettings::memoryBudgetChanged(const QString &text)
+{
+    editSettings->setMemoryBudget(text.toInt());
+}
+
+void GeneralSettings::compileAheadDepthChanged(const QString &text)
+{
+    editSettings->setCompileAheadDepth(text.toInt());
+}
+
+void GeneralSettings::compileCacheSizeLimitChanged(const QString &text)
+{
+    editSettings->setCompileCacheSizeLimit(text.toInt());
+}
+
+void GeneralSettings::adaptiveConcurrencyChanged(bool check)
+{
+    editSettings->setAdaptiveConcurrency(check);
+    ui->minimumNumberOfThreads->setEnabled(check);
+    ui->timingNoiseTarget->setEnabled(check);
+}
+
+void GeneralSettings::minimumNumberOfThreadsChanged(const QString &text)
+{
+    editSettings->setMinimumNumberOfThreads(text.toInt());
+}
+
+void GeneralSettings::timingNoiseTargetChanged(const QString &text)
+{
+    editSettings->setTimingNoiseTarget(text.toInt());
+}
+
+void GeneralSettings::autoSaveIntervalChanged(const QString &text)
+{
+    editSettings->setAutoSaveInterval(text.toInt());
+}
+
+void GeneralSettings::compressionCodecChanged(int index)
+{
+    editSettings->setCompressionCodec(index);
+    ui->compressionLevel->setEnabled(index != NoCompression);
+}
+
+void GeneralSettings::compressionLevelChanged(const QString &text)
+{
+    editSettings->setCompressionLevel(text.toInt());
+}
+
+void GeneralSettings::resultDatabaseEnabledChanged(bool check)
+{
+    editSettings->setResultDatabaseEnabled(check);
+}
+
+void GeneralSettings::workerHostsChanged(const QString &text)
+{
+    editSettings->setWorkerHosts(text);
+}
+
+void GeneralSettings::workerTokenChanged(const QString &text)
+{
+    editSettings->setWorkerToken(text);
+}
+
 void GeneralSettings::inputFileExtensionsChanged(const QString &text)
 {
     editSettings->setInputFileExtensions(text);
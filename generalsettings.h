@@ -51,6 +51,20 @@ private slots:
     void specialJudgeTimeLimitChanged(const QString&);
     void fileSizeLimitChanged(const QString&);
     void numberOfThreadsChanged(const QString&);
+    void pinJudgingThreadsChanged(bool);
+    void housekeepingProcessorChanged(const QString&);
+    void memoryBudgetChanged(const QString&);
+    void compileAheadDepthChanged(const QString&);
+    void compileCacheSizeLimitChanged(const QString&);
+    void adaptiveConcurrencyChanged(bool);
+    void minimumNumberOfThreadsChanged(const QString&);
+    void timingNoiseTargetChanged(const QString&);
+    void autoSaveIntervalChanged(const QString&);
+    void compressionCodecChanged(int);
+    void compressionLevelChanged(const QString&);
+    void resultDatabaseEnabledChanged(bool);
+    void workerHostsChanged(const QString&);
+    void workerTokenChanged(const QString&);
     void inputFileExtensionsChanged(const QString&);
     void outputFileExtensionsChanged(const QString&);
 };
@@ -28,4 +28,8 @@ enum ResultState { CorrectAnswer, WrongAnswer, PartlyCorrect,
                    InvalidSpecialJudge, SpecialJudgeTimeLimitExceeded,
                    SpecialJudgeRunTimeError };
 
+enum CompressionCodec { NoCompression, ZlibCompression, Lz4Compression, ZstdCompression };
+
+enum ContestFileState { ContestFileLoaded, CannotOpenContestFile, BrokenContestFile };
+
 #endif // GLOBALTYPE_H
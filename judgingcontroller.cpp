@@ -0,0 +1,415 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "judgingcontroller.h"
+#include "assignmentthread.h"
+#include "compilethread.h"
+#include "compilepool.h"
+#include "concurrencycontroller.h"
+#include "fileutility.h"
+#include "settings.h"
+#include "task.h"
+#include "remoteworker.h"
+
+JudgingController::JudgingController(QObject *parent) :
+    QThread(parent)
+{
+    moveToThread(this);
+    qRegisterMetaType< QList< QList<int> > >("QList<QList<int> >");
+    settings = 0;
+    backgroundPaused = false;
+    compilePool = 0;
+    concurrencyController = 0;
+    contestantStarted = false;
+    connect(this, SIGNAL(priorityJobsAdded()),
+            this, SLOT(schedulePriorityCompiles()));
+}
+
+void JudgingController::setSettings(Settings *_settings)
+{
+    settings = _settings;
+}
+
+void JudgingController::setTaskList(const QList<Task*> &list)
+{
+    taskList = list;
+}
+
+void JudgingController::addJob(const QString &contestantName, int index)
+{
+    QMutexLocker locker(&mutex);
+    backgroundQueue.append(qMakePair(contestantName, index));
+}
+
+void JudgingController::addRecheckJob(const QString &contestantName, int index, const QList<QStringList> &outputs)
+{
+    QMutexLocker locker(&mutex);
+    backgroundQueue.append(qMakePair(contestantName, index));
+    recheckOutputs.insert(qMakePair(contestantName, index), outputs);
+}
+
+int JudgingController::addPriorityJob(const QString &contestantName)
+{
+    QMutexLocker locker(&mutex);
+    if (cancellationToken.isCancelled()) return 0;
+    int timeLimit = 0;
+    for (int i = 0; i < taskList.size(); i ++) {
+        QPair<QString, int> job(contestantName, i);
+        if (priorityQueue.contains(job)) continue;
+        if (backgroundQueue.removeAll(job) == 0)
+            timeLimit += taskList[i]->getTotalTimeLimit();
+        priorityQueue.append(job);
+        newPriorityJobs.append(job);
+    }
+    queueChanged.wakeAll();
+    locker.unlock();
+    emit priorityJobsAdded();
+    return timeLimit;
+}
+
+void JudgingController::setBackgroundPaused(bool paused)
+{
+    QMutexLocker locker(&mutex);
+    backgroundPaused = paused;
+    queueChanged.wakeAll();
+}
+
+bool JudgingController::isBackgroundPaused() const
+{
+    QMutexLocker locker(&mutex);
+    return backgroundPaused;
+}
+
+void JudgingController::cancel()
+{
+    cancellationToken.cancel();
+    QMutexLocker locker(&mutex);
+    queueChanged.wakeAll();
+}
+
+bool JudgingController::takeJob(QPair<QString, int> &job)
+{
+    QMutexLocker locker(&mutex);
+    while (! cancellationToken.isCancelled()) {
+        if (! priorityQueue.isEmpty()) {
+            job = priorityQueue.takeFirst();
+            return true;
+        }
+        if (backgroundQueue.isEmpty()) return false;
+        if (! backgroundPaused) {
+            job = backgroundQueue.takeFirst();
+            return true;
+        }
+        queueChanged.wait(&mutex, 100);
+    }
+    return false;
+}
+
+bool JudgingController::tryTakeJob(QPair<QString, int> &job)
+{
+    QMutexLocker locker(&mutex);
+    if (cancellationToken.isCancelled()) return false;
+    if (! priorityQueue.isEmpty()) {
+        job = priorityQueue.takeFirst();
+        return true;
+    }
+    if (backgroundQueue.isEmpty() || backgroundPaused) return false;
+    job = backgroundQueue.takeFirst();
+    return true;
+}
+
+bool JudgingController::hasQueuedJob() const
+{
+    QMutexLocker locker(&mutex);
+    return ! priorityQueue.isEmpty() || ! backgroundQueue.isEmpty();
+}
+
+bool JudgingController::hasPendingJob(const QString &contestantName) const
+{
+    QMutexLocker locker(&mutex);
+    for (int i = 0; i < taskList.size(); i ++)
+        if (priorityQueue.contains(qMakePair(contestantName, i))
+                || backgroundQueue.contains(qMakePair(contestantName, i))) return true;
+    return false;
+}
+
+void JudgingController::run()
+{
+    FileUtility::clearPath(Settings::temporaryPath());
+    QDir(QDir::current()).mkdir(Settings::temporaryPath());
+    
+    if (! settings->getWorkerHosts().isEmpty() && recheckOutputs.isEmpty()) runDistributed();
+    
+    compilePool = new CompilePool();
+    compilePool->setSettings(settings);
+    compilePool->setTaskList(taskList);
+    compilePool->setCancellationToken(&cancellationToken);
+    connect(compilePool, SIGNAL(compileFailed(QString, int, int)),
+            this, SLOT(pooledCompileFailed(QString, int, int)));
+    mutex.lock();
+    QList< QPair<QString, int> > jobList = backgroundQueue;
+    mutex.unlock();
+    for (int i = 0; i < jobList.size(); i ++)
+        if (! recheckOutputs.contains(jobList[i]))
+            compilePool->addJob(jobList[i].first, jobList[i].second);
+    
+    if (settings->getAdaptiveConcurrency()) {
+        concurrencyController = new ConcurrencyController();
+        concurrencyController->setRange(settings->getMinimumNumberOfThreads(), settings->getNumberOfThreads());
+        concurrencyController->setNoiseTarget(settings->getTimingNoiseTarget() / 100.0);
+        connect(concurrencyController, SIGNAL(numberOfWorkersChanged(int, QString)),
+                this, SLOT(workersChanged(int, QString)));
+        compilePool->setConcurrencyController(concurrencyController);
+        if (settings->getPinJudgingThreads() && settings->getHousekeepingProcessor() >= 0) {
+            concurrencyController->setHousekeepingProcessor(settings->getHousekeepingProcessor());
+            concurrencyController->start();
+        } else
+            concurrencyController->calibrate();
+    }
+    
+    QTimer *progressTimer = new QTimer();
+    connect(progressTimer, SIGNAL(timeout()), this, SLOT(flushProgress()));
+    progressTimer->start(100);
+    
+    QPair<QString, int> job;
+    while (takeJob(job)) {
+        reportContestant(job.first);
+        if (! judgeTask(job.first, job.second)) break;
+        if (concurrencyController && ! concurrencyController->isRunning())
+            concurrencyController->sample();
+    }
+    
+    flushProgress();
+    if (! cancellationToken.isCancelled()) {
+        if (contestantStarted) emit contestantJudgingFinished();
+        QDir().rmdir(Settings::temporaryPath());
+    }
+    
+    delete progressTimer;
+    delete compilePool;
+    compilePool = 0;
+    if (concurrencyController) concurrencyController->stop();
+    delete concurrencyController;
+    concurrencyController = 0;
+}
+
+void JudgingController::reportContestant(const QString &contestantName)
+{
+    if (contestantStarted && contestantName == curContestant) return;
+    flushProgress();
+    if (contestantStarted) emit contestantJudgingFinished();
+    emit contestantJudgingStart(contestantName);
+    curContestant = contestantName;
+    contestantStarted = true;
+}
+
+void JudgingController::runDistributed()
+{
+    QStringList hostList = settings->getWorkerHosts();
+    for (int i = 0; i < hostList.size(); i ++) {
+        RemoteWorker *worker = new RemoteWorker();
+        worker->setFileHashes(&fileHashes);
+        worker->setToken(settings->getWorkerToken());
+        connect(worker, SIGNAL(jobFinished(RemoteWorker*)),
+                this, SLOT(remoteJobFinished(RemoteWorker*)));
+        connect(worker, SIGNAL(connectionLost(RemoteWorker*)),
+                this, SLOT(remoteConnectionLost(RemoteWorker*)));
+        worker->connectToWorker(hostList[i]);
+        remoteWorkers.append(worker);
+    }
+    
+    QTimer *dispatchTimer = new QTimer();
+    connect(dispatchTimer, SIGNAL(timeout()), this, SLOT(dispatchRemoteJobs()));
+    dispatchTimer->start(100);
+    exec();
+    
+    delete dispatchTimer;
+    for (int i = 0; i < remoteWorkers.size(); i ++)
+        delete remoteWorkers[i];
+    remoteWorkers.clear();
+}
+
+void JudgingController::dispatchRemoteJobs()
+{
+    if (cancellationToken.isCancelled()) {
+        quit();
+        return;
+    }
+    
+    bool usable = false, busy = false;
+    for (int i = 0; i < remoteWorkers.size(); i ++) {
+        if (! remoteWorkers[i]->isFailed()) usable = true;
+        if (remoteWorkers[i]->isIdle()) {
+            QPair<QString, int> job;
+            if (tryTakeJob(job)) remoteWorkers[i]->startJob(job.first, job.second, taskList[job.second]);
+        }
+        if (remoteWorkers[i]->isBusy()) busy = true;
+    }
+    if (! busy && (! usable || ! hasQueuedJob())) quit();
+}
+
+void JudgingController::remoteJobFinished(RemoteWorker *worker)
+{
+    AssignmentThread *thread = worker->takeThread();
+    AssignmentThread *rejudgeThread = worker->takeRejudgeThread();
+    if (! thread) {
+        requeueJob(worker->getContestantName(), worker->getTaskIndex());
+        worker->disconnectFromWorker();
+        dispatchRemoteJobs();
+        return;
+    }
+    
+    const QString &contestantName = worker->getContestantName();
+    int index = worker->getTaskIndex();
+    reportContestant(contestantName);
+    emit taskJudgingStarted(taskList[index]->getProblemTile());
+    for (int i = 0; i < worker->getCompileErrors().size(); i ++)
+        emit compileError(worker->getCompileErrors()[i].first, worker->getCompileErrors()[i].second);
+    if (! worker->getProgressList().isEmpty())
+        emit progressSnapshot(worker->getProgressList());
+    
+    bool lastTaskOfContestant = ! hasPendingJob(contestantName);
+    for (int i = 0; i < remoteWorkers.size(); i ++)
+        if (remoteWorkers[i] != worker && remoteWorkers[i]->isBusy()
+                && remoteWorkers[i]->getContestantName() == contestantName) lastTaskOfContestant = false;
+    emit taskJudged(contestantName, index, thread, rejudgeThread, lastTaskOfContestant);
+    dispatchRemoteJobs();
+}
+
+void JudgingController::remoteConnectionLost(RemoteWorker *worker)
+{
+    if (worker->isBusy()) {
+        requeueJob(worker->getContestantName(), worker->getTaskIndex());
+        worker->abandonJob();
+    }
+    dispatchRemoteJobs();
+}
+
+void JudgingController::requeueJob(const QString &contestantName, int index)
+{
+    QMutexLocker locker(&mutex);
+    priorityQueue.prepend(qMakePair(contestantName, index));
+}
+
+bool JudgingController::judgeTask(const QString &contestantName, int index)
+{
+    emit taskJudgingStarted(taskList[index]->getProblemTile());
+    
+    CompileThread *compileThread = 0;
+    if (taskList[index]->getTaskType() == Task::Traditional
+            && ! recheckOutputs.contains(qMakePair(contestantName, index))) {
+        compileThread = compilePool->takeCompileThread(contestantName, index);
+        if (cancellationToken.isCancelled()) {
+            FileUtility::clearPath(Settings::temporaryPath());
+            QDir().rmdir(Settings::temporaryPath());
+            return false;
+        }
+    }
+    
+    AssignmentThread *thread = runAssignment(contestantName, index, compileThread, QList< QPair<int, int> >());
+    FileUtility::clearPath(Settings::temporaryPath());
+    AssignmentThread *rejudgeThread = 0;
+    if (! cancellationToken.isCancelled() && thread->getNeedRejudge().size() > 0) {
+        rejudgeThread = runAssignment(contestantName, index, compileThread, thread->getNeedRejudge());
+        FileUtility::clearPath(Settings::temporaryPath());
+    }
+    compilePool->releaseCompileThread(compileThread);
+    
+    if (cancellationToken.isCancelled()) {
+        delete thread;
+        delete rejudgeThread;
+        QDir().rmdir(Settings::temporaryPath());
+        return false;
+    }
+    
+    flushProgress();
+    emit taskJudged(contestantName, index, thread, rejudgeThread, ! hasPendingJob(contestantName));
+    return true;
+}
+
+AssignmentThread* JudgingController::runAssignment(const QString &contestantName, int index,
+                                                   CompileThread *compileThread,
+                                                   const QList< QPair<int, int> > &needRejudge)
+{
+    AssignmentThread *thread = new AssignmentThread();
+    connect(thread, SIGNAL(singleCaseFinished(int, int, int, int, int)),
+            this, SLOT(caseFinished(int, int, int, int, int)));
+    connect(thread, SIGNAL(compileError(int, int)),
+            this, SLOT(caseCompileError(int, int)));
+    if (! needRejudge.isEmpty()) {
+        thread->setCheckRejudgeMode(true);
+        thread->setNeedRejudge(needRejudge);
+    }
+    thread->setSettings(settings);
+    thread->setTask(taskList[index]);
+    thread->setContestantName(contestantName);
+    thread->setCompileThread(compileThread);
+    thread->setConcurrencyController(concurrencyController);
+    thread->setCancellationToken(&cancellationToken);
+    thread->setOutputArchivePath(Settings::outputArchivePath());
+    if (recheckOutputs.contains(qMakePair(contestantName, index)))
+        thread->setRecheckOutputs(recheckOutputs.value(qMakePair(contestantName, index)));
+    QEventLoop *eventLoop = new QEventLoop(this);
+    connect(thread, SIGNAL(finished()), eventLoop, SLOT(quit()));
+    thread->start();
+    eventLoop->exec();
+    delete eventLoop;
+    return thread;
+}
+
+void JudgingController::caseFinished(int progress, int x, int y, int result, int processor)
+{
+    progressList.append(QList<int>() << progress << x << y << result << processor);
+}
+
+void JudgingController::caseCompileError(int progress, int compileState)
+{
+    flushProgress();
+    emit compileError(progress, compileState);
+}
+
+void JudgingController::pooledCompileFailed(const QString &contestantName, int index, int compileState)
+{
+    flushProgress();
+    emit compileFailed(contestantName, taskList[index]->getProblemTile(), compileState);
+}
+
+void JudgingController::workersChanged(int number, const QString &reason)
+{
+    flushProgress();
+    emit numberOfWorkersChanged(number, reason);
+}
+
+void JudgingController::flushProgress()
+{
+    if (progressList.isEmpty()) return;
+    emit progressSnapshot(progressList);
+    progressList.clear();
+}
+
+void JudgingController::schedulePriorityCompiles()
+{
+    if (! compilePool) return;
+    mutex.lock();
+    QList< QPair<QString, int> > jobList = newPriorityJobs;
+    newPriorityJobs.clear();
+    mutex.unlock();
+    for (int i = jobList.size() - 1; i >= 0; i --)
+        if (! recheckOutputs.contains(jobList[i]))
+            compilePool->addPriorityJob(jobList[i].first, jobList[i].second);
+}
@@ -0,0 +1,100 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef JUDGINGCONTROLLER_H
+#define JUDGINGCONTROLLER_H
+
+#include <QtCore>
+#include <QThread>
+#include "cancellationtoken.h"
+
+class Settings;
+class Task;
+class CompilePool;
+class CompileThread;
+class AssignmentThread;
+class ConcurrencyController;
+class RemoteWorker;
+
+class JudgingController : public QThread
+{
+    Q_OBJECT
+public:
+    explicit JudgingController(QObject *parent = 0);
+    void setSettings(Settings*);
+    void setTaskList(const QList<Task*>&);
+    void addJob(const QString&, int);
+    void addRecheckJob(const QString&, int, const QList<QStringList>&);
+    int addPriorityJob(const QString&);
+    void setBackgroundPaused(bool);
+    bool isBackgroundPaused() const;
+    void cancel();
+    void run();
+
+private:
+    Settings *settings;
+    QList<Task*> taskList;
+    CancellationToken cancellationToken;
+    mutable QMutex mutex;
+    QWaitCondition queueChanged;
+    QList< QPair<QString, int> > priorityQueue;
+    QList< QPair<QString, int> > backgroundQueue;
+    QList< QPair<QString, int> > newPriorityJobs;
+    QMap< QPair<QString, int>, QList<QStringList> > recheckOutputs;
+    bool backgroundPaused;
+    CompilePool *compilePool;
+    ConcurrencyController *concurrencyController;
+    QList< QList<int> > progressList;
+    QList<RemoteWorker*> remoteWorkers;
+    QHash<QString, QString> fileHashes;
+    QString curContestant;
+    bool contestantStarted;
+    bool takeJob(QPair<QString, int>&);
+    bool tryTakeJob(QPair<QString, int>&);
+    bool hasQueuedJob() const;
+    bool hasPendingJob(const QString&) const;
+    void requeueJob(const QString&, int);
+    void reportContestant(const QString&);
+    void runDistributed();
+    bool judgeTask(const QString&, int);
+    AssignmentThread* runAssignment(const QString&, int, CompileThread*, const QList< QPair<int, int> >&);
+
+private slots:
+    void caseFinished(int, int, int, int, int);
+    void caseCompileError(int, int);
+    void pooledCompileFailed(const QString&, int, int);
+    void workersChanged(int, const QString&);
+    void flushProgress();
+    void schedulePriorityCompiles();
+    void dispatchRemoteJobs();
+    void remoteJobFinished(RemoteWorker*);
+    void remoteConnectionLost(RemoteWorker*);
+
+signals:
+    void progressSnapshot(const QList< QList<int> >&);
+    void taskJudgingStarted(const QString&);
+    void taskJudged(const QString&, int, QObject*, QObject*, bool);
+    void contestantJudgingStart(const QString&);
+    void contestantJudgingFinished();
+    void compileError(int, int);
+    void compileFailed(const QString&, const QString&, int);
+    void numberOfWorkersChanged(int, const QString&);
+    void priorityJobsAdded();
+};
+
+#endif // JUDGINGCONTROLLER_H
@@ -19,6 +19,7 @@
 #include "judgingdialog.h"
 #include "ui_judgingdialog.h"
 #include "contest.h"
+#include "contestant.h"
 #include "task.h"
 
 JudgingDialog::JudgingDialog(QWidget *parent) :
@@ -29,6 +30,10 @@ JudgingDialog::JudgingDialog(QWidget *parent) :
     cursor = new QTextCursor(ui->logViewer->document());
     connect(ui->cancelButton, SIGNAL(clicked()),
             this, SLOT(stopJudgingSlot()));
+    connect(ui->pauseButton, SIGNAL(clicked()),
+            this, SLOT(pauseButtonClicked()));
+    connect(ui->judgeNowButton, SIGNAL(clicked()),
+            this, SLOT(judgeNowButtonClicked()));
 }
 
 JudgingDialog::~JudgingDialog()
@@ -40,8 +45,8 @@ JudgingDialog::~JudgingDialog()
 void JudgingDialog::setContest(Contest *contest)
 {
     curContest = contest;
-    connect(curContest, SIGNAL(singleCaseFinished(int, int, int, int)),
-            this, SLOT(singleCaseFinished(int, int, int, int)));
+    connect(curContest, SIGNAL(singleCaseFinished(int, int, int, int, int)),
+            this, SLOT(singleCaseFinished(int, int, int, int, int)));
     connect(curContest, SIGNAL(taskJudgingStarted(QString)),
             this, SLOT(taskJudgingStarted(QString)));
     connect(curContest, SIGNAL(contestantJudgingStart(QString)),
@@ -50,6 +55,14 @@ void JudgingDialog::setContest(Contest *contest)
             this, SLOT(contestantJudgingFinished()));
     connect(curContest, SIGNAL(compileError(int, int)),
             this, SLOT(compileError(int, int)));
+    connect(curContest, SIGNAL(compileFailed(QString, QString, int)),
+            this, SLOT(compileFailed(QString, QString, int)));
+    connect(curContest, SIGNAL(numberOfWorkersChanged(int, QString)),
+            this, SLOT(numberOfWorkersChanged(int, QString)));
+    connect(curContest, SIGNAL(priorityJudgingAdded(int)),
+            this, SLOT(priorityJudgingAdded(int)));
+    connect(curContest, SIGNAL(judgingFinished()),
+            this, SLOT(accept()));
     connect(this, SIGNAL(stopJudgingSignal()),
             curContest, SLOT(stopJudgingSlot()));
 }
@@ -58,11 +71,7 @@ void JudgingDialog::judge(const QStringList &nameList)
 {
     stopJudging = false;
     ui->progressBar->setMaximum(curContest->getTotalTimeLimit() * nameList.size());
-    for (int i = 0; i < nameList.size(); i ++) {
-        curContest->judge(nameList[i]);
-        if (stopJudging) break;
-    }
-    accept();
+    curContest->judge(nameList);
 }
 
 void JudgingDialog::judge(const QString &name, int index)
@@ -70,7 +79,16 @@ void JudgingDialog::judge(const QString &name, int index)
     stopJudging = false;
     ui->progressBar->setMaximum(curContest->getTask(index)->getTotalTimeLimit());
     curContest->judge(name, index);
-    accept();
+}
+
+void JudgingDialog::judge(const QList< QPair<QString, int> > &jobList)
+{
+    stopJudging = false;
+    int total = 0;
+    for (int i = 0; i < jobList.size(); i ++)
+        total += curContest->getTask(jobList[i].second)->getTotalTimeLimit();
+    ui->progressBar->setMaximum(total);
+    curContest->judge(jobList);
 }
 
 void JudgingDialog::judgeAll()
@@ -78,10 +96,49 @@ void JudgingDialog::judgeAll()
     stopJudging = false;
     ui->progressBar->setMaximum(curContest->getTotalTimeLimit() * curContest->getContestantList().size());
     curContest->judgeAll();
-    accept();
 }
 
-void JudgingDialog::singleCaseFinished(int progress, int x, int y, int result)
+void JudgingDialog::recheck(const QList< QPair<QString, int> > &jobList)
+{
+    stopJudging = false;
+    int total = 0;
+    for (int i = 0; i < jobList.size(); i ++)
+        total += curContest->getTask(jobList[i].second)->getTotalTimeLimit();
+    ui->progressBar->setMaximum(total);
+    curContest->recheck(jobList);
+}
+
+void JudgingDialog::pauseButtonClicked()
+{
+    if (curContest->isBackgroundPaused()) {
+        curContest->resumeBackgroundSlot();
+        ui->pauseButton->setText(tr("Pause"));
+    } else {
+        curContest->pauseBackgroundSlot();
+        ui->pauseButton->setText(tr("Resume"));
+    }
+}
+
+void JudgingDialog::judgeNowButtonClicked()
+{
+    QStringList nameList;
+    QList<Contestant*> contestantList = curContest->getContestantList();
+    for (int i = 0; i < contestantList.size(); i ++)
+        nameList.append(contestantList[i]->getContestantName());
+    if (nameList.isEmpty()) return;
+    
+    bool ok;
+    QString name = QInputDialog::getItem(this, tr("Judge Now"), tr("Contestant:"), nameList, 0, false, &ok);
+    if (! ok || stopJudging) return;
+    curContest->addPriorityJudging(name);
+}
+
+void JudgingDialog::priorityJudgingAdded(int total)
+{
+    ui->progressBar->setMaximum(ui->progressBar->maximum() + total);
+}
+
+void JudgingDialog::singleCaseFinished(int progress, int x, int y, int result, int processor)
 {
     QTextBlockFormat blockFormat;
     blockFormat.setLeftMargin(30);
@@ -150,6 +207,10 @@ void JudgingDialog::singleCaseFinished(int progress, int x, int y, int result)
     }
     
     cursor->insertText(text, charFormat);
+    if (processor != -1) {
+        charFormat.setForeground(QBrush(Qt::gray));
+        cursor->insertText(tr(" (CPU %1)").arg(processor), charFormat);
+    }
     ui->progressBar->setValue(ui->progressBar->value() + progress);
     
     QScrollBar *bar = ui->logViewer->verticalScrollBar();
@@ -226,6 +287,35 @@ void JudgingDialog::compileError(int progress, int compileState)
     bar->setValue(bar->maximum());
 }
 
+void JudgingDialog::compileFailed(const QString &contestantName, const QString &taskName, int compileState)
+{
+    QTextBlockFormat blockFormat;
+    blockFormat.setLeftMargin(15);
+    cursor->insertBlock(blockFormat);
+    QTextCharFormat charFormat;
+    charFormat.setFontPointSize(9);
+    if (CompileState(compileState) == InvalidCompiler)
+        charFormat.setForeground(QBrush(Qt::blue));
+    else
+        charFormat.setForeground(QBrush(Qt::red));
+    cursor->insertText(tr("Compilation of task %1 for contestant %2 failed").arg(taskName, contestantName), charFormat);
+    QScrollBar *bar = ui->logViewer->verticalScrollBar();
+    bar->setValue(bar->maximum());
+}
+
+void JudgingDialog::numberOfWorkersChanged(int number, const QString &reason)
+{
+    QTextBlockFormat blockFormat;
+    blockFormat.setLeftMargin(30);
+    cursor->insertBlock(blockFormat);
+    QTextCharFormat charFormat;
+    charFormat.setFontPointSize(9);
+    charFormat.setForeground(QBrush(Qt::gray));
+    cursor->insertText(tr("Using %1 judging threads (%2)").arg(number).arg(reason), charFormat);
+    QScrollBar *bar = ui->logViewer->verticalScrollBar();
+    bar->setValue(bar->maximum());
+}
+
 void JudgingDialog::stopJudgingSlot()
 {
     stopJudging = true;
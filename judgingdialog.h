@@ -40,11 +40,15 @@ public:
     void setContest(Contest*);
     void judge(const QStringList&);
     void judge(const QString&, int);
+    void judge(const QList< QPair<QString, int> >&);
     void judgeAll();
+    void recheck(const QList< QPair<QString, int> >&);
     void reject();
 
 private slots:
     void stopJudgingSlot();
+    void pauseButtonClicked();
+    void judgeNowButtonClicked();
 
 private:
     Ui::JudgingDialog *ui;
@@ -53,11 +57,14 @@ private:
     bool stopJudging;
 
 public slots:
-    void singleCaseFinished(int, int, int, int);
+    void singleCaseFinished(int, int, int, int, int);
     void taskJudgingStarted(const QString&);
     void contestantJudgingStart(const QString&);
     void contestantJudgingFinished();
     void compileError(int, int);
+    void compileFailed(const QString&, const QString&, int);
+    void numberOfWorkersChanged(int, const QString&);
+    void priorityJudgingAdded(int);
 
 signals:
     void stopJudgingSignal();
@@ -19,8 +19,11 @@
 #include <cstring>
 #include <cstdio>
 #include "judgingthread.h"
+#include "cancellationtoken.h"
+#include "completionring.h"
 #include "settings.h"
 #include "task.h"
+#include "processorpool.h"
 
 #ifdef Q_OS_WIN32
 #include <windows.h>
@@ -64,9 +67,12 @@ JudgingThread::JudgingThread(QObject *parent) :
     moveToThread(this);
     checkRejudgeMode = false;
     needRejudge = false;
-    stopJudging = false;
+    cancellationToken = 0;
+    completionRing = 0;
+    completionSlot = -1;
     timeUsed = -1;
     memoryUsed = -1;
+    processor = -1;
 }
 
 void JudgingThread::setCheckRejudgeMode(bool check)
@@ -144,6 +150,11 @@ void JudgingThread::setMemoryLimit(int limit)
     memoryLimit = limit;
 }
 
+void JudgingThread::setProcessor(int _processor)
+{
+    processor = _processor;
+}
+
 int JudgingThread::getTimeUsed() const
 {
     return timeUsed;
@@ -174,9 +185,40 @@ bool JudgingThread::getNeedRejudge() const
     return needRejudge;
 }
 
-void JudgingThread::stopJudgingSlot()
+int JudgingThread::getProcessor() const
+{
+    return processor;
+}
+
+void JudgingThread::setCancellationToken(CancellationToken *token)
+{
+    cancellationToken = token;
+}
+
+void JudgingThread::setArchivePath(const QString &path)
 {
-    stopJudging = true;
+    archivePath = path;
+}
+
+void JudgingThread::setArchivedOutput(const QString &hash)
+{
+    archivedOutput = hash;
+}
+
+const QString& JudgingThread::getOutputHash() const
+{
+    return outputHash;
+}
+
+void JudgingThread::setCompletionRing(CompletionRing *ring, int slot)
+{
+    completionRing = ring;
+    completionSlot = slot;
+}
+
+bool JudgingThread::isCancelled() const
+{
+    return cancellationToken && cancellationToken->isCancelled();
 }
 
 void JudgingThread::compareLineByLine(const QString &contestantOutput)
@@ -198,6 +240,7 @@ void JudgingThread::compareLineByLine(const QString &contestantOutput)
     }
     
     char str1[20], str2[20], ch;
+    CancellationCheckpoint checkpoint(cancellationToken);
     bool chk1 = false, chk2 = false;
     bool chkEof1 = false, chkEof2 = false;
     int len1, len2;
@@ -267,8 +310,7 @@ void JudgingThread::compareLineByLine(const QString &contestantOutput)
             return;
         }
         if (chkEof1 && chkEof2) break;
-        QCoreApplication::processEvents();
-        if (stopJudging) {
+        if (checkpoint.isCancelled(len1 + len2 + 2)) {
             fclose(contestantOutputFile);
             fclose(standardOutputFile);
             return;
@@ -301,6 +343,7 @@ void JudgingThread::compareIgnoreSpaces(const QString &contestantOutput)
     
     char ch1 = '\n', ch2 = '\n';
     char str1[20], str2[20];
+    CancellationCheckpoint checkpoint(cancellationToken);
     int flag1, flag2;
     while (true) {
         if (ch1 == '\n' || ch1 == '\r' || ch1 == EOF) {
@@ -396,8 +439,7 @@ void JudgingThread::compareIgnoreSpaces(const QString &contestantOutput)
         }
         if (ch1 == EOF && ch2 == EOF) break;
         
-        QCoreApplication::processEvents();
-        if (stopJudging) {
+        if (checkpoint.isCancelled(len1 + len2 + 2)) {
             fclose(contestantOutputFile);
             fclose(standardOutputFile);
             return;
@@ -446,6 +488,7 @@ void JudgingThread::compareRealNumbers(const QString &contestantOutput)
         eps *= 0.1;
     
     double a, b;
+    CancellationCheckpoint checkpoint(cancellationToken, 4096);
     while (true) {
         int cnt1 = fscanf(contestantOutputFile, "%lf", &a);
         int cnt2 = fscanf(standardOutputFile, "%lf", &b);
@@ -490,8 +533,7 @@ void JudgingThread::compareRealNumbers(const QString &contestantOutput)
             fclose(standardOutputFile);
             return;
         }
-        QCoreApplication::processEvents();
-        if (stopJudging) {
+        if (checkpoint.isCancelled(1)) {
             fclose(contestantOutputFile);
             fclose(standardOutputFile);
             return;
@@ -548,8 +590,7 @@ void JudgingThread::specialJudge(const QString &fileName)
             flag = true;
             break;
         }
-        QCoreApplication::processEvents();
-        if (stopJudging) {
+        if (isCancelled()) {
             judge->kill();
             delete judge;
             return;
@@ -643,7 +684,8 @@ void JudgingThread::runProgram()
     
     QString values = environment.toStringList().join('\0') + '\0';
     if (! CreateProcess(NULL, (WCHAR*)(QString("\"%1\" %2").arg(executableFile, arguments).utf16()), NULL, &sa,
-                        TRUE, HIGH_PRIORITY_CLASS | CREATE_NO_WINDOW, (LPVOID)(values.toLocal8Bit().data()),
+                        TRUE, HIGH_PRIORITY_CLASS | CREATE_NO_WINDOW | CREATE_SUSPENDED,
+                        (LPVOID)(values.toLocal8Bit().data()),
                         (const WCHAR*)(workingDirectory.utf16()), &si, &pi)) {
         if (task->getStandardInputCheck()) CloseHandle(si.hStdInput);
         if (task->getStandardOutputCheck()) CloseHandle(si.hStdOutput);
@@ -653,6 +695,10 @@ void JudgingThread::runProgram()
         return;
     }
     
+    if (processor >= 0 && processor < int(sizeof(DWORD_PTR) * 8))
+        SetProcessAffinityMask(pi.hProcess, DWORD_PTR(1) << processor);
+    ResumeThread(pi.hThread);
+    
     PROCESS_MEMORY_COUNTERS_EX info;
     ZeroMemory(&info, sizeof(info));
     info.cb = sizeof(info);
@@ -699,8 +745,7 @@ void JudgingThread::runProgram()
                 return;
             }
         }
-        QCoreApplication::processEvents();
-        if (stopJudging) {
+        if (isCancelled()) {
             TerminateProcess(pi.hProcess, 0);
             if (task->getStandardInputCheck()) CloseHandle(si.hStdInput);
             if (task->getStandardOutputCheck()) CloseHandle(si.hStdOutput);
@@ -770,7 +815,7 @@ void JudgingThread::runProgram()
     QFile::copy(":/watcher/watcher_unix", workingDirectory + "watcher");
     QProcess::execute(QString("chmod +wx \"") + workingDirectory + "watcher" + "\"");
     
-    QProcess *runner = new QProcess(this);
+    QProcess *runner = new PinnedProcess(processor, this);
     QStringList argumentsList;
     argumentsList << QString("\"%1\" %2").arg(executableFile, arguments);
     if (task->getStandardInputCheck())
@@ -803,8 +848,7 @@ void JudgingThread::runProgram()
             flag = true;
             break;
         }
-        QCoreApplication::processEvents();
-        if (stopJudging) {
+        if (isCancelled()) {
             runner->terminate();
             runner->waitForFinished(-1);
             delete runner;
@@ -873,14 +917,50 @@ void JudgingThread::runProgram()
 #endif
 }
 
-void JudgingThread::judgeOutput()
+QString JudgingThread::getContestantOutputFile() const
 {
-    QString fileName;
     if (task->getStandardOutputCheck())
-        fileName = workingDirectory + "_tmpout";
+        return workingDirectory + "_tmpout";
     else
-        fileName = workingDirectory + task->getOutputFileName();
+        return workingDirectory + task->getOutputFileName();
+}
+
+void JudgingThread::judgeOutput()
+{
+    compareOutput(getContestantOutputFile());
+}
+
+void JudgingThread::archiveOutput()
+{
+    QString fileName = getContestantOutputFile();
+    QFile file(fileName);
+    if (! file.open(QFile::ReadOnly)) return;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    while (! file.atEnd())
+        hash.addData(file.read(1 << 20));
+    file.close();
     
+    QString key = hash.result().toHex();
+    if (! QFileInfo(archivePath + key).exists()) {
+        QDir().mkpath(archivePath);
+        QString stagingFile = archivePath + key + "." + QString::number(quintptr(this), 16);
+        if (! QFile::copy(fileName, stagingFile)) return;
+        if (! QFile::rename(stagingFile, archivePath + key)) {
+            QFile::remove(stagingFile);
+            if (! QFileInfo(archivePath + key).exists()) return;
+        }
+    }
+    outputHash = key;
+}
+
+void JudgingThread::recheckArchivedOutput()
+{
+    outputHash = archivedOutput;
+    compareOutput(archivePath + archivedOutput);
+}
+
+void JudgingThread::compareOutput(const QString &fileName)
+{
     switch (task->getComparisonMode()) {
         case Task::LineByLineMode:
             compareLineByLine(fileName);
@@ -917,7 +997,7 @@ void JudgingThread::judgeTraditionalTask()
         }
     
     runProgram();
-    if (stopJudging) return;
+    if (isCancelled()) return;
     
     if (result != CorrectAnswer) {
         if (! task->getStandardInputCheck())
@@ -929,8 +1009,9 @@ void JudgingThread::judgeTraditionalTask()
         return;
     }
     
+    if (! archivePath.isEmpty()) archiveOutput();
     judgeOutput();
-    if (stopJudging) return;
+    if (isCancelled()) return;
     
     if (timeUsed > timeLimit)
         if (checkRejudgeMode && score > 0 && (timeUsed <= timeLimit * (1 + extraTimeRatio)
@@ -939,7 +1020,7 @@ void JudgingThread::judgeTraditionalTask()
             bool flag = true;
             for (int i = 0; i < 10; i ++) {
                 runProgram();
-                if (stopJudging) return;
+                if (isCancelled()) return;
                 if (result != CorrectAnswer) {
                     flag = false;
                     break;
@@ -948,7 +1029,7 @@ void JudgingThread::judgeTraditionalTask()
                     minTimeUsed = timeUsed;
                     curMemoryUsed = memoryUsed;
                     judgeOutput();
-                    if (stopJudging) return;
+                    if (isCancelled()) return;
                     if (timeUsed <= timeLimit) break;
                 }
             }
@@ -979,29 +1060,29 @@ void JudgingThread::judgeTraditionalTask()
 
 void JudgingThread::judgeAnswersOnlyTask()
 {
-    switch (task->getComparisonMode()) {
-        case Task::LineByLineMode:
-            compareLineByLine(answerFile);
-            break;
-        case Task::IgnoreSpacesMode:
-            compareIgnoreSpaces(answerFile);
-            break;
-        case Task::ExternalToolMode:
-            compareWithDiff(answerFile);
-            break;
-        case Task::RealNumberMode:
-            compareRealNumbers(answerFile);
-            break;
-        case Task::SpecialJudgeMode:
-            specialJudge(answerFile);
-            break;
-    }
+    compareOutput(answerFile);
 }
 
 void JudgingThread::run()
 {
-    if (task->getTaskType() == Task::Traditional)
-        judgeTraditionalTask();
-    if (task->getTaskType() == Task::AnswersOnly)
-        judgeAnswersOnlyTask();
+    if (! archivedOutput.isEmpty())
+        recheckArchivedOutput();
+    else {
+        if (task->getTaskType() == Task::Traditional)
+            judgeTraditionalTask();
+        if (task->getTaskType() == Task::AnswersOnly)
+            judgeAnswersOnlyTask();
+    }
+    
+    if (completionRing) {
+        CompletionRecord record;
+        record.slot = completionSlot;
+        record.timeUsed = timeUsed;
+        record.memoryUsed = memoryUsed;
+        record.score = score;
+        record.result = int(result);
+        record.processor = processor;
+        record.needRejudge = needRejudge;
+        completionRing->push(record);
+    }
 }
@@ -24,6 +24,8 @@
 #include "globaltype.h"
 
 class Task;
+class CancellationToken;
+class CompletionRing;
 
 class JudgingThread : public QThread
 {
@@ -45,12 +47,20 @@ public:
     void setFullScore(int);
     void setTimeLimit(int);
     void setMemoryLimit(int);
+    void setProcessor(int);
+    void setCancellationToken(CancellationToken*);
+    void setCompletionRing(CompletionRing*, int);
+    void setArchivePath(const QString&);
+    void setArchivedOutput(const QString&);
     int getTimeUsed() const;
     int getMemoryUsed() const;
     int getScore() const;
     ResultState getResult() const;
     const QString& getMessage() const;
     bool getNeedRejudge() const;
+    int getProcessor() const;
+    const QString& getOutputHash() const;
+    void compareOutput(const QString&);
     void run();
 
 private:
@@ -70,24 +80,31 @@ private:
     int fullScore;
     int timeLimit;
     int memoryLimit;
+    int processor;
     int timeUsed;
     int memoryUsed;
     int score;
     ResultState result;
     QString message;
-    bool stopJudging;
+    CancellationToken *cancellationToken;
+    CompletionRing *completionRing;
+    int completionSlot;
+    QString archivePath;
+    QString archivedOutput;
+    QString outputHash;
+    bool isCancelled() const;
     void compareLineByLine(const QString&);
     void compareIgnoreSpaces(const QString&);
     void compareWithDiff(const QString&);
     void compareRealNumbers(const QString&);
     void specialJudge(const QString&);
     void runProgram();
+    QString getContestantOutputFile() const;
     void judgeOutput();
+    void archiveOutput();
+    void recheckArchivedOutput();
     void judgeTraditionalTask();
     void judgeAnswersOnlyTask();
-
-public slots:
-    void stopJudgingSlot();
 };
 
 #endif // JUDGINGTHREAD_H
@@ -30,7 +30,8 @@
 #include "opencontestdialog.h"
 #include "welcomedialog.h"
 #include "addtaskdialog.h"
-#include "detaildialog.h"
+#include "resultexporter.h"
+#include "submissionwatcher.h"
 
 Lemon::Lemon(QWidget *parent) :
     QMainWindow(parent),
@@ -45,6 +46,10 @@ Lemon::Lemon(QWidget *parent) :
     ui->closeAction->setEnabled(false);
     
     dataDirWatcher = 0;
+    submissionWatcher = 0;
+    autoSaveTimer = new QTimer(this);
+    exporter = 0;
+    exportDialog = 0;
     settings->loadSettings();
     
     ui->summary->setSettings(settings);
@@ -70,12 +75,24 @@ Lemon::Lemon(QWidget *parent) :
             ui->resultViewer, SLOT(judgeSelected()));
     connect(ui->judgeAllAction, SIGNAL(triggered()),
             ui->resultViewer, SLOT(judgeAll()));
+    connect(ui->judgeStaleAction, SIGNAL(triggered()),
+            ui->resultViewer, SLOT(judgeStale()));
+    connect(ui->recheckAction, SIGNAL(triggered()),
+            ui->resultViewer, SLOT(recheck()));
+    connect(ui->resumeJudgingAction, SIGNAL(triggered()),
+            this, SLOT(resumeJudging()));
+    connect(autoSaveTimer, SIGNAL(timeout()),
+            this, SLOT(autoSave()));
+    connect(ui->onlineJudgingAction, SIGNAL(toggled(bool)),
+            this, SLOT(onlineJudgingToggled(bool)));
     connect(ui->tabWidget, SIGNAL(currentChanged(int)),
             this, SLOT(tabIndexChanged(int)));
     connect(ui->resultViewer, SIGNAL(itemSelectionChanged()),
             this, SLOT(viewerSelectionChanged()));
     connect(ui->resultViewer, SIGNAL(contestantDeleted()),
             this, SLOT(contestantDeleted()));
+    connect(ui->resultViewer, SIGNAL(judgingFinished()),
+            this, SLOT(judgingFinished()));
     connect(ui->newAction, SIGNAL(triggered()),
             this, SLOT(newAction()));
     connect(ui->openAction, SIGNAL(triggered()),
@@ -137,6 +154,7 @@ void Lemon::changeEvent(QEvent *event)
 
 void Lemon::closeEvent(QCloseEvent *event)
 {
+    cancelExport();
     if (curContest) saveContest(curFile);
     settings->saveSettings();
     QSettings settings("Crash", "Lemon");
@@ -249,6 +267,7 @@ void Lemon::showOptionsDialog()
             for (int i = 0; i < taskList.size(); i ++)
                 taskList[i]->refreshCompilerConfiguration(settings);
         }
+        resetAutoSaveTimer();
     }
     delete dialog;
 }
@@ -260,9 +279,13 @@ void Lemon::refreshButtonClicked()
     if (ui->resultViewer->rowCount() > 0) {
         ui->judgeAllButton->setEnabled(true);
         ui->judgeAllAction->setEnabled(true);
+        ui->judgeStaleAction->setEnabled(true);
+        ui->recheckAction->setEnabled(true);
     } else {
         ui->judgeAllButton->setEnabled(false);
         ui->judgeAllAction->setEnabled(false);
+        ui->judgeStaleAction->setEnabled(false);
+        ui->recheckAction->setEnabled(false);
     }
 }
 
@@ -272,6 +295,8 @@ void Lemon::tabIndexChanged(int index)
         ui->judgeAction->setEnabled(false);
         ui->judgeButton->setEnabled(false);
         ui->judgeAllAction->setEnabled(false);
+        ui->judgeStaleAction->setEnabled(false);
+        ui->recheckAction->setEnabled(false);
         ui->judgeAllButton->setEnabled(false);
     } else {
         QList<QTableWidgetSelectionRange> selectionRange = ui->resultViewer->selectedRanges();
@@ -284,9 +309,13 @@ void Lemon::tabIndexChanged(int index)
         }
         if (ui->resultViewer->rowCount() > 0) {
             ui->judgeAllAction->setEnabled(true);
+            ui->judgeStaleAction->setEnabled(true);
+            ui->recheckAction->setEnabled(true);
             ui->judgeAllButton->setEnabled(true);
         } else {
             ui->judgeAllAction->setEnabled(false);
+            ui->judgeStaleAction->setEnabled(false);
+            ui->recheckAction->setEnabled(false);
             ui->judgeAllButton->setEnabled(false);
         }
     }
@@ -309,76 +338,138 @@ void Lemon::contestantDeleted()
     if (ui->resultViewer->rowCount() > 0) {
         ui->judgeAllButton->setEnabled(true);
         ui->judgeAllAction->setEnabled(true);
+        ui->judgeStaleAction->setEnabled(true);
+        ui->recheckAction->setEnabled(true);
     } else {
         ui->judgeAllButton->setEnabled(false);
         ui->judgeAllAction->setEnabled(false);
+        ui->judgeStaleAction->setEnabled(false);
+        ui->recheckAction->setEnabled(false);
     }
 }
 
-void Lemon::saveContest(const QString &fileName)
+void Lemon::onlineJudgingToggled(bool check)
 {
-    QFile file(fileName);
-    if (! file.open(QFile::WriteOnly)) {
-        QMessageBox::warning(this, tr("Error"), tr("Cannot open file %1").arg(fileName),
-                             QMessageBox::Close);
+    delete submissionWatcher;
+    submissionWatcher = 0;
+    pendingSubmissions.clear();
+    if (! check || ! curContest) return;
+    submissionWatcher = new SubmissionWatcher(this);
+    submissionWatcher->setContest(curContest);
+    connect(submissionWatcher, SIGNAL(submissionsChanged(QList<QPair<QString,int> >)),
+            this, SLOT(submissionsChanged(QList<QPair<QString,int> >)));
+    submissionWatcher->start();
+}
+
+void Lemon::resumeJudging()
+{
+    ui->resumeJudgingAction->setEnabled(false);
+    if (! curContest || curContest->getResumeJobs().isEmpty()) return;
+    ui->resultViewer->judge(curContest->getResumeJobs());
+}
+
+void Lemon::submissionsChanged(const QList< QPair<QString, int> > &jobList)
+{
+    for (int i = 0; i < jobList.size(); i ++)
+        if (! pendingSubmissions.contains(jobList[i])) pendingSubmissions.append(jobList[i]);
+    judgePendingSubmissions();
+}
+
+void Lemon::judgePendingSubmissions()
+{
+    if (! curContest || pendingSubmissions.isEmpty()) return;
+    if (curContest->isJudging() || exporter) {
+        QTimer::singleShot(1000, this, SLOT(judgePendingSubmissions()));
         return;
     }
-    
+    QList< QPair<QString, int> > jobList = pendingSubmissions;
+    pendingSubmissions.clear();
+    curContest->refreshContestantList();
+    ui->resultViewer->refreshViewer();
+    ui->resultViewer->judge(jobList);
+}
+
+void Lemon::judgingFinished()
+{
+    contestantDeleted();
+    if (! pendingSubmissions.isEmpty())
+        QTimer::singleShot(0, this, SLOT(judgePendingSubmissions()));
+}
+
+void Lemon::saveContest(const QString &fileName)
+{
     QApplication::setOverrideCursor(Qt::WaitCursor);
-    
-    QByteArray data;
-    QDataStream _out(&data, QIODevice::WriteOnly);
-    curContest->writeToStream(_out);
-    data = qCompress(data);
-    QDataStream out(&file);
-    out << unsigned(MagicNumber) << qChecksum(data.data(), data.length()) << data.length();
-    out.writeRawData(data.data(), data.length());
-    
+    bool saved = curContest->saveToFile(fileName);
     QApplication::restoreOverrideCursor();
+    
+    if (! saved)
+        QMessageBox::warning(this, tr("Error"), tr("Cannot open file %1").arg(fileName),
+                             QMessageBox::Close);
+}
+
+void Lemon::resetAutoSaveTimer()
+{
+    autoSaveTimer->stop();
+    if (curContest && settings->getAutoSaveInterval() > 0)
+        autoSaveTimer->start(settings->getAutoSaveInterval() * 60000);
+}
+
+void Lemon::autoSave()
+{
+    if (curContest && ! exporter) curContest->saveInBackground(curFile);
+}
+
+void Lemon::autoSaveFinished(bool saved)
+{
+    if (! saved)
+        QMessageBox::warning(this, tr("Error"), tr("Cannot save file %1").arg(curFile),
+                             QMessageBox::Close);
+}
+
+void Lemon::detailsLoadFailed(const QString &contestantName)
+{
+    if (brokenContestants.contains(contestantName)) return;
+    if (brokenContestants.isEmpty())
+        QTimer::singleShot(0, this, SLOT(showBrokenContestants()));
+    brokenContestants.append(contestantName);
+}
+
+void Lemon::showBrokenContestants()
+{
+    QStringList nameList = brokenContestants;
+    brokenContestants.clear();
+    if (nameList.isEmpty()) return;
+    QMessageBox::warning(this, tr("Error"),
+                         tr("Cannot read the results of %1 from the contest file. "
+                            "The stored results are kept; judge these contestants again to replace them.")
+                         .arg(nameList.join(", ")), QMessageBox::Close);
 }
 
 void Lemon::loadContest(const QString &filePath)
 {
     if (curContest) closeAction();
     
-    QFile file(filePath);
-    if (! file.open(QFile::ReadOnly)) {
-        QMessageBox::warning(this, tr("Error"), tr("Cannot open file %1").arg(QFileInfo(filePath).fileName()),
-                             QMessageBox::Close);
-        return;
-    }
-    
-    QDataStream _in(&file);
-    unsigned checkNumber;
-    _in >> checkNumber;
-    if (checkNumber != unsigned(MagicNumber)) {
-        QMessageBox::warning(this, tr("Error"), tr("File %1 is broken").arg(QFileInfo(filePath).fileName()),
-                             QMessageBox::Close);
-        return;
-    }
+    QApplication::setOverrideCursor(Qt::WaitCursor);
     
-    quint16 checksum;
-    int len;
-    _in >> checksum >> len;
-    char *raw = new char[len];
-    _in.readRawData(raw, len);
-    if (qChecksum(raw, len) != checksum) {
-        QMessageBox::warning(this, tr("Error"), tr("File %1 is broken").arg(QFileInfo(filePath).fileName()),
-                             QMessageBox::Close);
-        delete[] raw;
+    Contest *contest = new Contest(this);
+    contest->setSettings(settings);
+    ContestFileState state = contest->loadFromFile(filePath);
+    if (state != ContestFileLoaded) {
+        delete contest;
+        QApplication::restoreOverrideCursor();
+        if (state == CannotOpenContestFile)
+            QMessageBox::warning(this, tr("Error"), tr("Cannot open file %1").arg(QFileInfo(filePath).fileName()),
+                                 QMessageBox::Close);
+        else
+            QMessageBox::warning(this, tr("Error"), tr("File %1 is broken").arg(QFileInfo(filePath).fileName()),
+                                 QMessageBox::Close);
         return;
     }
-    
-    QByteArray data(raw, len);
-    delete[] raw;
-    data = qUncompress(data);
-    QDataStream in(data);
-    
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    
-    curContest = new Contest(this);
-    curContest->setSettings(settings);
-    curContest->readFromStream(in);
+    curContest = contest;
+    connect(curContest, SIGNAL(saveFinished(bool)),
+            this, SLOT(autoSaveFinished(bool)));
+    connect(curContest, SIGNAL(detailsLoadFailed(QString)),
+            this, SLOT(detailsLoadFailed(QString)));
     
     curFile = QFileInfo(filePath).fileName();
     QDir::setCurrent(QFileInfo(filePath).path());
@@ -390,13 +481,21 @@ void Lemon::loadContest(const QString &filePath)
     ui->tabWidget->setVisible(true);
     resetDataWatcher();
     ui->closeAction->setEnabled(true);
+    ui->onlineJudgingAction->setEnabled(true);
     ui->addTasksAction->setEnabled(true);
     ui->makeSelfTestAction->setEnabled(true);
     ui->exportAction->setEnabled(true);
+    ui->resumeJudgingAction->setEnabled(! curContest->getResumeJobs().isEmpty());
+    resetAutoSaveTimer();
     setWindowTitle(tr("Lemon - %1").arg(curContest->getContestTitle()));
     
     QApplication::restoreOverrideCursor();
     ui->tabWidget->setCurrentIndex(0);
+    
+    if (curContest->getRecoveredCount() > 0)
+        QMessageBox::information(this, tr("Lemon"),
+                                 tr("Recovered %1 judging result(s) that were not saved last time")
+                                 .arg(curContest->getRecoveredCount()));
 }
 
 void Lemon::newContest(const QString &title, const QString &savingName, const QString &path)
@@ -417,12 +516,18 @@ void Lemon::newContest(const QString &title, const QString &savingName, const QS
     QDir().mkdir(Settings::sourcePath());
     curFile = savingName + ".cdf";
     saveContest(curFile);
+    connect(curContest, SIGNAL(saveFinished(bool)),
+            this, SLOT(autoSaveFinished(bool)));
+    connect(curContest, SIGNAL(detailsLoadFailed(QString)),
+            this, SLOT(detailsLoadFailed(QString)));
+    resetAutoSaveTimer();
     ui->summary->setContest(curContest);
     ui->resultViewer->setContest(curContest);
     ui->resultViewer->refreshViewer();
     ui->tabWidget->setVisible(true);
     resetDataWatcher();
     ui->closeAction->setEnabled(true);
+    ui->onlineJudgingAction->setEnabled(true);
     ui->addTasksAction->setEnabled(true);
     ui->makeSelfTestAction->setEnabled(true);
     ui->exportAction->setEnabled(true);
@@ -442,6 +547,11 @@ void Lemon::newAction()
 
 void Lemon::closeAction()
 {
+    cancelExport();
+    ui->onlineJudgingAction->setChecked(false);
+    ui->onlineJudgingAction->setEnabled(false);
+    ui->resumeJudgingAction->setEnabled(false);
+    autoSaveTimer->stop();
     saveContest(curFile);
     ui->summary->setContest(0);
     ui->taskEdit->setEditTask(0);
@@ -844,86 +954,64 @@ void Lemon::makeSelfTest()
     QMessageBox::information(this, tr("Lemon"), tr("Self-test folder has been made"), QMessageBox::Ok);
 }
 
-void Lemon::exportHtml(const QString &fileName)
+void Lemon::exportStreamed(const QString &fileName, int format)
 {
-    QFile file(fileName);
-    if (! file.open(QFile::WriteOnly)) {
-        QMessageBox::warning(this, tr("Lemon"), tr("Cannot open file %1").arg(QFileInfo(file).fileName()),
-                             QMessageBox::Ok);
-        return;
-    }
+    if (exporter) return;
+    curContest->waitForSave();
+    exporter = new ResultExporter(this);
+    exporter->setContest(curContest);
+    exporter->setExportFile(fileName, ResultExporter::ExportFormat(format));
     
+    // the window modal dialog keeps the contest untouched while the exporter reads it
+    exportDialog = new QProgressDialog(tr("Exporting results..."), tr("Cancel"), 0, 0, this);
+    exportDialog->setWindowModality(Qt::WindowModal);
+    exportDialog->setMinimumDuration(0);
+    connect(exporter, SIGNAL(progressRangeChanged(int, int)), exportDialog, SLOT(setRange(int, int)));
+    connect(exporter, SIGNAL(progressValueChanged(int)), exportDialog, SLOT(setValue(int)));
+    connect(exportDialog, SIGNAL(canceled()), this, SLOT(exportCanceled()));
+    connect(exporter, SIGNAL(finished()), this, SLOT(exportFinished()));
+    exportDialog->show();
+    exporter->start();
+}
+
+void Lemon::exportCanceled()
+{
+    if (! exporter) return;
+    exporter->cancel();
     QApplication::setOverrideCursor(Qt::WaitCursor);
-    QTextStream out(&file);
-    
-    QList<Contestant*> contestantList = curContest->getContestantList();
-    QList<Task*> taskList = curContest->getTaskList();
-    
-    out.setCodec("UTF-8");
-    out << "<html><head>";
-    out << "<meta http-equiv=\"Content-Type\" content=\"text/html; charset=utf-8\" />";
-    out << "<style type=\"text/css\">th, td {padding-left: 1em; padding-right: 1em;}</style>";
-    out << "<title>" << tr("Contest Result") << "</title>";
-    out << "</head><body>";
-    
-    QList< QPair<int, QString> > sortList;
-    for (int i = 0; i < contestantList.size(); i ++) {
-        int totalScore = contestantList[i]->getTotalScore();
-        if (totalScore != -1)
-            sortList.append(qMakePair(-totalScore, contestantList[i]->getContestantName()));
-        else
-            sortList.append(qMakePair(1, contestantList[i]->getContestantName()));
-    }
-    qSort(sortList);
-    QMap<QString, int> rankList;
-    for (int i = 0; i < sortList.size(); i ++)
-        if (i > 0 && sortList[i].first == sortList[i-1].first)
-            rankList.insert(sortList[i].second, rankList[sortList[i-1].second]);
-        else
-            rankList.insert(sortList[i].second, i);
-    
-    QMap<Contestant*, int> loc;
-    for (int i = 0; i < contestantList.size(); i ++)
-        loc.insert(contestantList[i], i);
-    
-    out << "<p><span style=\"font-size:x-large; font-weight:bold;\">";
-    out << "<a name=\"top\"></a>" << tr("Rank List") << "</span></p>";
-    out << "<p><table border=\"1\" cellpadding=\"1\"><tr>";
-    out << QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th>").arg(tr("Rank"));
-    out << QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th>").arg(tr("Name"));
-    for (int i = 0; i < taskList.size(); i ++)
-        out << QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th>").arg(taskList[i]->getProblemTile());
-    out << QString("<th scope=\"col\" nowrap=\"nowrap\">%1</th></tr>").arg(tr("Total Score"));
-    
-    for (int i = 0; i < sortList.size(); i ++) {
-        Contestant *contestant = curContest->getContestant(sortList[i].second);
-        out << QString("<tr><td nowrap=\"nowrap\" align=\"center\">%1</td>")
-               .arg(rankList[contestant->getContestantName()] + 1);
-        out << QString("<td nowrap=\"nowrap\" align=\"center\"><a href=\"#c%1\">%2</a></td>")
-               .arg(loc[contestant]).arg(sortList[i].second);
-        for (int j = 0; j < taskList.size(); j ++) {
-            int score = contestant->getTaskScore(j);
-            if (score != -1)
-                out << QString("<td nowrap=\"nowrap\" align=\"center\">%1</td>").arg(score);
-            else
-                out << QString("<td nowrap=\"nowrap\" align=\"center\">%1</td>").arg(tr("Invalid"));
-        }
-        int score = contestant->getTotalScore();
-        if (score != -1)
-            out << QString("<td nowrap=\"nowrap\" align=\"center\">%1</td>").arg(score);
-        else
-            out << QString("<td nowrap=\"nowrap\" align=\"center\">%1</td>").arg(tr("Invalid"));
-    }
-    out << "</table></p>";
+    exporter->wait();
+    QApplication::restoreOverrideCursor();
+}
+
+void Lemon::cancelExport()
+{
+    if (! exporter) return;
+    exporter->cancel();
+    exporter->wait();
+    delete exportDialog;
+    exportDialog = 0;
+    delete exporter;
+    exporter = 0;
+}
+
+void Lemon::exportFinished()
+{
+    if (! exporter || sender() != exporter) return;
+    exporter->wait();
+    QString fileName = exporter->getFileName();
+    bool exported = exporter->getExported();
+    bool canceled = exportDialog->wasCanceled();
+    delete exportDialog;
+    exportDialog = 0;
+    delete exporter;
+    exporter = 0;
     
-    for (int i = 0; i < contestantList.size(); i ++) {
-        out << QString("<a name=\"c%1\"><hr><a>").arg(i) << "<span style=\"font-size:x-large; font-weight:bold;\">";
-        out << tr("Contestant: %1").arg(contestantList[i]->getContestantName()) << "</span>";
-        out << DetailDialog::getCode(curContest, contestantList[i]);
+    if (canceled) return;
+    if (! exported) {
+        QMessageBox::warning(this, tr("Lemon"), tr("Cannot open file %1").arg(QFileInfo(fileName).fileName()),
+                             QMessageBox::Ok);
+        return;
     }
-    out << "</body></html>";
-    
-    QApplication::restoreOverrideCursor();
     QMessageBox::information(this, tr("Lemon"), tr("Export is done"), QMessageBox::Ok);
 }
 
@@ -1076,7 +1164,8 @@ void Lemon::exportResult()
         return;
     }
     
-    QString filter = tr("HTML Document (*.html);;CSV (*.csv)");
+    QString filter = tr("HTML Document (*.html);;HTML Document with Separate Detail Pages (*.html);;CSV (*.csv)"
+                        ";;CSV with One Row per Case (*.csv);;JSON Lines with One Record per Case (*.jsonl)");
     
 #ifdef Q_OS_WIN32
     QAxObject *excel = new QAxObject("Excel.Application", this);
@@ -1085,13 +1174,23 @@ void Lemon::exportResult()
     delete excel;
 #endif
     
+    QString selectedFilter;
     QString fileName = QFileDialog::getSaveFileName(this, tr("Export Result"),
-                                                    QDir::currentPath() + QDir::separator() + "result", filter);
+                                                    QDir::currentPath() + QDir::separator() + "result", filter,
+                                                    &selectedFilter);
     if (fileName.isEmpty()) return;
     
-    if (QFileInfo(fileName).suffix() == "html") exportHtml(fileName);
-    if (QFileInfo(fileName).suffix() == "csv") exportCsv(fileName);
-    if (QFileInfo(fileName).suffix() == "xls") exportXls(fileName);
+    QString suffix = QFileInfo(fileName).suffix();
+    if (suffix == "html" && selectedFilter.contains(tr("Separate Detail Pages")))
+        exportStreamed(fileName, ResultExporter::SplitHtmlFormat);
+    else if (suffix == "html")
+        exportStreamed(fileName, ResultExporter::HtmlFormat);
+    if (suffix == "csv" && selectedFilter.contains(tr("One Row per Case")))
+        exportStreamed(fileName, ResultExporter::CsvFormat);
+    else if (suffix == "csv")
+        exportCsv(fileName);
+    if (suffix == "jsonl") exportStreamed(fileName, ResultExporter::JsonLinesFormat);
+    if (suffix == "xls") exportXls(fileName);
 }
 
 void Lemon::aboutLemon()
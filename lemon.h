@@ -34,6 +34,8 @@ namespace Ui {
 class Contest;
 class Settings;
 class OptionsDialog;
+class SubmissionWatcher;
+class ResultExporter;
 
 class Lemon : public QMainWindow
 {
@@ -51,6 +53,12 @@ private:
     Contest *curContest;
     Settings *settings;
     QFileSystemWatcher *dataDirWatcher;
+    SubmissionWatcher *submissionWatcher;
+    QTimer *autoSaveTimer;
+    ResultExporter *exporter;
+    QProgressDialog *exportDialog;
+    QList< QPair<QString, int> > pendingSubmissions;
+    QStringList brokenContestants;
     QString curFile;
     QList<QAction*> languageActions;
     QTranslator *appTranslator;
@@ -59,11 +67,13 @@ private:
     void insertWatchPath(const QString&, QFileSystemWatcher*);
     void newContest(const QString&, const QString&, const QString&);
     void saveContest(const QString&);
+    void resetAutoSaveTimer();
     void loadContest(const QString&);
     void getFiles(const QString&, const QStringList&, QMap<QString, QString>&);
     void addTask(const QString&, const QList< QPair<QString, QString> >&, int, int, int);
     void clearPath(const QString&);
-    void exportHtml(const QString&);
+    void exportStreamed(const QString&, int);
+    void cancelExport();
     void exportCsv(const QString&);
     void exportXls(const QString&);
     static bool compareFileName(const QPair<QString, QString>&, const QPair<QString, QString>&);
@@ -76,12 +86,23 @@ private slots:
     void tabIndexChanged(int);
     void viewerSelectionChanged();
     void contestantDeleted();
+    void onlineJudgingToggled(bool);
+    void submissionsChanged(const QList< QPair<QString, int> >&);
+    void judgePendingSubmissions();
+    void judgingFinished();
+    void resumeJudging();
+    void autoSave();
+    void autoSaveFinished(bool);
+    void detailsLoadFailed(const QString&);
+    void showBrokenContestants();
     void newAction();
     void closeAction();
     void loadAction();
     void addTasksAction();
     void makeSelfTest();
     void exportResult();
+    void exportCanceled();
+    void exportFinished();
     void aboutLemon();
     void setUiLanguage();
 
@@ -0,0 +1,61 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "messagepool.h"
+
+#define MaximumInternedLength 4096
+
+static QMutex poolMutex;
+static QSet<QString> pool;
+
+QString MessagePool::intern(const QString &text)
+{
+    if (text.isEmpty() || text.length() > MaximumInternedLength) return text;
+    QMutexLocker locker(&poolMutex);
+    QSet<QString>::const_iterator p = pool.constFind(text);
+    if (p != pool.constEnd()) return *p;
+    pool.insert(text);
+    return text;
+}
+
+QStringList MessagePool::intern(const QStringList &list)
+{
+    QStringList result;
+    for (int i = 0; i < list.size(); i ++)
+        result.append(intern(list[i]));
+    return result;
+}
+
+QList<QStringList> MessagePool::intern(const QList<QStringList> &list)
+{
+    QList<QStringList> result;
+    for (int i = 0; i < list.size(); i ++)
+        result.append(intern(list[i]));
+    return result;
+}
+
+void MessagePool::squeeze()
+{
+    QMutexLocker locker(&poolMutex);
+    QSet<QString>::iterator p;
+    for (p = pool.begin(); p != pool.end(); )
+        if (p->isDetached())
+            p = pool.erase(p);
+        else
+            p ++;
+}
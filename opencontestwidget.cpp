@@ -52,34 +52,11 @@ void OpenContestWidget::refreshContestList()
 {
     ui->recentContest->setRowCount(0);
     for (int i = 0; i < recentContest.size(); ) {
-        QFile file(recentContest[i]);
-        if (! file.open(QFile::ReadOnly)) {
-            recentContest.removeAt(i);
-            continue;
-        }
-        QDataStream _in(&file);
-        unsigned checkNumber;
-        _in >> checkNumber;
-        if (checkNumber != unsigned(MagicNumber)) {
-            recentContest.removeAt(i);
-            continue;
-        }
-        quint16 checksum;
-        int len;
-        _in >> checksum >> len;
-        char *raw = new char[len];
-        _in.readRawData(raw, len);
-        if (qChecksum(raw, len) != checksum) {
-            delete[] raw;
+        QString title;
+        if (! Contest::readContestTitle(recentContest[i], title)) {
             recentContest.removeAt(i);
             continue;
         }
-        QByteArray data(raw, len);
-        delete[] raw;
-        data = qUncompress(data);
-        QDataStream in(data);
-        QString title;
-        in >> title;
         ui->recentContest->setRowCount(i + 1);
         ui->recentContest->setItem(i, 0, new QTableWidgetItem(title));
         ui->recentContest->setItem(i, 1, new QTableWidgetItem(recentContest[i]));
@@ -101,24 +78,12 @@ void OpenContestWidget::addContest()
         QMessageBox::warning(this, tr("Error"), tr("Cannot open selected file"), QMessageBox::Close);
         return;
     }
-    QDataStream in(&file);
-    unsigned checkNumber;
-    in >> checkNumber;
-    if (checkNumber != unsigned(MagicNumber)) {
-        QMessageBox::warning(this, tr("Error"), tr("Broken contest data file"), QMessageBox::Close);
-        return;
-    }
-    quint16 checksum;
-    int len;
-    in >> checksum >> len;
-    char *raw = new char[len];
-    in.readRawData(raw, len);
-    if (qChecksum(raw, len) != checksum) {
+    file.close();
+    QString title;
+    if (! Contest::readContestTitle(fileName, title)) {
         QMessageBox::warning(this, tr("Error"), tr("Broken contest data file"), QMessageBox::Close);
-        delete[] raw;
         return;
     }
-    delete[] raw;
     recentContest.append(fileName);
     refreshContestList();
 }
@@ -0,0 +1,192 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "processorpool.h"
+
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+
+static int readNumber(const QString &fileName, int defaultValue)
+{
+    QFile file(fileName);
+    if (! file.open(QFile::ReadOnly)) return defaultValue;
+    bool ok;
+    int value = QString(file.readAll()).trimmed().toInt(&ok);
+    return ok ? value : defaultValue;
+}
+#endif
+
+ProcessorPool::ProcessorPool(QObject *parent) :
+    QObject(parent)
+{
+    housekeepingProcessor = -1;
+}
+
+void ProcessorPool::setHousekeepingProcessor(int processor)
+{
+    housekeepingProcessor = processor;
+}
+
+void ProcessorPool::detectTopology()
+{
+    processorList.clear();
+    occupied.clear();
+    bool detected = false;
+
+#ifdef Q_OS_WIN32
+    DWORD length = 0;
+    GetLogicalProcessorInformation(NULL, &length);
+    QByteArray buffer(int(length), 0);
+    if (length > 0 && GetLogicalProcessorInformation((PSYSTEM_LOGICAL_PROCESSOR_INFORMATION)buffer.data(), &length)) {
+        PSYSTEM_LOGICAL_PROCESSOR_INFORMATION info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION)buffer.data();
+        int count = length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+        for (int i = 0; i < count; i ++) {
+            if (info[i].Relationship != RelationProcessorCore) continue;
+            ULONG_PTR mask = info[i].ProcessorMask;
+            if (mask == 0) continue;
+            detected = true;
+            if (housekeepingProcessor >= 0 && housekeepingProcessor < int(sizeof(ULONG_PTR) * 8)
+                    && (mask >> housekeepingProcessor) & 1) continue;
+            int first = 0;
+            while (! ((mask >> first) & 1)) first ++;
+            processorList.append(first);
+        }
+    }
+#endif
+
+#ifdef Q_OS_LINUX
+    QString cpuPath = "/sys/devices/system/cpu/";
+    QStringList entryList = QDir(cpuPath).entryList(QStringList() << "cpu*", QDir::Dirs);
+    QList<int> logicalList;
+    for (int i = 0; i < entryList.size(); i ++) {
+        bool ok;
+        int id = entryList[i].mid(3).toInt(&ok);
+        if (ok) logicalList.append(id);
+    }
+    qSort(logicalList);
+
+    QList< QPair<int, int> > coreList;
+    QMap< QPair<int, int>, int > firstProcessor;
+    QPair<int, int> housekeepingCore(-1, -1);
+    for (int i = 0; i < logicalList.size(); i ++) {
+        QString path = cpuPath + QString("cpu%1/").arg(logicalList[i]);
+        if (readNumber(path + "online", 1) == 0) continue;
+        QPair<int, int> core(readNumber(path + "topology/physical_package_id", 0),
+                             readNumber(path + "topology/core_id", logicalList[i]));
+        if (logicalList[i] == housekeepingProcessor) housekeepingCore = core;
+        if (! firstProcessor.contains(core)) {
+            firstProcessor.insert(core, logicalList[i]);
+            coreList.append(core);
+        }
+    }
+    for (int i = 0; i < coreList.size(); i ++) {
+        detected = true;
+        if (coreList[i] != housekeepingCore)
+            processorList.append(firstProcessor[coreList[i]]);
+    }
+#endif
+
+    if (! detected)
+        for (int i = 0; i < QThread::idealThreadCount(); i ++)
+            if (i != housekeepingProcessor) processorList.append(i);
+
+    for (int i = 0; i < processorList.size(); i ++)
+        occupied.append(false);
+}
+
+int ProcessorPool::getProcessorCount() const
+{
+    return processorList.size();
+}
+
+int ProcessorPool::acquireProcessor()
+{
+    for (int i = 0; i < processorList.size(); i ++)
+        if (! occupied[i]) {
+            occupied[i] = true;
+            return processorList[i];
+        }
+    return -1;
+}
+
+void ProcessorPool::releaseProcessor(int processor)
+{
+    int index = processorList.indexOf(processor);
+    if (index != -1) occupied[index] = false;
+}
+
+bool ProcessorPool::bindCurrentProcess(int processor)
+{
+    if (processor < 0) return false;
+
+#ifdef Q_OS_WIN32
+    if (processor >= int(sizeof(DWORD_PTR) * 8)) return false;
+    return SetProcessAffinityMask(GetCurrentProcess(), DWORD_PTR(1) << processor);
+#endif
+
+#ifdef Q_OS_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(processor, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#endif
+
+    return false;
+}
+
+bool ProcessorPool::bindCurrentThread(int processor)
+{
+    if (processor < 0) return false;
+
+#ifdef Q_OS_WIN32
+    if (processor >= int(sizeof(DWORD_PTR) * 8)) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << processor) != 0;
+#endif
+
+#ifdef Q_OS_LINUX
+    return bindCurrentProcess(processor);
+#endif
+
+    return false;
+}
+
+PinnedProcess::PinnedProcess(int _processor, QObject *parent) :
+    QProcess(parent)
+{
+    processor = _processor;
+    connect(this, SIGNAL(started()), this, SLOT(bindStartedProcess()));
+}
+
+void PinnedProcess::setupChildProcess()
+{
+#ifdef Q_OS_LINUX
+    if (processor >= 0) ProcessorPool::bindCurrentProcess(processor);
+#endif
+}
+
+void PinnedProcess::bindStartedProcess()
+{
+#ifdef Q_OS_WIN32
+    if (processor < 0 || processor >= int(sizeof(DWORD_PTR) * 8)) return;
+    if (pid()) SetProcessAffinityMask(pid()->hProcess, DWORD_PTR(1) << processor);
+#endif
+}
@@ -0,0 +1,60 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef PROCESSORPOOL_H
+#define PROCESSORPOOL_H
+
+#include <QtCore>
+#include <QObject>
+
+class ProcessorPool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProcessorPool(QObject *parent = 0);
+    void setHousekeepingProcessor(int);
+    void detectTopology();
+    int getProcessorCount() const;
+    int acquireProcessor();
+    void releaseProcessor(int);
+    static bool bindCurrentProcess(int);
+    static bool bindCurrentThread(int);
+
+private:
+    int housekeepingProcessor;
+    QList<int> processorList;
+    QList<bool> occupied;
+};
+
+class PinnedProcess : public QProcess
+{
+    Q_OBJECT
+public:
+    explicit PinnedProcess(int, QObject *parent = 0);
+
+protected:
+    void setupChildProcess();
+
+private:
+    int processor;
+
+private slots:
+    void bindStartedProcess();
+};
+
+#endif // PROCESSORPOOL_H
@@ -0,0 +1,120 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "remoteconnection.h"
+#include <QTcpSocket>
+
+RemoteConnection::RemoteConnection(QTcpSocket *_socket, QObject *parent) :
+    QObject(parent)
+{
+    socket = _socket;
+    socket->setParent(this);
+    maximumMessageSize = defaultMaximumMessageSize();
+    aborted = false;
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readData()));
+}
+
+QTcpSocket* RemoteConnection::getSocket() const
+{
+    return socket;
+}
+
+void RemoteConnection::sendMessage(int type, const QByteArray &body)
+{
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out << quint32(body.size()) << qint32(type);
+    socket->write(header);
+    socket->write(body);
+}
+
+void RemoteConnection::setMaximumMessageSize(quint32 size)
+{
+    maximumMessageSize = size;
+}
+
+void RemoteConnection::abort()
+{
+    if (aborted) return;
+    aborted = true;
+    buffer.clear();
+    socket->abort();
+    emit connectionAborted();
+}
+
+int RemoteConnection::defaultPort()
+{
+    return 21127;
+}
+
+quint32 RemoteConnection::defaultMaximumMessageSize()
+{
+    return 512 * 1024 * 1024;
+}
+
+QByteArray RemoteConnection::createChallenge()
+{
+    return QCryptographicHash::hash(QUuid::createUuid().toRfc4122() + QUuid::createUuid().toRfc4122()
+                                    + QByteArray::number(QDateTime::currentMSecsSinceEpoch()),
+                                    QCryptographicHash::Sha1);
+}
+
+QByteArray RemoteConnection::getAuthenticationCode(const QByteArray &challenge, const QString &token)
+{
+    QByteArray key = token.toUtf8();
+    if (key.size() > 64) key = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+    key = key.leftJustified(64, '\0');
+    QByteArray innerPad(64, 0x36), outerPad(64, 0x5c);
+    for (int i = 0; i < 64; i ++) {
+        innerPad[i] = char(innerPad.at(i) ^ key.at(i));
+        outerPad[i] = char(outerPad.at(i) ^ key.at(i));
+    }
+    QByteArray inner = QCryptographicHash::hash(innerPad + challenge, QCryptographicHash::Sha1);
+    return QCryptographicHash::hash(outerPad + inner, QCryptographicHash::Sha1);
+}
+
+bool RemoteConnection::checkAuthenticationCode(const QByteArray &challenge, const QString &token,
+                                               const QByteArray &code)
+{
+    QByteArray expected = getAuthenticationCode(challenge, token);
+    if (code.size() != expected.size()) return false;
+    char difference = 0;
+    for (int i = 0; i < expected.size(); i ++)
+        difference |= expected.at(i) ^ code.at(i);
+    return difference == 0;
+}
+
+void RemoteConnection::readData()
+{
+    if (aborted) return;
+    buffer.append(socket->readAll());
+    while (! aborted && buffer.size() >= 8) {
+        QDataStream in(buffer);
+        quint32 length;
+        qint32 type;
+        in >> length >> type;
+        if (length > maximumMessageSize) {
+            abort();
+            return;
+        }
+        if (quint32(buffer.size() - 8) < length) break;
+        QByteArray body = buffer.mid(8, length);
+        buffer.remove(0, 8 + length);
+        emit messageReceived(type, body);
+    }
+}
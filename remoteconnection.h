@@ -0,0 +1,61 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef REMOTECONNECTION_H
+#define REMOTECONNECTION_H
+
+#include <QtCore>
+#include <QObject>
+
+class QTcpSocket;
+
+enum RemoteMessageType { JobMessage = 1, MissingFilesMessage, FileDataMessage,
+                         CaseFinishedMessage, CompileErrorMessage, TaskResultMessage,
+                         JobFinishedMessage, ChallengeMessage, AuthenticationMessage,
+                         AuthenticatedMessage };
+
+class RemoteConnection : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RemoteConnection(QTcpSocket*, QObject *parent = 0);
+    QTcpSocket* getSocket() const;
+    void sendMessage(int, const QByteArray&);
+    void setMaximumMessageSize(quint32);
+    void abort();
+    static int defaultPort();
+    static quint32 defaultMaximumMessageSize();
+    static QByteArray createChallenge();
+    static QByteArray getAuthenticationCode(const QByteArray&, const QString&);
+    static bool checkAuthenticationCode(const QByteArray&, const QString&, const QByteArray&);
+
+private:
+    QTcpSocket *socket;
+    QByteArray buffer;
+    quint32 maximumMessageSize;
+    bool aborted;
+
+private slots:
+    void readData();
+
+signals:
+    void messageReceived(int, const QByteArray&);
+    void connectionAborted();
+};
+
+#endif // REMOTECONNECTION_H
@@ -0,0 +1,279 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "remoteworker.h"
+#include "remoteconnection.h"
+#include "assignmentthread.h"
+#include "settings.h"
+#include "task.h"
+#include "testcase.h"
+#include <QTcpSocket>
+
+RemoteWorker::RemoteWorker(QObject *parent) :
+    QObject(parent)
+{
+    connection = 0;
+    fileHashes = 0;
+    alive = false;
+    failed = false;
+    busy = false;
+    taskIndex = -1;
+    thread = 0;
+    rejudgeThread = 0;
+}
+
+RemoteWorker::~RemoteWorker()
+{
+    clearResult();
+}
+
+void RemoteWorker::setFileHashes(QHash<QString, QString> *hashes)
+{
+    fileHashes = hashes;
+}
+
+void RemoteWorker::setToken(const QString &_token)
+{
+    token = _token;
+}
+
+void RemoteWorker::connectToWorker(const QString &host)
+{
+    hostName = host;
+    QString address = host;
+    int port = RemoteConnection::defaultPort();
+    int colon = host.lastIndexOf(':');
+    if (colon != -1) {
+        address = host.left(colon);
+        port = host.mid(colon + 1).toInt();
+    }
+    QTcpSocket *socket = new QTcpSocket();
+    connection = new RemoteConnection(socket, this);
+    connect(socket, SIGNAL(error(QAbstractSocket::SocketError)),
+            this, SLOT(connectionError()));
+    connect(connection, SIGNAL(connectionAborted()), this, SLOT(connectionError()));
+    connect(connection, SIGNAL(messageReceived(int, QByteArray)),
+            this, SLOT(messageReceived(int, QByteArray)));
+    socket->connectToHost(address, port);
+}
+
+const QString& RemoteWorker::getHostName() const
+{
+    return hostName;
+}
+
+bool RemoteWorker::isAlive() const
+{
+    return alive;
+}
+
+bool RemoteWorker::isFailed() const
+{
+    return failed;
+}
+
+bool RemoteWorker::isBusy() const
+{
+    return busy;
+}
+
+bool RemoteWorker::isIdle() const
+{
+    return alive && ! busy;
+}
+
+void RemoteWorker::startJob(const QString &name, int index, Task *task)
+{
+    clearResult();
+    busy = true;
+    contestantName = name;
+    taskIndex = index;
+    
+    QMap<QString, QByteArray> sourceFiles;
+    QDir contestantDir(Settings::sourcePath() + contestantName);
+    QStringList filters;
+    if (task->getTaskType() == Task::Traditional)
+        filters.append(task->getSourceFileName() + ".*");
+    
+    dataFiles.clear();
+    for (int i = 0; i < task->getTestCaseList().size(); i ++) {
+        TestCase *testCase = task->getTestCase(i);
+        for (int j = 0; j < testCase->getInputFiles().size(); j ++) {
+            QString input = testCase->getInputFiles().at(j);
+            QString output = testCase->getOutputFiles().at(j);
+            dataFiles.insert(QDir::fromNativeSeparators(input), getFileHash(input));
+            dataFiles.insert(QDir::fromNativeSeparators(output), getFileHash(output));
+            if (task->getTaskType() == Task::AnswersOnly)
+                filters.append(QFileInfo(input).completeBaseName() + "." + task->getAnswerFileExtension());
+        }
+    }
+    if (task->getComparisonMode() == Task::SpecialJudgeMode)
+        dataFiles.insert(QDir::fromNativeSeparators(task->getSpecialJudge()),
+                         getFileHash(task->getSpecialJudge()));
+    
+    QStringList fileList = contestantDir.entryList(filters, QDir::Files);
+    for (int i = 0; i < fileList.size(); i ++) {
+        QFile file(contestantDir.filePath(fileList[i]));
+        if (file.open(QFile::ReadOnly)) sourceFiles.insert(fileList[i], file.readAll());
+    }
+    
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out << contestantName;
+    task->writeToStream(out);
+    out << sourceFiles << dataFiles;
+    connection->sendMessage(JobMessage, body);
+}
+
+void RemoteWorker::abandonJob()
+{
+    busy = false;
+    clearResult();
+}
+
+void RemoteWorker::disconnectFromWorker()
+{
+    alive = false;
+    failed = true;
+    busy = false;
+    connection->getSocket()->abort();
+}
+
+const QString& RemoteWorker::getContestantName() const
+{
+    return contestantName;
+}
+
+int RemoteWorker::getTaskIndex() const
+{
+    return taskIndex;
+}
+
+const QList< QList<int> >& RemoteWorker::getProgressList() const
+{
+    return progressList;
+}
+
+const QList< QPair<int, int> >& RemoteWorker::getCompileErrors() const
+{
+    return compileErrors;
+}
+
+AssignmentThread* RemoteWorker::takeThread()
+{
+    AssignmentThread *result = thread;
+    thread = 0;
+    return result;
+}
+
+AssignmentThread* RemoteWorker::takeRejudgeThread()
+{
+    AssignmentThread *result = rejudgeThread;
+    rejudgeThread = 0;
+    return result;
+}
+
+QString RemoteWorker::getFileHash(const QString &fileName)
+{
+    QFileInfo info(Settings::dataPath() + fileName);
+    QString key = QString("%1|%2|%3").arg(info.absoluteFilePath()).arg(info.size())
+                  .arg(info.lastModified().toMSecsSinceEpoch());
+    if (fileHashes && fileHashes->contains(key)) return fileHashes->value(key);
+    
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QFile file(info.filePath());
+    if (file.open(QFile::ReadOnly))
+        while (! file.atEnd()) hash.addData(file.read(1 << 20));
+    QString result = hash.result().toHex();
+    if (fileHashes) fileHashes->insert(key, result);
+    return result;
+}
+
+void RemoteWorker::clearResult()
+{
+    progressList.clear();
+    compileErrors.clear();
+    delete thread;
+    thread = 0;
+    delete rejudgeThread;
+    rejudgeThread = 0;
+}
+
+void RemoteWorker::connectionError()
+{
+    if (failed) return;
+    alive = false;
+    failed = true;
+    emit connectionLost(this);
+}
+
+void RemoteWorker::messageReceived(int type, const QByteArray &body)
+{
+    QDataStream in(body);
+    
+    if (type == ChallengeMessage)
+        connection->sendMessage(AuthenticationMessage, RemoteConnection::getAuthenticationCode(body, token));
+    
+    if (type == AuthenticatedMessage) alive = true;
+    
+    if (type == MissingFilesMessage) {
+        QStringList missingList;
+        in >> missingList;
+        QMapIterator<QString, QString> i(dataFiles);
+        while (i.hasNext()) {
+            i.next();
+            if (! missingList.contains(i.value())) continue;
+            missingList.removeAll(i.value());
+            QFile file(Settings::dataPath() + i.key());
+            QByteArray data;
+            if (file.open(QFile::ReadOnly)) data = file.readAll();
+            QByteArray reply;
+            QDataStream out(&reply, QIODevice::WriteOnly);
+            out << i.value() << data;
+            connection->sendMessage(FileDataMessage, reply);
+        }
+    }
+    
+    if (type == CaseFinishedMessage) {
+        QList< QList<int> > list;
+        in >> list;
+        progressList.append(list);
+    }
+    
+    if (type == CompileErrorMessage) {
+        int progress, compileState;
+        in >> progress >> compileState;
+        compileErrors.append(qMakePair(progress, compileState));
+    }
+    
+    if (type == TaskResultMessage) {
+        bool hasRejudge;
+        in >> hasRejudge;
+        thread = new AssignmentThread();
+        thread->readResultFromStream(in);
+        if (hasRejudge) {
+            rejudgeThread = new AssignmentThread();
+            rejudgeThread->readResultFromStream(in);
+        }
+    }
+    
+    if (type == JobFinishedMessage) {
+        busy = false;
+        emit jobFinished(this);
+    }
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef REMOTEWORKER_H
+#define REMOTEWORKER_H
+
+#include <QtCore>
+#include <QObject>
+#include <QAbstractSocket>
+
+class Task;
+class AssignmentThread;
+class RemoteConnection;
+
+class RemoteWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RemoteWorker(QObject *parent = 0);
+    ~RemoteWorker();
+    void setFileHashes(QHash<QString, QString>*);
+    void setToken(const QString&);
+    void connectToWorker(const QString&);
+    const QString& getHostName() const;
+    bool isAlive() const;
+    bool isFailed() const;
+    bool isBusy() const;
+    bool isIdle() const;
+    void startJob(const QString&, int, Task*);
+    void abandonJob();
+    void disconnectFromWorker();
+    const QString& getContestantName() const;
+    int getTaskIndex() const;
+    const QList< QList<int> >& getProgressList() const;
+    const QList< QPair<int, int> >& getCompileErrors() const;
+    AssignmentThread* takeThread();
+    AssignmentThread* takeRejudgeThread();
+
+private:
+    QString hostName;
+    RemoteConnection *connection;
+    QHash<QString, QString> *fileHashes;
+    QString token;
+    bool alive;
+    bool failed;
+    bool busy;
+    QString contestantName;
+    int taskIndex;
+    QMap<QString, QString> dataFiles;
+    QList< QList<int> > progressList;
+    QList< QPair<int, int> > compileErrors;
+    AssignmentThread *thread;
+    AssignmentThread *rejudgeThread;
+    QString getFileHash(const QString&);
+    void clearResult();
+
+private slots:
+    void connectionError();
+    void messageReceived(int, const QByteArray&);
+
+signals:
+    void jobFinished(RemoteWorker*);
+    void connectionLost(RemoteWorker*);
+};
+
+#endif // REMOTEWORKER_H
@@ -0,0 +1,331 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "resultdatabase.h"
+#include "task.h"
+#include "contestant.h"
+#include "resultexporter.h"
+#include "globaltype.h"
+
+#define BatchSize 8192
+
+static const char *schema[] = {
+    "CREATE TABLE IF NOT EXISTS tasks (task INTEGER PRIMARY KEY, title TEXT)",
+    "CREATE TABLE IF NOT EXISTS states (state INTEGER PRIMARY KEY, name TEXT)",
+    "CREATE TABLE IF NOT EXISTS meta (key TEXT PRIMARY KEY, value TEXT)",
+    "CREATE TABLE IF NOT EXISTS task_results (contestant TEXT, task INTEGER, compile_state INTEGER,"
+    " score INTEGER, time_used INTEGER, judging_time TEXT, PRIMARY KEY (contestant, task))",
+    "CREATE TABLE IF NOT EXISTS case_results (contestant TEXT, task INTEGER, test_case INTEGER,"
+    " case_index INTEGER, state INTEGER, score INTEGER, time_used INTEGER, memory_used INTEGER, message TEXT)",
+    "CREATE INDEX IF NOT EXISTS case_results_by_case ON case_results (task, test_case, case_index, state)",
+    "CREATE INDEX IF NOT EXISTS case_results_by_contestant ON case_results (contestant, task)",
+    "CREATE INDEX IF NOT EXISTS case_results_by_state ON case_results (state, task)"
+};
+
+ResultDatabase::ResultDatabase(QObject *parent) :
+    QObject(parent)
+{
+    connectionName = QString("ResultDatabase%1").arg(quintptr(this));
+    changeCount = 0;
+}
+
+ResultDatabase::~ResultDatabase()
+{
+    close();
+}
+
+bool ResultDatabase::open(const QString &_fileName)
+{
+    close();
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(_fileName);
+        if (! db.open()) {
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(connectionName);
+            return false;
+        }
+    }
+    fileName = _fileName;
+    
+    execute("PRAGMA journal_mode = WAL");
+    execute("PRAGMA synchronous = NORMAL");
+    for (int i = 0; i < int(sizeof(schema) / sizeof(schema[0])); i ++)
+        if (! execute(schema[i])) {
+            close();
+            return false;
+        }
+    
+    QSqlDatabase db = getDatabase();
+    db.transaction();
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO states (state, name) VALUES (?, ?)");
+    for (int i = 0; i <= int(SpecialJudgeRunTimeError); i ++) {
+        query.addBindValue(i);
+        query.addBindValue(ResultExporter::getResultStateName(ResultState(i)));
+        query.exec();
+    }
+    db.commit();
+    
+    QSqlQuery stampQuery("SELECT value FROM meta WHERE key = 'saved_stamp'", db);
+    savedStamp = stampQuery.next() ? stampQuery.value(0).toString() : QString();
+    return true;
+}
+
+void ResultDatabase::close()
+{
+    if (fileName.isEmpty()) return;
+    flush();
+    QSqlDatabase::database(connectionName, false).close();
+    QSqlDatabase::removeDatabase(connectionName);
+    fileName.clear();
+    savedStamp.clear();
+}
+
+bool ResultDatabase::isOpen() const
+{
+    return ! fileName.isEmpty();
+}
+
+bool ResultDatabase::isEmpty() const
+{
+    QSqlQuery query("SELECT COUNT(*) FROM task_results", getDatabase());
+    return ! query.next() || query.value(0).toInt() == 0;
+}
+
+const QString& ResultDatabase::getFileName() const
+{
+    return fileName;
+}
+
+QSqlDatabase ResultDatabase::getDatabase() const
+{
+    return QSqlDatabase::database(connectionName, false);
+}
+
+QString ResultDatabase::databaseFileName(const QString &contestFileName)
+{
+    return QFileInfo(contestFileName).absoluteFilePath() + ".db";
+}
+
+bool ResultDatabase::execute(const QString &statement)
+{
+    QSqlQuery query(getDatabase());
+    return query.exec(statement);
+}
+
+const QString& ResultDatabase::getSavedStamp() const
+{
+    return savedStamp;
+}
+
+void ResultDatabase::setSavedStamp(const QString &stamp)
+{
+    if (! isOpen() || ! flush()) return;
+    QSqlQuery query(getDatabase());
+    query.prepare("INSERT OR REPLACE INTO meta (key, value) VALUES ('saved_stamp', ?)");
+    query.addBindValue(stamp);
+    if (query.exec()) savedStamp = stamp;
+}
+
+int ResultDatabase::getChangeCount() const
+{
+    return changeCount;
+}
+
+// the mirror no longer matches the saved contest file until the next save stamps it again
+void ResultDatabase::clearSavedStamp()
+{
+    changeCount ++;
+    if (savedStamp.isEmpty()) return;
+    if (execute("DELETE FROM meta WHERE key = 'saved_stamp'")) savedStamp.clear();
+}
+
+void ResultDatabase::setTaskList(const QList<Task*> &taskList)
+{
+    if (! isOpen()) return;
+    QSqlDatabase db = getDatabase();
+    db.transaction();
+    clearSavedStamp();
+    execute("DELETE FROM tasks");
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO tasks (task, title) VALUES (?, ?)");
+    for (int i = 0; i < taskList.size(); i ++) {
+        query.addBindValue(i);
+        query.addBindValue(taskList[i]->getProblemTile());
+        query.exec();
+    }
+    db.commit();
+}
+
+void ResultDatabase::addTaskResult(Contestant *contestant, int index)
+{
+    if (! isOpen()) return;
+    changeCount ++;
+    QPair<QString, int> key(contestant->getContestantName(), index);
+    if (pendingTasks.contains(key)) flush();
+    pendingTasks.insert(key);
+    
+    QList< QList<ResultState> > result = contestant->getResult(index);
+    QList< QList<int> > score = contestant->getSocre(index);
+    QList< QList<int> > timeUsed = contestant->getTimeUsed(index);
+    QList< QList<int> > memoryUsed = contestant->getMemoryUsed(index);
+    const QList<QStringList> &message = contestant->getMessage(index);
+    int totalTimeUsed = 0;
+    for (int i = 0; i < result.size(); i ++)
+        for (int j = 0; j < result[i].size(); j ++) {
+            caseContestants.append(key.first);
+            caseTasks.append(index);
+            caseTestCases.append(i);
+            caseIndexes.append(j);
+            caseStates.append(int(result[i][j]));
+            caseScores.append(score.value(i).value(j, 0));
+            caseTimeUsed.append(timeUsed.value(i).value(j, -1));
+            caseMemoryUsed.append(memoryUsed.value(i).value(j, -1));
+            caseMessages.append(message.value(i).value(j));
+            if (timeUsed.value(i).value(j, -1) >= 0) totalTimeUsed += timeUsed[i][j];
+        }
+    
+    taskContestants.append(key.first);
+    taskIndexes.append(index);
+    taskCompileStates.append(int(contestant->getCompileState(index)));
+    taskScores.append(contestant->getTaskScore(index));
+    taskTimeUsed.append(totalTimeUsed);
+    taskJudgingTimes.append(contestant->getJudingTime().toString(Qt::ISODate));
+    
+    if (caseContestants.size() >= BatchSize) flush();
+}
+
+bool ResultDatabase::flush()
+{
+    if (! isOpen() || taskContestants.isEmpty()) return true;
+    QSqlDatabase db = getDatabase();
+    db.transaction();
+    clearSavedStamp();
+    
+    QSqlQuery deleteQuery(db);
+    deleteQuery.prepare("DELETE FROM case_results WHERE contestant = ? AND task = ?");
+    deleteQuery.addBindValue(taskContestants);
+    deleteQuery.addBindValue(taskIndexes);
+    
+    QSqlQuery taskQuery(db);
+    taskQuery.prepare("INSERT OR REPLACE INTO task_results (contestant, task, compile_state, score, time_used, judging_time)"
+                      " VALUES (?, ?, ?, ?, ?, ?)");
+    taskQuery.addBindValue(taskContestants);
+    taskQuery.addBindValue(taskIndexes);
+    taskQuery.addBindValue(taskCompileStates);
+    taskQuery.addBindValue(taskScores);
+    taskQuery.addBindValue(taskTimeUsed);
+    taskQuery.addBindValue(taskJudgingTimes);
+    
+    QSqlQuery caseQuery(db);
+    caseQuery.prepare("INSERT INTO case_results (contestant, task, test_case, case_index, state, score, time_used, memory_used, message)"
+                      " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    caseQuery.addBindValue(caseContestants);
+    caseQuery.addBindValue(caseTasks);
+    caseQuery.addBindValue(caseTestCases);
+    caseQuery.addBindValue(caseIndexes);
+    caseQuery.addBindValue(caseStates);
+    caseQuery.addBindValue(caseScores);
+    caseQuery.addBindValue(caseTimeUsed);
+    caseQuery.addBindValue(caseMemoryUsed);
+    caseQuery.addBindValue(caseMessages);
+    
+    bool succeeded = deleteQuery.execBatch() && taskQuery.execBatch();
+    if (succeeded && ! caseContestants.isEmpty()) succeeded = caseQuery.execBatch();
+    if (succeeded) succeeded = db.commit();
+    if (! succeeded) db.rollback();
+    clearPending();
+    return succeeded;
+}
+
+void ResultDatabase::clearPending()
+{
+    pendingTasks.clear();
+    taskContestants.clear();
+    taskIndexes.clear();
+    taskCompileStates.clear();
+    taskScores.clear();
+    taskTimeUsed.clear();
+    taskJudgingTimes.clear();
+    caseContestants.clear();
+    caseTasks.clear();
+    caseTestCases.clear();
+    caseIndexes.clear();
+    caseStates.clear();
+    caseScores.clear();
+    caseTimeUsed.clear();
+    caseMemoryUsed.clear();
+    caseMessages.clear();
+}
+
+void ResultDatabase::removeContestant(const QString &contestantName)
+{
+    if (! isOpen()) return;
+    flush();
+    QSqlDatabase db = getDatabase();
+    db.transaction();
+    clearSavedStamp();
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM case_results WHERE contestant = ?");
+    query.addBindValue(contestantName);
+    query.exec();
+    query.prepare("DELETE FROM task_results WHERE contestant = ?");
+    query.addBindValue(contestantName);
+    query.exec();
+    db.commit();
+}
+
+void ResultDatabase::removeTask(int index)
+{
+    if (! isOpen()) return;
+    flush();
+    QSqlDatabase db = getDatabase();
+    db.transaction();
+    clearSavedStamp();
+    QSqlQuery query(db);
+    QStringList tableList;
+    tableList << "tasks" << "task_results" << "case_results";
+    for (int i = 0; i < tableList.size(); i ++) {
+        query.prepare(QString("DELETE FROM %1 WHERE task = ?").arg(tableList[i]));
+        query.addBindValue(index);
+        query.exec();
+        query.prepare(QString("UPDATE %1 SET task = -task WHERE task > ?").arg(tableList[i]));
+        query.addBindValue(index);
+        query.exec();
+        query.exec(QString("UPDATE %1 SET task = -task - 1 WHERE task < 0").arg(tableList[i]));
+    }
+    db.commit();
+}
+
+bool ResultDatabase::rebuild(const QList<Task*> &taskList, const QList<Contestant*> &contestantList)
+{
+    if (! isOpen()) return false;
+    clearPending();
+    QSqlDatabase db = getDatabase();
+    db.transaction();
+    clearSavedStamp();
+    execute("DELETE FROM case_results");
+    execute("DELETE FROM task_results");
+    if (! db.commit()) return false;
+    setTaskList(taskList);
+    for (int i = 0; i < contestantList.size(); i ++)
+        for (int j = 0; j < taskList.size(); j ++)
+            if (contestantList[i]->getCheckJudged(j)) addTaskResult(contestantList[i], j);
+    return flush();
+}
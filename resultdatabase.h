@@ -0,0 +1,80 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef RESULTDATABASE_H
+#define RESULTDATABASE_H
+
+#include <QtCore>
+#include <QObject>
+#include <QtSql>
+
+class Task;
+class Contestant;
+
+class ResultDatabase : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ResultDatabase(QObject *parent = 0);
+    ~ResultDatabase();
+    bool open(const QString&);
+    void close();
+    bool isOpen() const;
+    bool isEmpty() const;
+    const QString& getFileName() const;
+    QSqlDatabase getDatabase() const;
+    void setTaskList(const QList<Task*>&);
+    void addTaskResult(Contestant*, int);
+    void removeContestant(const QString&);
+    void removeTask(int);
+    bool rebuild(const QList<Task*>&, const QList<Contestant*>&);
+    const QString& getSavedStamp() const;
+    void setSavedStamp(const QString&);
+    int getChangeCount() const;
+    static QString databaseFileName(const QString&);
+
+private:
+    QString connectionName;
+    QString fileName;
+    QString savedStamp;
+    int changeCount;
+    QSet< QPair<QString, int> > pendingTasks;
+    QVariantList taskContestants;
+    QVariantList taskIndexes;
+    QVariantList taskCompileStates;
+    QVariantList taskScores;
+    QVariantList taskTimeUsed;
+    QVariantList taskJudgingTimes;
+    QVariantList caseContestants;
+    QVariantList caseTasks;
+    QVariantList caseTestCases;
+    QVariantList caseIndexes;
+    QVariantList caseStates;
+    QVariantList caseScores;
+    QVariantList caseTimeUsed;
+    QVariantList caseMemoryUsed;
+    QVariantList caseMessages;
+    bool execute(const QString&);
+    void clearSavedStamp();
+    void clearPending();
+
+public slots:
+    bool flush();
+};
+
+#endif // RESULTDATABASE_H
@@ -0,0 +1,531 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "resultexporter.h"
+#include "contest.h"
+#include "contestant.h"
+#include "task.h"
+#include "globaltype.h"
+
+// the texts below keep the contexts they had in the GUI, so existing translations still apply
+static QString detailText(const char *text)
+{
+    return QCoreApplication::translate("DetailDialog", text);
+}
+
+static QString lemonText(const char *text)
+{
+    return QCoreApplication::translate("Lemon", text);
+}
+
+static QString resultText(ResultState result)
+{
+    switch (result) {
+        case CorrectAnswer: return detailText("Correct Answer");
+        case WrongAnswer: return detailText("Wrong Answer");
+        case PartlyCorrect: return detailText("Partly Correct");
+        case TimeLimitExceeded: return detailText("Time Limit Exceeded");
+        case MemoryLimitExceeded: return detailText("Memory Limit Exceeded");
+        case CannotStartProgram: return detailText("Cannot Start Program");
+        case FileError: return detailText("File Error");
+        case RunTimeError: return detailText("Run Time Error");
+        case InvalidSpecialJudge: return detailText("Invalid Special Judge");
+        case SpecialJudgeTimeLimitExceeded: return detailText("Special Judge Time Limit Exceeded");
+        case SpecialJudgeRunTimeError: return detailText("Special Judge Run Time Error");
+    }
+    return QString();
+}
+
+static const char *stateNames[] = { "CorrectAnswer", "WrongAnswer", "PartlyCorrect",
+                                    "TimeLimitExceeded", "MemoryLimitExceeded",
+                                    "CannotStartProgram", "FileError", "RunTimeError",
+                                    "InvalidSpecialJudge", "SpecialJudgeTimeLimitExceeded",
+                                    "SpecialJudgeRunTimeError" };
+
+static const char *caseFields[] = { "contestant", "task", "test_case", "case_index", "input_file",
+                                    "result", "score", "time_used", "memory_used", "processor", "message" };
+
+static void appendCsvField(QByteArray &out, const QString &text)
+{
+    out += '"';
+    out += text.toUtf8().replace('"', "\"\"");
+    out += '"';
+}
+
+static void appendJsonString(QByteArray &out, const QString &text)
+{
+    QByteArray data = text.toUtf8();
+    out += '"';
+    for (int i = 0; i < data.size(); i ++) {
+        char c = data[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n')
+            out += "\\n";
+        else if (c == '\r')
+            out += "\\r";
+        else if (c == '\t')
+            out += "\\t";
+        else if (uchar(c) < 0x20)
+            out += "\\u00" + QByteArray::number(uchar(c), 16).rightJustified(2, '0');
+        else
+            out += c;
+    }
+    out += '"';
+}
+
+static const char *htmlHead = "<html><head>"
+                              "<meta http-equiv=\"Content-Type\" content=\"text/html; charset=utf-8\" />"
+                              "<style type=\"text/css\">th, td {padding-left: 1em; padding-right: 1em;}</style>";
+
+class DetailsRenderer
+{
+public:
+    typedef QByteArray result_type;
+    
+    DetailsRenderer(const QList<Task*> &_taskList, const QList<Contestant*> &_contestantList,
+                    bool _standalone, const QString &_topLink) :
+        taskList(_taskList), contestantList(_contestantList), standalone(_standalone), topLink(_topLink) {}
+    QByteArray operator()(int index) const
+    {
+        Contestant *contestant = contestantList[index];
+        bool loaded = contestant->isDetailsLoaded();
+        QString html;
+        html.reserve(4096);
+        if (standalone) {
+            html += htmlHead;
+            html += "<title>";
+            html += lemonText("Contestant: %1").arg(contestant->getContestantName());
+            html += "</title></head><body><span style=\"font-size:x-large; font-weight:bold;\">";
+        } else {
+            html += "<a name=\"c";
+            html += QString::number(index);
+            html += "\"><hr><a><span style=\"font-size:x-large; font-weight:bold;\">";
+        }
+        html += lemonText("Contestant: %1").arg(contestant->getContestantName());
+        html += "</span>";
+        ResultExporter::appendDetails(html, taskList, contestant, topLink);
+        if (standalone) html += "</body></html>";
+        if (! loaded) contestant->releaseDetails();
+        return html.toUtf8();
+    }
+
+private:
+    QList<Task*> taskList;
+    QList<Contestant*> contestantList;
+    bool standalone;
+    QString topLink;
+};
+
+class CasesRenderer
+{
+public:
+    typedef QByteArray result_type;
+    
+    CasesRenderer(const QList<Task*> &_taskList, ResultExporter::ExportFormat _format) :
+        taskList(_taskList), format(_format) {}
+    QByteArray operator()(Contestant *contestant) const
+    {
+        bool loaded = contestant->isDetailsLoaded();
+        QByteArray data;
+        ResultExporter::appendCases(data, taskList, contestant, format);
+        if (! loaded) contestant->releaseDetails();
+        return data;
+    }
+
+private:
+    QList<Task*> taskList;
+    ResultExporter::ExportFormat format;
+};
+
+ResultExporter::ResultExporter(QObject *parent) :
+    QThread(parent)
+{
+    contest = 0;
+    format = HtmlFormat;
+    exported = false;
+    canceled = 0;
+}
+
+void ResultExporter::setContest(Contest *_contest)
+{
+    contest = _contest;
+}
+
+void ResultExporter::setExportFile(const QString &_fileName, ExportFormat _format)
+{
+    fileName = _fileName;
+    format = _format;
+    exported = false;
+    canceled = 0;
+}
+
+const QString& ResultExporter::getFileName() const
+{
+    return fileName;
+}
+
+bool ResultExporter::getExported() const
+{
+    return exported;
+}
+
+void ResultExporter::cancel()
+{
+    canceled = 1;
+}
+
+QString ResultExporter::detailsDirectory(const QString &fileName)
+{
+    QFileInfo info(fileName);
+    return info.absoluteDir().absoluteFilePath(info.completeBaseName() + "_files");
+}
+
+QString ResultExporter::getResultStateName(ResultState result)
+{
+    if (int(result) < 0 || int(result) >= int(sizeof(stateNames) / sizeof(stateNames[0]))) return QString();
+    return stateNames[result];
+}
+
+QList< QPair<int, QString> > ResultExporter::getRankList(const QList<Contestant*> &contestantList) const
+{
+    QList< QPair<int, QString> > sortList;
+    for (int i = 0; i < contestantList.size(); i ++) {
+        int totalScore = contestantList[i]->getTotalScore();
+        if (totalScore != -1)
+            sortList.append(qMakePair(-totalScore, contestantList[i]->getContestantName()));
+        else
+            sortList.append(qMakePair(1, contestantList[i]->getContestantName()));
+    }
+    qSort(sortList);
+    return sortList;
+}
+
+void ResultExporter::appendRankList(QString &html, const QList<Contestant*> &contestantList,
+                                    const QString &linkFormat) const
+{
+    const QList<Task*> &taskList = contest->getTaskList();
+    QList< QPair<int, QString> > sortList = getRankList(contestantList);
+    QMap<QString, int> loc;
+    for (int i = 0; i < contestantList.size(); i ++)
+        loc.insert(contestantList[i]->getContestantName(), i);
+    
+    html += "<p><span style=\"font-size:x-large; font-weight:bold;\">";
+    html += "<a name=\"top\"></a>";
+    html += lemonText("Rank List");
+    html += "</span></p><p><table border=\"1\" cellpadding=\"1\"><tr>";
+    html += "<th scope=\"col\" nowrap=\"nowrap\">" + lemonText("Rank") + "</th>";
+    html += "<th scope=\"col\" nowrap=\"nowrap\">" + lemonText("Name") + "</th>";
+    for (int i = 0; i < taskList.size(); i ++)
+        html += "<th scope=\"col\" nowrap=\"nowrap\">" + taskList[i]->getProblemTile() + "</th>";
+    html += "<th scope=\"col\" nowrap=\"nowrap\">" + lemonText("Total Score") + "</th></tr>";
+    
+    QString invalid = lemonText("Invalid");
+    int rank = 0;
+    for (int i = 0; i < sortList.size(); i ++) {
+        if (i == 0 || sortList[i].first != sortList[i - 1].first) rank = i;
+        Contestant *contestant = contestantList[loc.value(sortList[i].second)];
+        html += "<tr><td nowrap=\"nowrap\" align=\"center\">";
+        html += QString::number(rank + 1);
+        html += "</td><td nowrap=\"nowrap\" align=\"center\"><a href=\"";
+        html += linkFormat.arg(loc.value(sortList[i].second));
+        html += "\">";
+        html += sortList[i].second;
+        html += "</a></td>";
+        for (int j = 0; j <= taskList.size(); j ++) {
+            int score = j < taskList.size() ? contestant->getTaskScore(j) : contestant->getTotalScore();
+            html += "<td nowrap=\"nowrap\" align=\"center\">";
+            html += score != -1 ? QString::number(score) : invalid;
+            html += "</td>";
+        }
+        html += "</tr>";
+    }
+    html += "</table></p>";
+}
+
+void ResultExporter::appendDetails(QString &html, const QList<Task*> &taskList,
+                                   Contestant *contestant, const QString &topLink)
+{
+    for (int i = 0; i < taskList.size(); i ++) {
+        html += "<p><span style=\"font-weight:bold; font-size:large;\">";
+        html += detailText("Task") + " " + taskList[i]->getProblemTile() + "</span><br>";
+        
+        if (! contestant->getCheckJudged(i)) {
+            html += "&nbsp;&nbsp;" + detailText("Not judged") + "</p>";
+            continue;
+        }
+        
+        if (taskList[i]->getTaskType() == Task::Traditional) {
+            if (contestant->getCompileState(i) != CompileSuccessfully) {
+                switch (contestant->getCompileState(i)) {
+                    case NoValidSourceFile: {
+                        html += "&nbsp;&nbsp;" + detailText("Cannot find valid source file") + "</p>";
+                        break;
+                    }
+                    case CompileTimeLimitExceeded: {
+                        html += "&nbsp;&nbsp;" + detailText("Source file: ") + contestant->getSourceFile(i) + "<br>";
+                        html += "&nbsp;&nbsp;" + detailText("Compile time limit exceeded") + "</p>";
+                        break;
+                    }
+                    case InvalidCompiler: {
+                        html += "&nbsp;&nbsp;" + detailText("Cannot run given compiler") + "</p>";
+                        break;
+                    }
+                    case CompileError: {
+                        html += "&nbsp;&nbsp;" + detailText("Source file: ") + contestant->getSourceFile(i) + "<br>";
+                        html += "&nbsp;&nbsp;" + detailText("Compile error");
+                        if (! contestant->getCompileMessage(i).isEmpty()) {
+                            QString compileMessage = contestant->getCompileMessage(i);
+                            compileMessage.replace("\r\n", "<br>");
+                            compileMessage.replace("\n", "<br>");
+                            compileMessage.replace("\r", "<br>");
+                            if (compileMessage.endsWith("<br>"))
+                                compileMessage.chop(4);
+                            html += "<table border=\"1\" cellpadding=\"1\">";
+                            html += "<tr><td style=\"padding: 0.5em\"><code>";
+                            html += compileMessage;
+                            html += "</code></td></tr></table>";
+                        }
+                        html += "</p>";
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                continue;
+            }
+            html += "&nbsp;&nbsp;" + detailText("Source file: ") + contestant->getSourceFile(i);
+        }
+        
+        html += "<table border=\"1\" cellpadding=\"1\"><tr>";
+        html += "<th scope=\"col\" nowrap=\"nowrap\">" + detailText("Test Case") + "</th>";
+        html += "<th scope=\"col\" nowrap=\"nowrap\">" + detailText("Input File") + "</th>";
+        html += "<th scope=\"col\">" + detailText("Result") + "</th>";
+        html += "<th scope=\"col\" nowrap=\"nowrap\">" + detailText("Time Used") + "</th>";
+        html += "<th scope=\"col\" nowrap=\"nowrap\">" + detailText("Memory Used") + "</th>";
+        html += "<th scope=\"col\" nowrap=\"nowrap\">" + detailText("Score") + "</th></tr>";
+        
+        const QList<QStringList> &inputFiles = contestant->getInputFiles(i);
+        QList< QList<ResultState> > result = contestant->getResult(i);
+        const QList<QStringList> &message = contestant->getMessage(i);
+        QList< QList<int> > timeUsed = contestant->getTimeUsed(i);
+        QList< QList<int> > memoryUsed = contestant->getMemoryUsed(i);
+        QList< QList<int> > processorUsed = contestant->getProcessorUsed(i);
+        QList< QList<int> > score = contestant->getSocre(i);
+        QString invalid = detailText("Invalid");
+        
+        for (int j = 0; j < inputFiles.size(); j ++) {
+            for (int k = 0; k < inputFiles[j].size(); k ++) {
+                html += "<tr>";
+                if (k == 0) {
+                    html += "<td nowrap=\"nowrap\" rowspan=\"" + QString::number(inputFiles[j].size());
+                    html += "\" align=\"center\" valign=\"middle\">#" + QString::number(j + 1) + "</td>";
+                }
+                
+                html += "<td nowrap=\"nowrap\" align=\"center\">" + inputFiles[j][k] + "</td>";
+                html += "<td align=\"center\">" + resultText(result[j][k]);
+                if (! message[j][k].isEmpty()) {
+                    QString tmp = message[j][k];
+                    tmp.replace("\n", "\\n");
+                    tmp.replace("\"", "\\");
+                    html += "<a href=\"javascript:alert(&quot;" + tmp + "&quot;)\"> (...)";
+                }
+                html += "</td>";
+                
+                html += "<td nowrap=\"nowrap\" align=\"center\">";
+                if (timeUsed[j][k] != -1)
+                    html += QString::number(double(timeUsed[j][k]) / 1000, 'f', 3) + " s";
+                else
+                    html += invalid;
+                if (processorUsed.value(j).value(k, -1) >= 0)
+                    html += " (" + detailText("CPU %1").arg(processorUsed[j][k]) + ")";
+                html += "</td>";
+                
+                html += "<td nowrap=\"nowrap\" align=\"center\">";
+                if (memoryUsed[j][k] != -1)
+                    html += QString::number(double(memoryUsed[j][k]) / 1024 / 1024, 'f', 3) + " MB";
+                else
+                    html += invalid;
+                html += "</td>";
+                
+                if (k == 0) {
+                    html += "<td rowspan=\"" + QString::number(inputFiles[j].size());
+                    html += "\" align=\"center\" valign=\"middle\">";
+                    int minv = 1000000000;
+                    for (int t = 0; t < inputFiles[j].size(); t ++)
+                        if (score[j][t] < minv) minv = score[j][t];
+                    html += QString::number(minv) + "</td>";
+                }
+                
+                html += "</tr>";
+            }
+        }
+        
+        html += "</table><br></p>";
+    }
+    
+    html += "<p><a href=\"" + topLink + "\">" + detailText("Return to top") + "</a></p>";
+}
+
+bool ResultExporter::exportFile(const QString &_fileName, ExportFormat _format)
+{
+    contest->waitForSave();
+    setExportFile(_fileName, _format);
+    run();
+    return exported;
+}
+
+void ResultExporter::run()
+{
+    if (format == HtmlFormat || format == SplitHtmlFormat)
+        exported = exportHtml(fileName, format == SplitHtmlFormat);
+    else
+        exported = exportCases(fileName, format);
+}
+
+bool ResultExporter::exportHtml(const QString &fileName, bool splitDetails)
+{
+    QFile file(fileName);
+    if (! file.open(QFile::WriteOnly)) return false;
+    
+    QList<Contestant*> contestantList = contest->getContestantList();
+    const QList<Task*> &taskList = contest->getTaskList();
+    QString directory = detailsDirectory(fileName);
+    QString linkFormat = "#c%1";
+    QString topLink = "#top";
+    if (splitDetails) {
+        if (! QDir().mkpath(directory)) return false;
+        linkFormat = QFileInfo(directory).fileName() + "/c%1.html";
+        topLink = "../" + QFileInfo(fileName).fileName() + "#top";
+    }
+    
+    QString html = htmlHead;
+    html += "<title>" + lemonText("Contest Result") + "</title></head><body>";
+    appendRankList(html, contestantList, linkFormat);
+    QByteArray data = html.toUtf8();
+    html.clear();
+    if (file.write(data) != data.size()) return false;
+    
+    emit progressRangeChanged(0, contestantList.size());
+    int batchSize = qMax(QThread::idealThreadCount(), 1) * 4;
+    DetailsRenderer renderer(taskList, contestantList, splitDetails, topLink);
+    for (int start = 0; start < contestantList.size(); start += batchSize) {
+        QList<int> indexList;
+        for (int i = start; i < contestantList.size() && i < start + batchSize; i ++)
+            indexList.append(i);
+        QList<QByteArray> chunkList = QtConcurrent::blockingMapped(indexList, renderer);
+        for (int i = 0; i < chunkList.size(); i ++) {
+            if (splitDetails) {
+                QFile detailsFile(QDir(directory).absoluteFilePath(QString("c%1.html").arg(indexList[i])));
+                if (! detailsFile.open(QFile::WriteOnly)) return false;
+                if (detailsFile.write(chunkList[i]) != chunkList[i].size()) return false;
+            } else if (file.write(chunkList[i]) != chunkList[i].size())
+                return false;
+        }
+        emit progressValueChanged(start + indexList.size());
+        if (canceled) return false;
+    }
+    
+    data = QByteArray("</body></html>");
+    return file.write(data) == data.size();
+}
+
+void ResultExporter::appendCases(QByteArray &out, const QList<Task*> &taskList, Contestant *contestant, ExportFormat format)
+{
+    for (int i = 0; i < taskList.size(); i ++) {
+        if (! contestant->getCheckJudged(i)) continue;
+        const QList<QStringList> &inputFiles = contestant->getInputFiles(i);
+        QList< QList<ResultState> > result = contestant->getResult(i);
+        const QList<QStringList> &message = contestant->getMessage(i);
+        QList< QList<int> > timeUsed = contestant->getTimeUsed(i);
+        QList< QList<int> > memoryUsed = contestant->getMemoryUsed(i);
+        QList< QList<int> > processorUsed = contestant->getProcessorUsed(i);
+        QList< QList<int> > score = contestant->getSocre(i);
+        
+        for (int j = 0; j < result.size(); j ++)
+            for (int k = 0; k < result[j].size(); k ++) {
+                QByteArray testCase = QByteArray::number(j), caseIndex = QByteArray::number(k);
+                int time = timeUsed.value(j).value(k, -1);
+                int memory = memoryUsed.value(j).value(k, -1);
+                int processor = processorUsed.value(j).value(k, -1);
+                if (format == CsvFormat) {
+                    appendCsvField(out, contestant->getContestantName());
+                    out += ',';
+                    appendCsvField(out, taskList[i]->getProblemTile());
+                    out += ',' + testCase + ',' + caseIndex + ',';
+                    appendCsvField(out, inputFiles.value(j).value(k));
+                    out += ',' + getResultStateName(result[j][k]).toUtf8() + ',';
+                    out += QByteArray::number(score.value(j).value(k, 0)) + ',';
+                    if (time != -1) out += QByteArray::number(time);
+                    out += ',';
+                    if (memory != -1) out += QByteArray::number(memory);
+                    out += ',';
+                    if (processor != -1) out += QByteArray::number(processor);
+                    out += ',';
+                    appendCsvField(out, message.value(j).value(k));
+                    out += "\r\n";
+                } else {
+                    out += "{\"contestant\":";
+                    appendJsonString(out, contestant->getContestantName());
+                    out += ",\"task\":";
+                    appendJsonString(out, taskList[i]->getProblemTile());
+                    out += ",\"test_case\":" + testCase + ",\"case_index\":" + caseIndex;
+                    out += ",\"input_file\":";
+                    appendJsonString(out, inputFiles.value(j).value(k));
+                    out += ",\"result\":\"" + getResultStateName(result[j][k]).toUtf8() + '"';
+                    out += ",\"score\":" + QByteArray::number(score.value(j).value(k, 0));
+                    out += ",\"time_used\":" + (time != -1 ? QByteArray::number(time) : QByteArray("null"));
+                    out += ",\"memory_used\":" + (memory != -1 ? QByteArray::number(memory) : QByteArray("null"));
+                    out += ",\"processor\":" + (processor != -1 ? QByteArray::number(processor) : QByteArray("null"));
+                    out += ",\"message\":";
+                    appendJsonString(out, message.value(j).value(k));
+                    out += "}\n";
+                }
+            }
+    }
+}
+
+bool ResultExporter::exportCases(const QString &fileName, ExportFormat format)
+{
+    QFile file(fileName);
+    if (! file.open(QFile::WriteOnly)) return false;
+    
+    QList<Contestant*> contestantList = contest->getContestantList();
+    if (format == CsvFormat) {
+        QByteArray header;
+        for (int i = 0; i < int(sizeof(caseFields) / sizeof(caseFields[0])); i ++) {
+            if (i > 0) header += ',';
+            header += caseFields[i];
+        }
+        header += "\r\n";
+        if (file.write(header) != header.size()) return false;
+    }
+    
+    emit progressRangeChanged(0, contestantList.size());
+    int batchSize = qMax(QThread::idealThreadCount(), 1) * 4;
+    CasesRenderer renderer(contest->getTaskList(), format);
+    for (int start = 0; start < contestantList.size(); start += batchSize) {
+        QList<QByteArray> chunkList = QtConcurrent::blockingMapped(contestantList.mid(start, batchSize), renderer);
+        for (int i = 0; i < chunkList.size(); i ++)
+            if (file.write(chunkList[i]) != chunkList[i].size()) return false;
+        emit progressValueChanged(start + chunkList.size());
+        if (canceled) return false;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef RESULTEXPORTER_H
+#define RESULTEXPORTER_H
+
+#include <QtCore>
+#include <QThread>
+#include "globaltype.h"
+
+class Contest;
+class Contestant;
+class Task;
+
+class ResultExporter : public QThread
+{
+    Q_OBJECT
+public:
+    enum ExportFormat { HtmlFormat, SplitHtmlFormat, CsvFormat, JsonLinesFormat };
+    
+    explicit ResultExporter(QObject *parent = 0);
+    void setContest(Contest*);
+    void setExportFile(const QString&, ExportFormat);
+    const QString& getFileName() const;
+    bool getExported() const;
+    bool exportFile(const QString&, ExportFormat);
+    void run();
+    static QString detailsDirectory(const QString&);
+    static QString getResultStateName(ResultState);
+    static void appendDetails(QString&, const QList<Task*>&, Contestant*, const QString&);
+    static void appendCases(QByteArray&, const QList<Task*>&, Contestant*, ExportFormat);
+
+private:
+    Contest *contest;
+    QString fileName;
+    ExportFormat format;
+    bool exported;
+    QAtomicInt canceled;
+    bool exportHtml(const QString&, bool);
+    bool exportCases(const QString&, ExportFormat);
+    QList< QPair<int, QString> > getRankList(const QList<Contestant*>&) const;
+    void appendRankList(QString&, const QList<Contestant*>&, const QString&) const;
+
+signals:
+    void progressRangeChanged(int, int);
+    void progressValueChanged(int);
+
+public slots:
+    void cancel();
+};
+
+#endif // RESULTEXPORTER_H
@@ -0,0 +1,117 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "resultjournal.h"
+#include "contestfile.h"
+
+#define JournalMagicNumber 0x20121128
+
+ResultJournal::ResultJournal(QObject *parent) :
+    QObject(parent)
+{
+    unsyncedRecords = 0;
+    syncTimer = new QTimer(this);
+    syncTimer->setSingleShot(true);
+    syncTimer->setInterval(1000);
+    connect(syncTimer, SIGNAL(timeout()), this, SLOT(sync()));
+}
+
+ResultJournal::~ResultJournal()
+{
+    close();
+}
+
+bool ResultJournal::open(const QString &fileName, bool truncate)
+{
+    close();
+    qint64 validLength = 0;
+    if (! truncate) readRecords(fileName, &validLength);
+    
+    file.setFileName(fileName);
+    if (! file.open(QFile::ReadWrite)) return false;
+    if (validLength == 0) {
+        file.resize(0);
+        QDataStream out(&file);
+        out << quint32(JournalMagicNumber);
+        validLength = file.pos();
+        unsyncedRecords = 1;
+    } else
+        file.resize(validLength);
+    file.seek(validLength);
+    sync();
+    return true;
+}
+
+void ResultJournal::close()
+{
+    if (! file.isOpen()) return;
+    sync();
+    file.close();
+}
+
+bool ResultJournal::isOpen() const
+{
+    return file.isOpen();
+}
+
+void ResultJournal::appendRecord(RecordType type, const QByteArray &payload)
+{
+    if (! file.isOpen()) return;
+    QDataStream out(&file);
+    out << quint32(type) << quint32(payload.size()) << ContestFile::checksum(payload);
+    out.writeRawData(payload.constData(), payload.size());
+    unsyncedRecords ++;
+    if (type != TaskResultRecord || unsyncedRecords >= 32)
+        sync();
+    else if (! syncTimer->isActive())
+        syncTimer->start();
+}
+
+void ResultJournal::sync()
+{
+    syncTimer->stop();
+    if (! file.isOpen() || unsyncedRecords == 0) return;
+    unsyncedRecords = 0;
+    ContestFile::sync(&file);
+}
+
+QList< QPair<int, QByteArray> > ResultJournal::readRecords(const QString &fileName, qint64 *validLength)
+{
+    QList< QPair<int, QByteArray> > records;
+    if (validLength) *validLength = 0;
+    QFile file(fileName);
+    if (! file.open(QFile::ReadOnly)) return records;
+    
+    QDataStream in(&file);
+    quint32 checkNumber;
+    in >> checkNumber;
+    if (in.status() != QDataStream::Ok || checkNumber != quint32(JournalMagicNumber)) return records;
+    if (validLength) *validLength = file.pos();
+    
+    while (! in.atEnd()) {
+        quint32 type, length, crc;
+        in >> type >> length >> crc;
+        if (in.status() != QDataStream::Ok || qint64(length) > file.size() - file.pos()) break;
+        QByteArray payload(int(length), 0);
+        if (in.readRawData(payload.data(), int(length)) != int(length)) break;
+        if (ContestFile::checksum(payload) != crc) break;
+        records.append(qMakePair(int(type), payload));
+        if (validLength) *validLength = file.pos();
+    }
+    return records;
+}
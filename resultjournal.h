@@ -0,0 +1,48 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef RESULTJOURNAL_H
+#define RESULTJOURNAL_H
+
+#include <QtCore>
+#include <QObject>
+
+class ResultJournal : public QObject
+{
+    Q_OBJECT
+public:
+    enum RecordType { RunStartedRecord = 1, TaskResultRecord, RunFinishedRecord };
+    
+    explicit ResultJournal(QObject *parent = 0);
+    ~ResultJournal();
+    bool open(const QString&, bool);
+    void close();
+    bool isOpen() const;
+    void appendRecord(RecordType, const QByteArray&);
+    static QList< QPair<int, QByteArray> > readRecords(const QString&, qint64 *validLength = 0);
+
+private:
+    QFile file;
+    QTimer *syncTimer;
+    int unsyncedRecords;
+
+public slots:
+    void sync();
+};
+
+#endif // RESULTJOURNAL_H
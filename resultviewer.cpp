@@ -174,24 +174,77 @@ void ResultViewer::judgeSelected()
     for (int i = 0; i < selectionRange.size(); i ++)
         for (int j = selectionRange[i].topRow(); j <= selectionRange[i].bottomRow(); j ++)
             nameList.append(item(j, 0)->text());
+    if (curContest->isJudging()) {
+        for (int i = 0; i < nameList.size(); i ++)
+            curContest->addPriorityJudging(nameList[i]);
+        return;
+    }
     JudgingDialog *dialog = new JudgingDialog(this);
     dialog->setModal(true);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
     dialog->setContest(curContest);
+    connect(dialog, SIGNAL(finished(int)), this, SLOT(judgingDialogFinished()));
     dialog->show();
     dialog->judge(nameList);
-    delete dialog;
-    refreshViewer();
 }
 
 void ResultViewer::judgeAll()
 {
     JudgingDialog *dialog = new JudgingDialog(this);
     dialog->setModal(true);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
     dialog->setContest(curContest);
+    connect(dialog, SIGNAL(finished(int)), this, SLOT(judgingDialogFinished()));
     dialog->show();
     dialog->judgeAll();
-    delete dialog;
+}
+
+void ResultViewer::judgeStale()
+{
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QList< QPair<QString, int> > jobList = curContest->getStaleJobs();
+    QApplication::restoreOverrideCursor();
+    if (jobList.isEmpty()) {
+        QMessageBox::information(this, tr("Lemon"), tr("All results are up to date"), QMessageBox::Close);
+        return;
+    }
+    judge(jobList);
+}
+
+void ResultViewer::recheck()
+{
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QList< QPair<QString, int> > jobList = curContest->getRecheckJobs();
+    QApplication::restoreOverrideCursor();
+    if (jobList.isEmpty()) {
+        QMessageBox::information(this, tr("Lemon"), tr("No results can be re-checked from archived outputs"),
+                                 QMessageBox::Close);
+        return;
+    }
+    JudgingDialog *dialog = new JudgingDialog(this);
+    dialog->setModal(true);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setContest(curContest);
+    connect(dialog, SIGNAL(finished(int)), this, SLOT(judgingDialogFinished()));
+    dialog->show();
+    dialog->recheck(jobList);
+}
+
+void ResultViewer::judge(const QList< QPair<QString, int> > &jobList)
+{
+    JudgingDialog *dialog = new JudgingDialog(this);
+    dialog->setModal(true);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setContest(curContest);
+    connect(dialog, SIGNAL(finished(int)), this, SLOT(judgingDialogFinished()));
+    dialog->show();
+    dialog->judge(jobList);
+}
+
+void ResultViewer::judgingDialogFinished()
+{
     refreshViewer();
+    emit judgingFinished();
 }
 
 void ResultViewer::clearPath(const QString &curDir)
@@ -38,6 +38,9 @@ public slots:
     void refreshViewer();
     void judgeSelected();
     void judgeAll();
+    void judgeStale();
+    void recheck();
+    void judge(const QList< QPair<QString, int> >&);
 
 private:
     Contest *curContest;
@@ -50,9 +53,11 @@ private:
 private slots:
     void deleteContestant();
     void detailInformation();
+    void judgingDialogFinished();
 
 signals:
     void contestantDeleted();
+    void judgingFinished();
 };
 
 #endif // RESULTVIEWER_H
@@ -18,6 +18,7 @@
 
 #include "settings.h"
 #include "compiler.h"
+#include "globaltype.h"
 
 Settings::Settings(QObject *parent) :
     QObject(parent)
@@ -59,6 +60,66 @@ int Settings::getNumberOfThreads() const
     return numberOfThreads;
 }
 
+bool Settings::getPinJudgingThreads() const
+{
+    return pinJudgingThreads;
+}
+
+int Settings::getHousekeepingProcessor() const
+{
+    return housekeepingProcessor;
+}
+
+int Settings::getMemoryBudget() const
+{
+    return memoryBudget;
+}
+
+int Settings::getCompileAheadDepth() const
+{
+    return compileAheadDepth;
+}
+
+int Settings::getCompileCacheSizeLimit() const
+{
+    return compileCacheSizeLimit;
+}
+
+bool Settings::getAdaptiveConcurrency() const
+{
+    return adaptiveConcurrency;
+}
+
+int Settings::getMinimumNumberOfThreads() const
+{
+    return minimumNumberOfThreads;
+}
+
+int Settings::getTimingNoiseTarget() const
+{
+    return timingNoiseTarget;
+}
+
+int Settings::getAutoSaveInterval() const
+{
+    return autoSaveInterval;
+}
+
+int Settings::getCompressionCodec() const
+{
+    return compressionCodec;
+}
+
+int Settings::getCompressionLevel() const
+{
+    return compressionLevel;
+}
+
+bool Settings::getResultDatabaseEnabled() const
+{
+    return resultDatabaseEnabled;
+}
+
 const QString& Settings::getDefaultInputFileExtension() const
 {
     return defaultInputFileExtension;
@@ -79,6 +140,16 @@ const QStringList& Settings::getOutputFileExtensions() const
     return outputFileExtensions;
 }
 
+const QStringList& Settings::getWorkerHosts() const
+{
+    return workerHosts;
+}
+
+const QString& Settings::getWorkerToken() const
+{
+    return workerToken;
+}
+
 const QStringList& Settings::getRecentContest() const
 {
     return recentContest;
@@ -134,6 +205,66 @@ void Settings::setNumberOfThreads(int number)
     numberOfThreads = number;
 }
 
+void Settings::setPinJudgingThreads(bool check)
+{
+    pinJudgingThreads = check;
+}
+
+void Settings::setHousekeepingProcessor(int processor)
+{
+    housekeepingProcessor = processor;
+}
+
+void Settings::setMemoryBudget(int budget)
+{
+    memoryBudget = budget;
+}
+
+void Settings::setCompileAheadDepth(int depth)
+{
+    compileAheadDepth = depth;
+}
+
+void Settings::setCompileCacheSizeLimit(int limit)
+{
+    compileCacheSizeLimit = limit;
+}
+
+void Settings::setAdaptiveConcurrency(bool check)
+{
+    adaptiveConcurrency = check;
+}
+
+void Settings::setMinimumNumberOfThreads(int number)
+{
+    minimumNumberOfThreads = number;
+}
+
+void Settings::setTimingNoiseTarget(int target)
+{
+    timingNoiseTarget = target;
+}
+
+void Settings::setAutoSaveInterval(int interval)
+{
+    autoSaveInterval = interval;
+}
+
+void Settings::setCompressionCodec(int codec)
+{
+    compressionCodec = codec;
+}
+
+void Settings::setCompressionLevel(int level)
+{
+    compressionLevel = level;
+}
+
+void Settings::setResultDatabaseEnabled(bool check)
+{
+    resultDatabaseEnabled = check;
+}
+
 void Settings::setDefaultInputFileExtension(const QString &extension)
 {
     defaultInputFileExtension = extension;
@@ -154,6 +285,16 @@ void Settings::setOutputFileExtensions(const QString &extensions)
     outputFileExtensions = extensions.split(";", QString::SkipEmptyParts);
 }
 
+void Settings::setWorkerHosts(const QString &hosts)
+{
+    workerHosts = hosts.split(";", QString::SkipEmptyParts);
+}
+
+void Settings::setWorkerToken(const QString &token)
+{
+    workerToken = token;
+}
+
 void Settings::setRecentContest(const QStringList &list)
 {
     recentContest = list;
@@ -202,10 +343,24 @@ void Settings::copyFrom(Settings *other)
     setSpecialJudgeTimeLimit(other->getSpecialJudgeTimeLimit());
     setFileSizeLimit(other->getFileSizeLimit());
     setNumberOfThreads(other->getNumberOfThreads());
+    setPinJudgingThreads(other->getPinJudgingThreads());
+    setHousekeepingProcessor(other->getHousekeepingProcessor());
+    setMemoryBudget(other->getMemoryBudget());
+    setCompileAheadDepth(other->getCompileAheadDepth());
+    setCompileCacheSizeLimit(other->getCompileCacheSizeLimit());
+    setAdaptiveConcurrency(other->getAdaptiveConcurrency());
+    setMinimumNumberOfThreads(other->getMinimumNumberOfThreads());
+    setTimingNoiseTarget(other->getTimingNoiseTarget());
+    setAutoSaveInterval(other->getAutoSaveInterval());
+    setCompressionCodec(other->getCompressionCodec());
+    setCompressionLevel(other->getCompressionLevel());
+    setResultDatabaseEnabled(other->getResultDatabaseEnabled());
     setDefaultInputFileExtension(other->getDefaultInputFileExtension());
     setDefaultOutputFileExtension(other->getDefaultOutputFileExtension());
     setInputFileExtensions(other->getInputFileExtensions().join(";"));
     setOutputFileExtensions(other->getOutputFileExtensions().join(";"));
+    setWorkerHosts(other->getWorkerHosts().join(";"));
+    setWorkerToken(other->getWorkerToken());
     
     for (int i = 0; i < compilerList.size(); i ++)
         delete compilerList[i];
@@ -232,10 +387,24 @@ void Settings::saveSettings()
     settings.setValue("SpecialJudgeTimeLimit", specialJudgeTimeLimit);
     settings.setValue("FileSizeLimit", fileSizeLimit);
     settings.setValue("NumberOfThreads", numberOfThreads);
+    settings.setValue("PinJudgingThreads", pinJudgingThreads);
+    settings.setValue("HousekeepingProcessor", housekeepingProcessor);
+    settings.setValue("MemoryBudget", memoryBudget);
+    settings.setValue("CompileAheadDepth", compileAheadDepth);
+    settings.setValue("CompileCacheSizeLimit", compileCacheSizeLimit);
+    settings.setValue("AdaptiveConcurrency", adaptiveConcurrency);
+    settings.setValue("MinimumNumberOfThreads", minimumNumberOfThreads);
+    settings.setValue("TimingNoiseTarget", timingNoiseTarget);
+    settings.setValue("AutoSaveInterval", autoSaveInterval);
+    settings.setValue("CompressionCodec", compressionCodec);
+    settings.setValue("CompressionLevel", compressionLevel);
+    settings.setValue("ResultDatabaseEnabled", resultDatabaseEnabled);
     settings.setValue("DefaultInputFileExtension", defaultInputFileExtension);
     settings.setValue("DefaultOutputFileExtension", defaultOutputFileExtension);
     settings.setValue("InputFileExtensions", inputFileExtensions);
     settings.setValue("OutputFileExtensions", outputFileExtensions);
+    settings.setValue("WorkerHosts", workerHosts);
+    settings.setValue("WorkerToken", workerToken);
     settings.endGroup();
     
     settings.beginWriteArray("v1.1/CompilerSettings");
@@ -292,10 +461,24 @@ void Settings::loadSettings()
     specialJudgeTimeLimit = settings.value("SpecialJudgeTimeLimit", 10000).toInt();
     fileSizeLimit = settings.value("FileSizeLimit", 50).toInt();
     numberOfThreads = settings.value("NumberOfThreads", 1).toInt();
+    pinJudgingThreads = settings.value("PinJudgingThreads", false).toBool();
+    housekeepingProcessor = settings.value("HousekeepingProcessor", 0).toInt();
+    memoryBudget = settings.value("MemoryBudget", 0).toInt();
+    compileAheadDepth = settings.value("CompileAheadDepth", 2).toInt();
+    compileCacheSizeLimit = settings.value("CompileCacheSizeLimit", 256).toInt();
+    adaptiveConcurrency = settings.value("AdaptiveConcurrency", false).toBool();
+    minimumNumberOfThreads = settings.value("MinimumNumberOfThreads", 1).toInt();
+    timingNoiseTarget = settings.value("TimingNoiseTarget", 5).toInt();
+    autoSaveInterval = settings.value("AutoSaveInterval", 5).toInt();
+    compressionCodec = settings.value("CompressionCodec", int(Lz4Compression)).toInt();
+    compressionLevel = settings.value("CompressionLevel", 6).toInt();
+    resultDatabaseEnabled = settings.value("ResultDatabaseEnabled", false).toBool();
     defaultInputFileExtension = settings.value("DefaultInputFileExtension", "in").toString();
     defaultOutputFileExtension = settings.value("DefaultOuputFileExtension", "out").toString();
     inputFileExtensions = settings.value("InputFileExtensions", QStringList() << "in").toStringList();
     outputFileExtensions = settings.value("OutputFileExtensions", QStringList() << "out" << "ans").toStringList();
+    workerHosts = settings.value("WorkerHosts").toStringList();
+    workerToken = settings.value("WorkerToken").toString();
     settings.endGroup();
     
     int compilerCount = settings.beginReadArray("v1.1/CompilerSettings");
@@ -372,6 +555,31 @@ int Settings::upperBoundForNumberOfThreads()
     return 8;
 }
 
+int Settings::upperBoundForMemoryBudget()
+{
+    return 1024 * 1024;
+}
+
+int Settings::upperBoundForCompileAheadDepth()
+{
+    return 16;
+}
+
+int Settings::upperBoundForCompileCacheSizeLimit()
+{
+    return 1024 * 1024;
+}
+
+int Settings::upperBoundForTimingNoiseTarget()
+{
+    return 100;
+}
+
+int Settings::upperBoundForAutoSaveInterval()
+{
+    return 1440;
+}
+
 QString Settings::dataPath()
 {
     return QString("data") + QDir::separator();
@@ -387,6 +595,21 @@ QString Settings::temporaryPath()
     return QString("temp") + QDir::separator();
 }
 
+QString Settings::compilePath()
+{
+    return QString("compile") + QDir::separator();
+}
+
+QString Settings::compileCachePath()
+{
+    return QString("cache") + QDir::separator() + "compile" + QDir::separator();
+}
+
+QString Settings::outputArchivePath()
+{
+    return QString("archive") + QDir::separator() + "outputs" + QDir::separator();
+}
+
 QString Settings::selfTestPath()
 {
     return QString("selftest") + QDir::separator();
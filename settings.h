@@ -37,10 +37,24 @@ public:
     int getSpecialJudgeTimeLimit() const;
     int getFileSizeLimit() const;
     int getNumberOfThreads() const;
+    bool getPinJudgingThreads() const;
+    int getHousekeepingProcessor() const;
+    int getMemoryBudget() const;
+    int getCompileAheadDepth() const;
+    int getCompileCacheSizeLimit() const;
+    bool getAdaptiveConcurrency() const;
+    int getMinimumNumberOfThreads() const;
+    int getTimingNoiseTarget() const;
+    int getAutoSaveInterval() const;
+    int getCompressionCodec() const;
+    int getCompressionLevel() const;
+    bool getResultDatabaseEnabled() const;
     const QString& getDefaultInputFileExtension() const;
     const QString& getDefaultOutputFileExtension() const;
     const QStringList& getInputFileExtensions() const;
     const QStringList& getOutputFileExtensions() const;
+    const QStringList& getWorkerHosts() const;
+    const QString& getWorkerToken() const;
     const QStringList& getRecentContest() const;
     const QList<Compiler*>& getCompilerList() const;
     const QString& getUiLanguage() const;
@@ -53,10 +67,24 @@ public:
     void setSpecialJudgeTimeLimit(int);
     void setFileSizeLimit(int);
     void setNumberOfThreads(int);
+    void setPinJudgingThreads(bool);
+    void setHousekeepingProcessor(int);
+    void setMemoryBudget(int);
+    void setCompileAheadDepth(int);
+    void setCompileCacheSizeLimit(int);
+    void setAdaptiveConcurrency(bool);
+    void setMinimumNumberOfThreads(int);
+    void setTimingNoiseTarget(int);
+    void setAutoSaveInterval(int);
+    void setCompressionCodec(int);
+    void setCompressionLevel(int);
+    void setResultDatabaseEnabled(bool);
     void setDefaultInputFileExtension(const QString&);
     void setDefaultOutputFileExtension(const QString&);
     void setInputFileExtensions(const QString&);
     void setOutputFileExtensions(const QString&);
+    void setWorkerHosts(const QString&);
+    void setWorkerToken(const QString&);
     void setRecentContest(const QStringList&);
     void setUiLanguage(const QString&);
     
@@ -73,9 +101,17 @@ public:
     static int upperBoundForMemoryLimit();
     static int upperBoundForFileSizeLimit();
     static int upperBoundForNumberOfThreads();
+    static int upperBoundForMemoryBudget();
+    static int upperBoundForCompileAheadDepth();
+    static int upperBoundForCompileCacheSizeLimit();
+    static int upperBoundForTimingNoiseTarget();
+    static int upperBoundForAutoSaveInterval();
     static QString dataPath();
     static QString sourcePath();
     static QString temporaryPath();
+    static QString compilePath();
+    static QString compileCachePath();
+    static QString outputArchivePath();
     static QString selfTestPath();
 
 private:
@@ -87,10 +123,24 @@ private:
     int specialJudgeTimeLimit;
     int fileSizeLimit;
     int numberOfThreads;
+    bool pinJudgingThreads;
+    int housekeepingProcessor;
+    int memoryBudget;
+    int compileAheadDepth;
+    int compileCacheSizeLimit;
+    bool adaptiveConcurrency;
+    int minimumNumberOfThreads;
+    int timingNoiseTarget;
+    int autoSaveInterval;
+    int compressionCodec;
+    int compressionLevel;
+    bool resultDatabaseEnabled;
     QString defaultInputFileExtension;
     QString defaultOutputFileExtension;
     QStringList inputFileExtensions;
     QStringList outputFileExtensions;
+    QStringList workerHosts;
+    QString workerToken;
     QStringList recentContest;
     QString uiLanguage;
     QString diffPath;
@@ -0,0 +1,170 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "submissionwatcher.h"
+#include "contest.h"
+#include "task.h"
+#include "testcase.h"
+#include "settings.h"
+
+SubmissionWatcher::SubmissionWatcher(QObject *parent) :
+    QObject(parent)
+{
+    curContest = 0;
+    rootChanged = false;
+    watcher = new QFileSystemWatcher(this);
+    debounceTimer = new QTimer(this);
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(1000);
+    connect(watcher, SIGNAL(directoryChanged(QString)),
+            this, SLOT(directoryChanged(QString)));
+    connect(watcher, SIGNAL(fileChanged(QString)),
+            this, SLOT(fileChanged(QString)));
+    connect(debounceTimer, SIGNAL(timeout()),
+            this, SLOT(collectChanges()));
+}
+
+void SubmissionWatcher::setContest(Contest *contest)
+{
+    curContest = contest;
+}
+
+void SubmissionWatcher::setDebounceInterval(int interval)
+{
+    debounceTimer->setInterval(interval);
+}
+
+void SubmissionWatcher::start()
+{
+    QDir sourceDir(Settings::sourcePath());
+    watcher->addPath(sourceDir.absolutePath());
+    QStringList nameList = sourceDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (int i = 0; i < nameList.size(); i ++) {
+        watchContestant(nameList[i]);
+        fingerprints.insert(nameList[i], scanContestant(nameList[i]));
+    }
+}
+
+void SubmissionWatcher::watchContestant(const QString &name)
+{
+    QDir contestantDir(Settings::sourcePath() + name);
+    if (! watcher->directories().contains(contestantDir.absolutePath()))
+        watcher->addPath(contestantDir.absolutePath());
+    QStringList fileList = contestantDir.entryList(QDir::Files);
+    for (int i = 0; i < fileList.size(); i ++)
+        if (! watcher->files().contains(contestantDir.absoluteFilePath(fileList[i])))
+            watcher->addPath(contestantDir.absoluteFilePath(fileList[i]));
+}
+
+QMap<QString, QPair<qint64, QDateTime> > SubmissionWatcher::scanContestant(const QString &name) const
+{
+    QMap<QString, QPair<qint64, QDateTime> > result;
+    QFileInfoList infoList = QDir(Settings::sourcePath() + name).entryInfoList(QDir::Files);
+    for (int i = 0; i < infoList.size(); i ++)
+        result.insert(infoList[i].fileName(), qMakePair(infoList[i].size(), infoList[i].lastModified()));
+    return result;
+}
+
+QList<int> SubmissionWatcher::affectedTasks(const QStringList &fileList) const
+{
+    QList<int> result;
+    const QList<Task*> &taskList = curContest->getTaskList();
+    for (int i = 0; i < taskList.size(); i ++) {
+        QStringList baseNames;
+        if (taskList[i]->getTaskType() == Task::Traditional)
+            baseNames.append(taskList[i]->getSourceFileName());
+        else
+            for (int j = 0; j < taskList[i]->getTestCaseList().size(); j ++) {
+                QStringList inputFiles = taskList[i]->getTestCase(j)->getInputFiles();
+                for (int k = 0; k < inputFiles.size(); k ++)
+                    baseNames.append(QFileInfo(inputFiles[k]).completeBaseName());
+            }
+        for (int j = 0; j < fileList.size(); j ++)
+            if (baseNames.contains(QFileInfo(fileList[j]).completeBaseName())) {
+                result.append(i);
+                break;
+            }
+    }
+    return result;
+}
+
+void SubmissionWatcher::directoryChanged(const QString &path)
+{
+    if (QDir(path) == QDir(Settings::sourcePath()))
+        rootChanged = true;
+    else
+        dirtyContestants.insert(QDir(path).dirName());
+    debounceTimer->start();
+}
+
+void SubmissionWatcher::fileChanged(const QString &path)
+{
+    dirtyContestants.insert(QFileInfo(path).dir().dirName());
+    debounceTimer->start();
+}
+
+void SubmissionWatcher::collectChanges()
+{
+    if (! curContest) return;
+    
+    if (rootChanged) {
+        QStringList nameList = QDir(Settings::sourcePath()).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (int i = 0; i < nameList.size(); i ++)
+            if (! fingerprints.contains(nameList[i])) {
+                fingerprints.insert(nameList[i], QMap<QString, QPair<qint64, QDateTime> >());
+                dirtyContestants.insert(nameList[i]);
+            }
+        QStringList oldList = fingerprints.keys();
+        for (int i = 0; i < oldList.size(); i ++)
+            if (! nameList.contains(oldList[i])) {
+                fingerprints.remove(oldList[i]);
+                dirtyContestants.remove(oldList[i]);
+            }
+        rootChanged = false;
+    }
+    
+    QList< QPair<QString, int> > jobList;
+    QList<QString> nameList = dirtyContestants.toList();
+    qSort(nameList);
+    for (int i = 0; i < nameList.size(); i ++) {
+        if (! fingerprints.contains(nameList[i])) continue;
+        QMap<QString, QPair<qint64, QDateTime> > oldFiles = fingerprints.value(nameList[i]);
+        QMap<QString, QPair<qint64, QDateTime> > newFiles = scanContestant(nameList[i]);
+        QStringList changedFiles;
+        QMapIterator<QString, QPair<qint64, QDateTime> > j(newFiles);
+        while (j.hasNext()) {
+            j.next();
+            if (! oldFiles.contains(j.key()) || oldFiles.value(j.key()) != j.value())
+                changedFiles.append(j.key());
+        }
+        QMapIterator<QString, QPair<qint64, QDateTime> > k(oldFiles);
+        while (k.hasNext()) {
+            k.next();
+            if (! newFiles.contains(k.key())) changedFiles.append(k.key());
+        }
+        fingerprints.insert(nameList[i], newFiles);
+        watchContestant(nameList[i]);
+        
+        QList<int> taskList = affectedTasks(changedFiles);
+        for (int j = 0; j < taskList.size(); j ++)
+            jobList.append(qMakePair(nameList[i], taskList[j]));
+    }
+    dirtyContestants.clear();
+    
+    if (! jobList.isEmpty()) emit submissionsChanged(jobList);
+}
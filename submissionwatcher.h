@@ -0,0 +1,56 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef SUBMISSIONWATCHER_H
+#define SUBMISSIONWATCHER_H
+
+#include <QtCore>
+#include <QObject>
+
+class Contest;
+
+class SubmissionWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SubmissionWatcher(QObject *parent = 0);
+    void setContest(Contest*);
+    void setDebounceInterval(int);
+    void start();
+
+private:
+    Contest *curContest;
+    QFileSystemWatcher *watcher;
+    QTimer *debounceTimer;
+    QMap< QString, QMap<QString, QPair<qint64, QDateTime> > > fingerprints;
+    QSet<QString> dirtyContestants;
+    bool rootChanged;
+    void watchContestant(const QString&);
+    QMap<QString, QPair<qint64, QDateTime> > scanContestant(const QString&) const;
+    QList<int> affectedTasks(const QStringList&) const;
+
+private slots:
+    void directoryChanged(const QString&);
+    void fileChanged(const QString&);
+    void collectChanges();
+
+signals:
+    void submissionsChanged(const QList< QPair<QString, int> >&);
+};
+
+#endif // SUBMISSIONWATCHER_H
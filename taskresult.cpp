@@ -0,0 +1,231 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "taskresult.h"
+#include <limits.h>
+
+// contestants judged on the same task all point at one copy of its layout
+static QMutex layoutMutex;
+static QHash<QByteArray, QVector<int> > layoutPool;
+
+template <typename T>
+static QVector<int> layoutOf(const QList< QList<T> > &list)
+{
+    QVector<int> offsets(list.size() + 1, 0);
+    for (int i = 0; i < list.size(); i ++)
+        offsets[i + 1] = offsets[i] + list[i].size();
+    return offsets;
+}
+
+template <typename T, typename S>
+static QList< QList<T> > nestedList(const QVector<int> &offsets, const QVector<S> &values)
+{
+    QList< QList<T> > list;
+    for (int i = 0; i + 1 < offsets.size(); i ++) {
+        list.append(QList<T>());
+        for (int j = offsets[i]; j < offsets[i + 1]; j ++)
+            list[i].append(T(values[j]));
+    }
+    return list;
+}
+
+template <typename T, typename S>
+static void flatten(const QList< QList<T> > &list, QVector<S> &values, int lowerBound, int upperBound)
+{
+    int k = 0;
+    for (int i = 0; i < list.size(); i ++)
+        for (int j = 0; j < list[i].size(); j ++)
+            values[k ++] = S(qBound(lowerBound, int(list[i][j]), upperBound));
+}
+
+template <typename S>
+static void reshape(QVector<S> &values, const QVector<int> &oldOffsets, const QVector<int> &newOffsets, S defaultValue)
+{
+    QVector<S> reshaped(newOffsets.isEmpty() ? 0 : newOffsets.last(), defaultValue);
+    for (int i = 0; i + 1 < oldOffsets.size() && i + 1 < newOffsets.size(); i ++) {
+        int count = qMin(oldOffsets[i + 1] - oldOffsets[i], newOffsets[i + 1] - newOffsets[i]);
+        for (int j = 0; j < count; j ++)
+            reshaped[newOffsets[i] + j] = values[oldOffsets[i] + j];
+    }
+    values = reshaped;
+}
+
+TaskResult::TaskResult()
+{
+}
+
+int TaskResult::getTestCaseCount() const
+{
+    return qMax(caseOffsets.size() - 1, 0);
+}
+
+int TaskResult::getCaseCount(int testCase) const
+{
+    return caseOffsets[testCase + 1] - caseOffsets[testCase];
+}
+
+QList< QList<ResultState> > TaskResult::getResult() const
+{
+    return nestedList<ResultState>(caseOffsets, result);
+}
+
+QList< QList<int> > TaskResult::getScore() const
+{
+    return nestedList<int>(caseOffsets, score);
+}
+
+QList< QList<int> > TaskResult::getTimeUsed() const
+{
+    return nestedList<int>(caseOffsets, timeUsed);
+}
+
+QList< QList<int> > TaskResult::getMemoryUsed() const
+{
+    return nestedList<int>(caseOffsets, memoryUsed);
+}
+
+QList< QList<int> > TaskResult::getProcessorUsed() const
+{
+    return nestedList<int>(caseOffsets, processorUsed);
+}
+
+ResultState TaskResult::getResult(int testCase, int index) const
+{
+    return ResultState(result[caseIndex(testCase, index)]);
+}
+
+int TaskResult::getScore(int testCase, int index) const
+{
+    return score[caseIndex(testCase, index)];
+}
+
+int TaskResult::getTimeUsed(int testCase, int index) const
+{
+    return timeUsed[caseIndex(testCase, index)];
+}
+
+int TaskResult::getMemoryUsed(int testCase, int index) const
+{
+    return memoryUsed[caseIndex(testCase, index)];
+}
+
+int TaskResult::getProcessorUsed(int testCase, int index) const
+{
+    return processorUsed[caseIndex(testCase, index)];
+}
+
+int TaskResult::getTaskScore() const
+{
+    int total = 0;
+    for (int i = 0; i + 1 < caseOffsets.size(); i ++) {
+        int minv = 1000000000;
+        for (int j = caseOffsets[i]; j < caseOffsets[i + 1]; j ++)
+            if (score[j] < minv) minv = score[j];
+        if (minv == 1000000000) minv = 0;
+        total += minv;
+    }
+    return total;
+}
+
+int TaskResult::getTotalTimeUsed() const
+{
+    int total = 0;
+    for (int i = 0; i < timeUsed.size(); i ++)
+        if (timeUsed[i] >= 0) total += timeUsed[i];
+    return total;
+}
+
+void TaskResult::setResult(const QList< QList<ResultState> > &_result)
+{
+    setLayout(layoutOf(_result));
+    flatten(_result, result, 0, 255);
+}
+
+void TaskResult::setScore(const QList< QList<int> > &_score)
+{
+    setLayout(layoutOf(_score));
+    flatten(_score, score, -32768, 32767);
+}
+
+void TaskResult::setTimeUsed(const QList< QList<int> > &_timeUsed)
+{
+    setLayout(layoutOf(_timeUsed));
+    flatten(_timeUsed, timeUsed, INT_MIN, INT_MAX);
+}
+
+void TaskResult::setMemoryUsed(const QList< QList<int> > &_memoryUsed)
+{
+    setLayout(layoutOf(_memoryUsed));
+    flatten(_memoryUsed, memoryUsed, INT_MIN, INT_MAX);
+}
+
+void TaskResult::setProcessorUsed(const QList< QList<int> > &_processorUsed)
+{
+    setLayout(layoutOf(_processorUsed));
+    flatten(_processorUsed, processorUsed, -1, 32767);
+}
+
+void TaskResult::setCaseResult(int testCase, int index, ResultState _result, int _score)
+{
+    int k = caseIndex(testCase, index);
+    result[k] = quint8(_result);
+    score[k] = qint16(qBound(-32768, _score, 32767));
+}
+
+void TaskResult::setCaseUsage(int testCase, int index, int _timeUsed, int _memoryUsed, int _processorUsed)
+{
+    int k = caseIndex(testCase, index);
+    timeUsed[k] = _timeUsed;
+    memoryUsed[k] = _memoryUsed;
+    processorUsed[k] = qint16(qBound(-1, _processorUsed, 32767));
+}
+
+void TaskResult::clear()
+{
+    caseOffsets.clear();
+    result.clear();
+    score.clear();
+    timeUsed.clear();
+    memoryUsed.clear();
+    processorUsed.clear();
+}
+
+int TaskResult::caseIndex(int testCase, int index) const
+{
+    return caseOffsets[testCase] + index;
+}
+
+void TaskResult::setLayout(const QVector<int> &offsets)
+{
+    if (offsets == caseOffsets) return;
+    QVector<int> layout = sharedLayout(offsets);
+    reshape(result, caseOffsets, layout, quint8(WrongAnswer));
+    reshape(score, caseOffsets, layout, qint16(0));
+    reshape(timeUsed, caseOffsets, layout, qint32(-1));
+    reshape(memoryUsed, caseOffsets, layout, qint32(-1));
+    reshape(processorUsed, caseOffsets, layout, qint16(-1));
+    caseOffsets = layout;
+}
+
+QVector<int> TaskResult::sharedLayout(const QVector<int> &offsets)
+{
+    QByteArray key(reinterpret_cast<const char*>(offsets.constData()), offsets.size() * int(sizeof(int)));
+    QMutexLocker locker(&layoutMutex);
+    if (! layoutPool.contains(key)) layoutPool.insert(key, offsets);
+    return layoutPool.value(key);
+}
@@ -0,0 +1,65 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef TASKRESULT_H
+#define TASKRESULT_H
+
+#include <QtCore>
+#include "globaltype.h"
+
+class TaskResult
+{
+public:
+    TaskResult();
+    int getTestCaseCount() const;
+    int getCaseCount(int) const;
+    QList< QList<ResultState> > getResult() const;
+    QList< QList<int> > getScore() const;
+    QList< QList<int> > getTimeUsed() const;
+    QList< QList<int> > getMemoryUsed() const;
+    QList< QList<int> > getProcessorUsed() const;
+    ResultState getResult(int, int) const;
+    int getScore(int, int) const;
+    int getTimeUsed(int, int) const;
+    int getMemoryUsed(int, int) const;
+    int getProcessorUsed(int, int) const;
+    int getTaskScore() const;
+    int getTotalTimeUsed() const;
+    
+    void setResult(const QList< QList<ResultState> >&);
+    void setScore(const QList< QList<int> >&);
+    void setTimeUsed(const QList< QList<int> >&);
+    void setMemoryUsed(const QList< QList<int> >&);
+    void setProcessorUsed(const QList< QList<int> >&);
+    void setCaseResult(int, int, ResultState, int);
+    void setCaseUsage(int, int, int, int, int);
+    void clear();
+
+private:
+    QVector<int> caseOffsets;
+    QVector<quint8> result;
+    QVector<qint16> score;
+    QVector<qint32> timeUsed;
+    QVector<qint32> memoryUsed;
+    QVector<qint16> processorUsed;
+    int caseIndex(int, int) const;
+    void setLayout(const QVector<int>&);
+    static QVector<int> sharedLayout(const QVector<int>&);
+};
+
+#endif // TASKRESULT_H
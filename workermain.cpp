@@ -0,0 +1,91 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include <QtCore>
+#include <QHostAddress>
+#include "settings.h"
+#include "remoteconnection.h"
+#include "workerserver.h"
+
+static void printUsage(QTextStream &err)
+{
+    err << "Usage: lemon-worker [options]" << endl
+        << "  -a, --address <address>  listen on this address (default 127.0.0.1)" << endl
+        << "  -p, --port <port>        listen on this port (default " << RemoteConnection::defaultPort() << ")" << endl
+        << "  -t, --token <secret>     shared secret coordinators must prove (default $LEMON_WORKER_TOKEN)" << endl
+        << "  -d, --directory <path>   keep the data cache and workspace in a lemon-worker-workspace-<port>" << endl
+        << "                           folder inside this directory (default the current directory)" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream err(stderr);
+    
+    QStringList arguments = a.arguments();
+    QHostAddress address(QHostAddress::LocalHost);
+    int port = RemoteConnection::defaultPort();
+    QString token = QProcessEnvironment::systemEnvironment().value("LEMON_WORKER_TOKEN");
+    QString directory = QDir::currentPath();
+    for (int i = 1; i < arguments.size(); i ++) {
+        if ((arguments[i] == "-a" || arguments[i] == "--address") && i + 1 < arguments.size()) {
+            if (! address.setAddress(arguments[++ i])) {
+                printUsage(err);
+                return 1;
+            }
+        } else if ((arguments[i] == "-p" || arguments[i] == "--port") && i + 1 < arguments.size())
+            port = arguments[++ i].toInt();
+        else if ((arguments[i] == "-t" || arguments[i] == "--token") && i + 1 < arguments.size())
+            token = arguments[++ i];
+        else if ((arguments[i] == "-d" || arguments[i] == "--directory") && i + 1 < arguments.size())
+            directory = arguments[++ i];
+        else {
+            printUsage(err);
+            return 1;
+        }
+    }
+    if (port <= 0 || port > 65535) {
+        printUsage(err);
+        return 1;
+    }
+    if (token.isEmpty()) {
+        err << "A worker token is required, pass --token or set LEMON_WORKER_TOKEN" << endl;
+        return 1;
+    }
+    
+    // the worker clears its data and source folders for every job, so never run it in a contest folder
+    directory = QDir(directory).absoluteFilePath(QString("lemon-worker-workspace-%1").arg(port));
+    if (! QDir().mkpath(directory) || ! QDir::setCurrent(directory)) {
+        err << QString("Cannot use directory %1").arg(directory) << endl;
+        return 1;
+    }
+    
+    Settings *settings = new Settings(&a);
+    settings->loadSettings();
+    settings->setWorkerHosts("");
+    WorkerServer *server = new WorkerServer(&a);
+    server->setSettings(settings);
+    server->setToken(token);
+    if (! server->listen(address, port)) {
+        err << QString("Cannot listen on %1:%2").arg(address.toString()).arg(port) << endl;
+        return 1;
+    }
+    err << QString("Listening on %1:%2 in %3").arg(address.toString()).arg(port).arg(QDir::currentPath()) << endl;
+    
+    return a.exec();
+}
@@ -0,0 +1,263 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#include "workerserver.h"
+#include "remoteconnection.h"
+#include "judgingcontroller.h"
+#include "assignmentthread.h"
+#include "settings.h"
+#include "fileutility.h"
+#include "task.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+
+WorkerServer::WorkerServer(QObject *parent) :
+    QObject(parent)
+{
+    settings = 0;
+    connection = 0;
+    controller = 0;
+    task = 0;
+    authenticated = false;
+    server = new QTcpServer(this);
+    connect(server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+void WorkerServer::setSettings(Settings *_settings)
+{
+    settings = _settings;
+}
+
+void WorkerServer::setToken(const QString &_token)
+{
+    token = _token;
+}
+
+bool WorkerServer::listen(const QHostAddress &address, int port)
+{
+    return server->listen(address, port);
+}
+
+QString WorkerServer::dataCachePath()
+{
+    return QString("cache") + QDir::separator() + "data" + QDir::separator();
+}
+
+void WorkerServer::newConnection()
+{
+    while (server->hasPendingConnections()) {
+        QTcpSocket *socket = server->nextPendingConnection();
+        if (connection || controller) {
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        connection = new RemoteConnection(socket, this);
+        connection->setMaximumMessageSize(1024);
+        connect(socket, SIGNAL(disconnected()), this, SLOT(connectionClosed()));
+        connect(connection, SIGNAL(connectionAborted()), this, SLOT(connectionClosed()));
+        connect(connection, SIGNAL(messageReceived(int, QByteArray)),
+                this, SLOT(messageReceived(int, QByteArray)));
+        authenticated = false;
+        challenge = RemoteConnection::createChallenge();
+        connection->sendMessage(ChallengeMessage, challenge);
+    }
+}
+
+void WorkerServer::connectionClosed()
+{
+    if (! connection) return;
+    if (controller) controller->cancel();
+    connection->deleteLater();
+    connection = 0;
+    authenticated = false;
+}
+
+void WorkerServer::messageReceived(int type, const QByteArray &body)
+{
+    if (! connection) return;
+    if (! authenticated) {
+        if (type != AuthenticationMessage || token.isEmpty()
+                || ! RemoteConnection::checkAuthenticationCode(challenge, token, body)) {
+            connection->abort();
+            return;
+        }
+        authenticated = true;
+        connection->setMaximumMessageSize(RemoteConnection::defaultMaximumMessageSize());
+        connection->sendMessage(AuthenticatedMessage, QByteArray());
+        return;
+    }
+    
+    QDataStream in(body);
+    if (type == JobMessage && ! controller) receiveJob(in);
+    if (type == FileDataMessage) receiveFile(in);
+}
+
+bool WorkerServer::isValidDataFile(const QString &fileName, const QString &hash)
+{
+    if (! QRegExp("[0-9a-f]{40}").exactMatch(hash)) return false;
+    QString path = QDir::cleanPath(QDir::fromNativeSeparators(fileName));
+    if (path.isEmpty() || QDir::isAbsolutePath(path) || path.contains(':')) return false;
+    return ! path.split('/').contains("..");
+}
+
+bool WorkerServer::isValidContestantName(const QString &name)
+{
+    if (name.isEmpty() || name == "." || name == "..") return false;
+    return ! name.contains('/') && ! name.contains('\\') && ! name.contains(':');
+}
+
+void WorkerServer::receiveJob(QDataStream &in)
+{
+    delete task;
+    task = new Task(this);
+    in >> contestantName;
+    task->readFromStream(in);
+    task->refreshCompilerConfiguration(settings);
+    in >> sourceFiles >> dataFiles;
+    
+    if (! isValidContestantName(contestantName)) {
+        dataFiles.clear();
+        connection->abort();
+        return;
+    }
+    QMapIterator<QString, QString> j(dataFiles);
+    while (j.hasNext()) {
+        j.next();
+        if (! isValidDataFile(j.key(), j.value())) {
+            dataFiles.clear();
+            connection->abort();
+            return;
+        }
+    }
+    
+    missingFiles.clear();
+    QMapIterator<QString, QString> i(dataFiles);
+    while (i.hasNext()) {
+        i.next();
+        if (! QFile::exists(dataCachePath() + i.value()) && ! missingFiles.contains(i.value()))
+            missingFiles.append(i.value());
+    }
+    
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    out << missingFiles;
+    connection->sendMessage(MissingFilesMessage, reply);
+    if (missingFiles.isEmpty()) startJudging();
+}
+
+void WorkerServer::receiveFile(QDataStream &in)
+{
+    QString hash;
+    QByteArray data;
+    in >> hash >> data;
+    if (! missingFiles.contains(hash)) return;
+    if (QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex() != hash) return;
+    
+    QDir().mkpath(dataCachePath());
+    QString stagingName = dataCachePath() + hash + QString(".%1").arg(quintptr(this), 0, 16);
+    QFile file(stagingName);
+    if (! file.open(QFile::WriteOnly) || file.write(data) != data.size()) return;
+    file.close();
+    if (! QFile::rename(stagingName, dataCachePath() + hash)) QFile::remove(stagingName);
+    
+    missingFiles.removeAll(hash);
+    if (missingFiles.isEmpty()) startJudging();
+}
+
+void WorkerServer::startJudging()
+{
+    FileUtility::clearPath(Settings::dataPath());
+    FileUtility::clearPath(Settings::sourcePath());
+    
+    QMapIterator<QString, QString> i(dataFiles);
+    while (i.hasNext()) {
+        i.next();
+        QString fileName = Settings::dataPath() + i.key();
+        QDir().mkpath(QFileInfo(fileName).path());
+        QFile::copy(dataCachePath() + i.value(), fileName);
+#ifdef Q_OS_LINUX
+        if (i.key() == QDir::fromNativeSeparators(task->getSpecialJudge()))
+            QFile::setPermissions(fileName, QFile::permissions(fileName) | QFile::ExeOwner);
+#endif
+    }
+    
+    QString contestantPath = Settings::sourcePath() + contestantName + QDir::separator();
+    QDir().mkpath(contestantPath);
+    QMapIterator<QString, QByteArray> j(sourceFiles);
+    while (j.hasNext()) {
+        j.next();
+        QFile file(contestantPath + QFileInfo(j.key()).fileName());
+        if (file.open(QFile::WriteOnly)) file.write(j.value());
+    }
+    
+    controller = new JudgingController();
+    controller->setSettings(settings);
+    controller->setTaskList(QList<Task*>() << task);
+    controller->addJob(contestantName, 0);
+    connect(controller, SIGNAL(progressSnapshot(QList<QList<int> >)),
+            this, SLOT(progressSnapshot(QList<QList<int> >)));
+    connect(controller, SIGNAL(compileError(int, int)),
+            this, SLOT(compileError(int, int)));
+    connect(controller, SIGNAL(taskJudged(QString, int, QObject*, QObject*, bool)),
+            this, SLOT(taskJudged(QString, int, QObject*, QObject*, bool)));
+    connect(controller, SIGNAL(finished()), this, SLOT(judgingFinished()));
+    controller->start();
+}
+
+void WorkerServer::progressSnapshot(const QList< QList<int> > &progressList)
+{
+    if (! connection) return;
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out << progressList;
+    connection->sendMessage(CaseFinishedMessage, body);
+}
+
+void WorkerServer::compileError(int progress, int compileState)
+{
+    if (! connection) return;
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out << progress << compileState;
+    connection->sendMessage(CompileErrorMessage, body);
+}
+
+void WorkerServer::taskJudged(const QString&, int, QObject *_thread, QObject *_rejudgeThread, bool)
+{
+    AssignmentThread *thread = qobject_cast<AssignmentThread*>(_thread);
+    AssignmentThread *rejudgeThread = qobject_cast<AssignmentThread*>(_rejudgeThread);
+    if (connection && thread) {
+        QByteArray body;
+        QDataStream out(&body, QIODevice::WriteOnly);
+        out << bool(rejudgeThread != 0);
+        thread->writeResultToStream(out);
+        if (rejudgeThread) rejudgeThread->writeResultToStream(out);
+        connection->sendMessage(TaskResultMessage, body);
+    }
+    delete _thread;
+    delete _rejudgeThread;
+}
+
+void WorkerServer::judgingFinished()
+{
+    controller->wait();
+    delete controller;
+    controller = 0;
+    if (connection) connection->sendMessage(JobFinishedMessage, QByteArray());
+}
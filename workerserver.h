@@ -0,0 +1,71 @@
+/***************************************************************************
+    This file is part of Project Lemon
+    Copyright (C) 2011 Zhipeng Jia
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+#ifndef WORKERSERVER_H
+#define WORKERSERVER_H
+
+#include <QtCore>
+#include <QObject>
+
+class QTcpServer;
+class QHostAddress;
+class Settings;
+class Task;
+class RemoteConnection;
+class JudgingController;
+
+class WorkerServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WorkerServer(QObject *parent = 0);
+    void setSettings(Settings*);
+    void setToken(const QString&);
+    bool listen(const QHostAddress&, int);
+
+private:
+    Settings *settings;
+    QString token;
+    QTcpServer *server;
+    RemoteConnection *connection;
+    QByteArray challenge;
+    bool authenticated;
+    JudgingController *controller;
+    Task *task;
+    QString contestantName;
+    QMap<QString, QByteArray> sourceFiles;
+    QMap<QString, QString> dataFiles;
+    QStringList missingFiles;
+    static QString dataCachePath();
+    static bool isValidDataFile(const QString&, const QString&);
+    static bool isValidContestantName(const QString&);
+    void receiveJob(QDataStream&);
+    void receiveFile(QDataStream&);
+    void startJudging();
+
+private slots:
+    void newConnection();
+    void connectionClosed();
+    void messageReceived(int, const QByteArray&);
+    void progressSnapshot(const QList< QList<int> >&);
+    void compileError(int, int);
+    void taskJudged(const QString&, int, QObject*, QObject*, bool);
+    void judgingFinished();
+};
+
+#endif // WORKERSERVER_H